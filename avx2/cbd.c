@@ -4,7 +4,7 @@
 #include "cbd.h"
 
 /*************************************************
-* Name:        cbd2
+* Name:        cbd2_avx2
 *
 * Description: Given an array of uniformly random bytes, compute
 *              polynomial with coefficients distributed according to
@@ -13,7 +13,7 @@
 * Arguments:   - poly *r: pointer to output polynomial
 *              - const __m256i *buf: pointer to aligned input byte array
 **************************************************/
-static void cbd2(poly * restrict r, const __m256i buf[2*KYBER_N/128])
+void cbd2_avx2(poly * restrict r, const __m256i buf[2*KYBER_N/128])
 {
   unsigned int i;
   __m256i f0, f1, f2, f3;
@@ -59,7 +59,7 @@ static void cbd2(poly * restrict r, const __m256i buf[2*KYBER_N/128])
 
 #if KYBER_ETA1 == 3
 /*************************************************
-* Name:        cbd3
+* Name:        cbd3_avx2
 *
 * Description: Given an array of uniformly random bytes, compute
 *              polynomial with coefficients distributed according to
@@ -69,7 +69,7 @@ static void cbd2(poly * restrict r, const __m256i buf[2*KYBER_N/128])
 * Arguments:   - poly *r: pointer to output polynomial
 *              - const __m256i *buf: pointer to aligned input byte array
 **************************************************/
-static void cbd3(poly * restrict r, const uint8_t buf[3*KYBER_N/4+8])
+void cbd3_avx2(poly * restrict r, const uint8_t buf[3*KYBER_N/4+8])
 {
   unsigned int i;
   __m256i f0, f1, f2, f3;
@@ -122,13 +122,142 @@ static void cbd3(poly * restrict r, const uint8_t buf[3*KYBER_N/4+8])
 }
 #endif
 
+#ifdef KYBER_AVX512_VBMI
+/*************************************************
+* Name:        cbd2_avx512
+*
+* Description: AVX-512 version of cbd2_avx2 with the same output,
+*              128 coefficients per iteration
+*
+* Arguments:   - poly *r: pointer to output polynomial
+*              - const __m256i *buf: pointer to aligned input byte array
+**************************************************/
+void cbd2_avx512(poly * restrict r, const __m256i buf[2*KYBER_N/128])
+{
+  unsigned int i;
+  __m512i f0, f1, f2, f3;
+  const __m512i mask55 = _mm512_set1_epi32(0x55555555);
+  const __m512i mask33 = _mm512_set1_epi32(0x33333333);
+  const __m512i mask03 = _mm512_set1_epi32(0x03030303);
+  const __m512i mask0F = _mm512_set1_epi32(0x0F0F0F0F);
+  // byte 2k from f0[k] and byte 2k+1 from f1[k]
+  const __m512i lo = _mm512_set_epi8(95,31,94,30,93,29,92,28,91,27,90,26,89,25,88,24,
+                                     87,23,86,22,85,21,84,20,83,19,82,18,81,17,80,16,
+                                     79,15,78,14,77,13,76,12,75,11,74,10,73, 9,72, 8,
+                                     71, 7,70, 6,69, 5,68, 4,67, 3,66, 2,65, 1,64, 0);
+  const __m512i hi = _mm512_add_epi8(lo, _mm512_set1_epi8(32));
+
+  for(i = 0; i < KYBER_N/128; i++) {
+    f0 = _mm512_loadu_si512((__m512i *)&buf[2*i]);
+
+    f1 = _mm512_srli_epi16(f0, 1);
+    f0 = _mm512_and_si512(mask55, f0);
+    f1 = _mm512_and_si512(mask55, f1);
+    f0 = _mm512_add_epi8(f0, f1);
+
+    f1 = _mm512_srli_epi16(f0, 2);
+    f0 = _mm512_and_si512(mask33, f0);
+    f1 = _mm512_and_si512(mask33, f1);
+    f0 = _mm512_add_epi8(f0, mask33);
+    f0 = _mm512_sub_epi8(f0, f1);
+
+    f1 = _mm512_srli_epi16(f0, 4);
+    f0 = _mm512_and_si512(mask0F, f0);
+    f1 = _mm512_and_si512(mask0F, f1);
+    f0 = _mm512_sub_epi8(f0, mask03);
+    f1 = _mm512_sub_epi8(f1, mask03);
+
+    f2 = _mm512_permutex2var_epi8(f0, lo, f1);
+    f3 = _mm512_permutex2var_epi8(f0, hi, f1);
+
+    f0 = _mm512_cvtepi8_epi16(_mm512_castsi512_si256(f2));
+    f1 = _mm512_cvtepi8_epi16(_mm512_extracti64x4_epi64(f2, 1));
+    f2 = _mm512_cvtepi8_epi16(_mm512_castsi512_si256(f3));
+    f3 = _mm512_cvtepi8_epi16(_mm512_extracti64x4_epi64(f3, 1));
+
+    _mm512_storeu_si512((__m512i *)&r->vec[8*i+0], f0);
+    _mm512_storeu_si512((__m512i *)&r->vec[8*i+2], f1);
+    _mm512_storeu_si512((__m512i *)&r->vec[8*i+4], f2);
+    _mm512_storeu_si512((__m512i *)&r->vec[8*i+6], f3);
+  }
+}
+
+#if KYBER_ETA1 == 3
+/*************************************************
+* Name:        cbd3_avx512
+*
+* Description: AVX-512 version of cbd3_avx2 with the same output,
+*              64 coefficients per iteration
+*
+* Arguments:   - poly *r: pointer to output polynomial
+*              - const uint8_t *buf: pointer to input byte array
+**************************************************/
+void cbd3_avx512(poly * restrict r, const uint8_t buf[3*KYBER_N/4+8])
+{
+  unsigned int i;
+  __m512i f0, f1, f2, f3;
+  const __m512i mask249 = _mm512_set1_epi32(0x249249);
+  const __m512i mask6DB = _mm512_set1_epi32(0x6DB6DB);
+  const __m512i mask07 = _mm512_set1_epi32(7);
+  const __m512i mask70 = _mm512_set1_epi32(7 << 16);
+  const __m512i mask3 = _mm512_set1_epi16(3);
+  // three bytes to each dword, the top byte zeroed by the mask
+  const __m512i permbidx = _mm512_set_epi8( 0,47,46,45, 0,44,43,42, 0,41,40,39, 0,38,37,36,
+                                            0,35,34,33, 0,32,31,30, 0,29,28,27, 0,26,25,24,
+                                            0,23,22,21, 0,20,19,18, 0,17,16,15, 0,14,13,12,
+                                            0,11,10, 9, 0, 8, 7, 6, 0, 5, 4, 3, 0, 2, 1, 0);
+  const __m512i lo = _mm512_set_epi32(23,7,22,6,21,5,20,4,19,3,18,2,17,1,16,0);
+  const __m512i hi = _mm512_set_epi32(31,15,30,14,29,13,28,12,27,11,26,10,25,9,24,8);
+
+  for(i = 0; i < KYBER_N/64; i++) {
+    f0 = _mm512_maskz_loadu_epi8(0xFFFFFFFFFFFF, &buf[48*i]);
+    f0 = _mm512_maskz_permutexvar_epi8(0x7777777777777777, permbidx, f0);
+
+    f1 = _mm512_srli_epi32(f0,1);
+    f2 = _mm512_srli_epi32(f0,2);
+    f0 = _mm512_and_si512(mask249,f0);
+    f1 = _mm512_and_si512(mask249,f1);
+    f2 = _mm512_and_si512(mask249,f2);
+    f0 = _mm512_add_epi32(f0,f1);
+    f0 = _mm512_add_epi32(f0,f2);
+
+    f1 = _mm512_srli_epi32(f0,3);
+    f0 = _mm512_add_epi32(f0,mask6DB);
+    f0 = _mm512_sub_epi32(f0,f1);
+
+    f1 = _mm512_slli_epi32(f0,10);
+    f2 = _mm512_srli_epi32(f0,12);
+    f3 = _mm512_srli_epi32(f0, 2);
+    f0 = _mm512_and_si512(f0,mask07);
+    f1 = _mm512_and_si512(f1,mask70);
+    f2 = _mm512_and_si512(f2,mask07);
+    f3 = _mm512_and_si512(f3,mask70);
+    f0 = _mm512_add_epi16(f0,f1);
+    f1 = _mm512_add_epi16(f2,f3);
+    f0 = _mm512_sub_epi16(f0,mask3);
+    f1 = _mm512_sub_epi16(f1,mask3);
+
+    f2 = _mm512_permutex2var_epi32(f0,lo,f1);
+    f3 = _mm512_permutex2var_epi32(f0,hi,f1);
+
+    _mm512_storeu_si512((__m512i *)&r->vec[4*i+0], f2);
+    _mm512_storeu_si512((__m512i *)&r->vec[4*i+2], f3);
+  }
+}
+#endif
+#endif
+
 /* buf 32 bytes longer for cbd3 */
 void poly_cbd_eta1(poly *r, const __m256i buf[KYBER_ETA1*KYBER_N/128+1])
 {
-#if KYBER_ETA1 == 2
-  cbd2(r, buf);
+#if KYBER_ETA1 == 2 && defined(KYBER_AVX512_VBMI)
+  cbd2_avx512(r, buf);
+#elif KYBER_ETA1 == 2
+  cbd2_avx2(r, buf);
+#elif KYBER_ETA1 == 3 && defined(KYBER_AVX512_VBMI)
+  cbd3_avx512(r, (uint8_t *)buf);
 #elif KYBER_ETA1 == 3
-  cbd3(r, (uint8_t *)buf);
+  cbd3_avx2(r, (uint8_t *)buf);
 #else
 #error "This implementation requires eta1 in {2,3}"
 #endif
@@ -136,8 +265,10 @@ void poly_cbd_eta1(poly *r, const __m256i buf[KYBER_ETA1*KYBER_N/128+1])
 
 void poly_cbd_eta2(poly *r, const __m256i buf[KYBER_ETA2*KYBER_N/128])
 {
-#if KYBER_ETA2 == 2
-  cbd2(r, buf);
+#if KYBER_ETA2 == 2 && defined(KYBER_AVX512_VBMI)
+  cbd2_avx512(r, buf);
+#elif KYBER_ETA2 == 2
+  cbd2_avx2(r, buf);
 #else
 #error "This implementation requires eta2 = 2"
 #endif
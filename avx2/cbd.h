@@ -5,6 +5,23 @@
 #include <immintrin.h>
 #include "params.h"
 #include "poly.h"
+#include "ntt.h"
+
+#define cbd2_avx2 KYBER_NAMESPACE(cbd2_avx2)
+void cbd2_avx2(poly *r, const __m256i buf[2*KYBER_N/128]);
+#if KYBER_ETA1 == 3
+#define cbd3_avx2 KYBER_NAMESPACE(cbd3_avx2)
+void cbd3_avx2(poly *r, const uint8_t buf[3*KYBER_N/4+8]);
+#endif
+
+#ifdef KYBER_AVX512_VBMI
+#define cbd2_avx512 KYBER_NAMESPACE(cbd2_avx512)
+void cbd2_avx512(poly *r, const __m256i buf[2*KYBER_N/128]);
+#if KYBER_ETA1 == 3
+#define cbd3_avx512 KYBER_NAMESPACE(cbd3_avx512)
+void cbd3_avx512(poly *r, const uint8_t buf[3*KYBER_N/4+8]);
+#endif
+#endif
 
 #define poly_cbd_eta1 KYBER_NAMESPACE(poly_cbd_eta1)
 void poly_cbd_eta1(poly *r, const __m256i buf[KYBER_ETA1*KYBER_N/128+1]);
@@ -13,6 +13,8 @@
 #include "rejsample.h"
 #include "symmetric.h"
 #include "randombytes.h"
+#include "stats.h"
+#include "telemetry.h"
 
 /*************************************************
 * Name:        unpack_pk
@@ -136,6 +138,51 @@ static void unpack_ciphertext(polyvec *b, poly *v, const uint8_t c[KYBER_INDCPA_
 #define gen_a(A,B)  gen_matrix(A,B,0)
 #define gen_at(A,B) gen_matrix(A,B,1)
 
+/*************************************************
+* Name:        gen_rkg_noise
+*
+* Description: Sample the noise of a re-key, rp with KYBER_ETA1 and ep with
+*              KYBER_ETA2, with nonces 0, ..., 2k-1 in this order as
+*              poly_getnoise_eta1/eta2 would, but in batches: one keccakx4
+*              run for k = 2, and for k = 3, 4 one keccakx8 run on AVX-512
+*              or two keccakx4 runs otherwise (KYBER_ETA1 = KYBER_ETA2).
+*
+* Arguments:   - polyvec *rp: pointer to output vector rp
+*              - polyvec *ep: pointer to output vector ep
+*              - const uint8_t *coins: pointer to input seed
+*                                      (of length KYBER_SYMBYTES)
+**************************************************/
+static void gen_rkg_noise(polyvec *rp, polyvec *ep, const uint8_t coins[KYBER_SYMBYTES])
+{
+#if KYBER_K == 2
+  poly_getnoise_eta1122_4x(rp->vec+0, rp->vec+1, ep->vec+0, ep->vec+1, coins, 0, 1, 2, 3);
+#elif defined(KECCAK_X8)
+  unsigned int i;
+  poly tmp[2];
+  poly *r[8];
+  uint8_t nonce[8];
+
+  for(i=0;i<8;i++) {
+    nonce[i] = i;
+    if(i < KYBER_K)
+      r[i] = &rp->vec[i];
+    else if(i < 2*KYBER_K)
+      r[i] = &ep->vec[i-KYBER_K];
+    else
+      r[i] = &tmp[i-2*KYBER_K];
+  }
+  poly_getnoise_eta1_8x(r, coins, nonce);
+#elif KYBER_K == 3
+  poly tmp[2];
+
+  poly_getnoise_eta1_4x(rp->vec+0, rp->vec+1, rp->vec+2, ep->vec+0, coins, 0, 1, 2, 3);
+  poly_getnoise_eta1_4x(ep->vec+1, ep->vec+2, tmp+0, tmp+1, coins, 4, 5, 6, 7);
+#elif KYBER_K == 4
+  poly_getnoise_eta1_4x(rp->vec+0, rp->vec+1, rp->vec+2, rp->vec+3, coins, 0, 1, 2, 3);
+  poly_getnoise_eta1_4x(ep->vec+0, ep->vec+1, ep->vec+2, ep->vec+3, coins, 4, 5, 6, 7);
+#endif
+}
+
 /*************************************************
 * Name:        cdpre_rkg
 *
@@ -161,42 +208,55 @@ void cdpre_rkg(uint8_t sk_i[KYBER_INDCPA_SECRETKEYBYTES],
 {
   unsigned int i;
   uint8_t seed[KYBER_SYMBYTES];
-  uint8_t nonce = 0;
   polyvec pkpv, skpv, rp, ep, at[KYBER_K], u_ij, u_i;
   poly v_i, v_ij, temp;
+  const uint64_t t0 = telemetry_begin();
+  STATS_BEGIN(CDPRE_STATS_RKG);
   // unpacking
   unpack_pk(&pkpv, seed, pk_j); // parse pk_j
   unpack_sk(&skpv, sk_i); // parse sk_j
   unpack_ciphertext(&u_i, &v_i, c_i); //parse c_i
+  STATS_STAGE(CDPRE_STAGE_UNPACK);
   gen_at(at, seed); // generate matrix A^T
+  STATS_STAGE(CDPRE_STAGE_GENMATRIX);
 
   // generate u_ij
-  for(i=0;i<KYBER_K;i++) // generate rp
-  	poly_getnoise_eta1(rp.vec+i, coins, nonce++);
+  gen_rkg_noise(&rp, &ep, coins); // generate rp and ep
+  STATS_STAGE(CDPRE_STAGE_NOISE);
   polyvec_ntt(&rp);
+  STATS_STAGE(CDPRE_STAGE_NTT);
   for(i=0;i<KYBER_K;i++) // A^T * rp
 	polyvec_basemul_acc_montgomery(&u_ij.vec[i], &at[i], &rp);
-  for(i=0;i<KYBER_K;i++) // generate ep
-    poly_getnoise_eta2(ep.vec+i, coins, nonce++);
+  STATS_STAGE(CDPRE_STAGE_BASEMUL);
   polyvec_invntt_tomont(&u_ij);
+  STATS_STAGE(CDPRE_STAGE_INVNTT);
   polyvec_add(&u_ij, &u_ij, &ep); // u_ij = A^T * rp + ep
   
   polyvec_reduce(&u_ij); // compress u_ij
+  STATS_STAGE(CDPRE_STAGE_REDUCE);
 
   // generate v_ij
   polyvec_basemul_acc_montgomery(&v_ij, &pkpv, &rp); // t_j^T * rp
+  STATS_STAGE(CDPRE_STAGE_BASEMUL);
   poly_invntt_tomont(&v_ij);
+  STATS_STAGE(CDPRE_STAGE_INVNTT);
   polyvec_ntt(&u_i);
+  STATS_STAGE(CDPRE_STAGE_NTT);
   polyvec_basemul_acc_montgomery(&temp, &skpv, &u_i); // s_i^T * u_i
+  STATS_STAGE(CDPRE_STAGE_BASEMUL);
   poly_invntt_tomont(&temp);
+  STATS_STAGE(CDPRE_STAGE_INVNTT);
 
   poly_sub(&v_ij, &v_ij, &temp); // v_ij = t_j^T * rp - s_i^T * u_i
   poly_reduce(&v_ij); // compress v_ij
+  STATS_STAGE(CDPRE_STAGE_REDUCE);
   /* optimistic mode: drv = 4 */
   /* need to add other modes, i.e., different compression size for v_ij */
 
   // pack ciphertext
   pack_ciphertext(rk, &u_ij, &v_ij);
+  STATS_STAGE(CDPRE_STAGE_PACK);
+  telemetry_end(CDPRE_TELEMETRY_CDPRE_RKG, t0, KYBER_INDCPA_BYTES);
 
 }
 
@@ -219,14 +279,114 @@ void cdpre_renc(const uint8_t rk[KYBER_INDCPA_BYTES],
 {
 	polyvec u_i, u_j;
 	poly v_ij, v_i, v_j;
+	const uint64_t t0 = telemetry_begin();
+	STATS_BEGIN(CDPRE_STATS_RENC);
 
 	unpack_ciphertext(&u_j, &v_ij, rk); // parse rk, and u_j = u_ij
 	/* need to be optimized: do not need to unpack/pack u_j */
 	unpack_ciphertext(&u_i, &v_i, c_i); // parse c_i
+	STATS_STAGE(CDPRE_STAGE_UNPACK);
 	
 	poly_add(&v_j, &v_i, &v_ij); // v_j = v_i + v_ij
 	poly_reduce(&v_j); // compress v_j
 	polyvec_reduce(&u_j); // compress u_j
+	STATS_STAGE(CDPRE_STAGE_REDUCE);
 
 	pack_ciphertext(c_j, &u_j, &v_j); // pack c_j
-}
\ No newline at end of file
+	STATS_STAGE(CDPRE_STAGE_PACK);
+	telemetry_end(CDPRE_TELEMETRY_CDPRE_RENC, t0, KYBER_INDCPA_BYTES);
+}
+
+/*************************************************
+* Name:        cdpre_renc_chain
+*
+* Description: Re-encryption along a chain of re-keys in one pass: rk_1
+*              generated for c_i, rk_2 for the re-encryption of c_i under
+*              rk_1, and so on. The output has the u of the last re-key and
+*              v = v_i + v_1 + ... + v_nhops, summed decompressed and
+*              compressed once. Every decompressed v is within 1/2 of a
+*              multiple of q/2^dv, so for nhops+1 < q/2^dv the output is that
+*              of nhops calls of cdpre_renc, and re-encryption adds no noise
+*              of its own: the noise variance after h hops is V_0 + h*V_rk
+*              (V_0: fresh ciphertext, V_rk: one re-key), see the README for
+*              the failure rates per hop count.
+*
+* Arguments:   - const uint8_t *rk: pointer to input re-keys, concatenated
+*                                   (of length nhops*KYBER_INDCPA_BYTES)
+*              - size_t nhops: number of re-keys; for 0, c_i is copied
+*              - const uint8_t *c_i: pointer to input ciphertext
+*                                  (of length KYBER_INDCPA_BYTES)
+*              - uint8_t *c_j: pointer to output ciphertext, may be c_i
+*                                  (of length KYBER_INDCPA_BYTES)
+**************************************************/
+void cdpre_renc_chain(const uint8_t *rk,
+                      size_t nhops,
+                      const uint8_t c_i[KYBER_INDCPA_BYTES],
+                      uint8_t c_j[KYBER_INDCPA_BYTES])
+{
+  size_t h;
+  const uint8_t *u = c_i;
+  poly v, t;
+  const uint64_t t0 = telemetry_begin();
+  STATS_BEGIN(CDPRE_STATS_RENC);
+
+  poly_decompress(&v, c_i+KYBER_POLYVECCOMPRESSEDBYTES);
+  for(h=0;h<nhops;h++) {
+    u = rk + h*KYBER_INDCPA_BYTES;
+    poly_decompress(&t, u+KYBER_POLYVECCOMPRESSEDBYTES);
+    poly_add(&v, &v, &t);
+    poly_reduce(&v);
+  }
+  STATS_STAGE(CDPRE_STAGE_REDUCE);
+
+  // the compressed u of the last hop is copied as is
+  memmove(c_j, u, KYBER_POLYVECCOMPRESSEDBYTES);
+  poly_compress(c_j+KYBER_POLYVECCOMPRESSEDBYTES, &v);
+  STATS_STAGE(CDPRE_STAGE_PACK);
+  telemetry_end(CDPRE_TELEMETRY_CDPRE_RENC, t0, KYBER_INDCPA_BYTES);
+}
+
+/*************************************************
+* Name:        cdpre_dec
+*
+* Description: Decryption of an original or re-encrypted ciphertext, with
+*              the output of indcpa_dec. While telemetry is enabled it also
+*              records the noise margin of the ciphertext; the KEM does not
+*              go through this function, so crypto_kem_dec exports no
+*              margins.
+*
+* Arguments:   - uint8_t *m: pointer to output message
+*                            (of length KYBER_INDCPA_MSGBYTES)
+*              - const uint8_t *c: pointer to input ciphertext
+*                                  (of length KYBER_INDCPA_BYTES)
+*              - const uint8_t *sk: pointer to input secret key
+*                                   (of length KYBER_INDCPA_SECRETKEYBYTES)
+**************************************************/
+void cdpre_dec(uint8_t m[KYBER_INDCPA_MSGBYTES],
+               const uint8_t c[KYBER_INDCPA_BYTES],
+               const uint8_t sk[KYBER_INDCPA_SECRETKEYBYTES])
+{
+  indcpa_dec_batch_margin(m, c, 1, sk);
+}
+
+/*************************************************
+* Name:        cdpre_dec_batch
+*
+* Description: cdpre_dec of n ciphertexts under the same secret key, see
+*              indcpa_dec_batch.
+*
+* Arguments:   - uint8_t *m: pointer to n output messages
+*                            (of length n*KYBER_INDCPA_MSGBYTES bytes)
+*              - const uint8_t *c: pointer to n input ciphertexts
+*                                  (of length n*KYBER_INDCPA_BYTES bytes)
+*              - size_t n: number of ciphertexts
+*              - const uint8_t *sk: pointer to input secret key
+*                                   (of length KYBER_INDCPA_SECRETKEYBYTES)
+**************************************************/
+void cdpre_dec_batch(uint8_t *m,
+                     const uint8_t *c,
+                     size_t n,
+                     const uint8_t sk[KYBER_INDCPA_SECRETKEYBYTES])
+{
+  indcpa_dec_batch_margin(m, c, n, sk);
+}
@@ -1,6 +1,7 @@
 #ifndef CDPRE_H
 #define CDPRE_H
 
+#include <stddef.h>
 #include "indcpa.h"
 
 void cdpre_rkg(uint8_t sk_i[KYBER_INDCPA_SECRETKEYBYTES],
@@ -13,4 +14,18 @@ void cdpre_renc(const uint8_t rk[KYBER_INDCPA_BYTES],
                 const uint8_t c_i[KYBER_INDCPA_BYTES],
                 uint8_t c_j[KYBER_INDCPA_BYTES]);
 
+void cdpre_renc_chain(const uint8_t *rk,
+                      size_t nhops,
+                      const uint8_t c_i[KYBER_INDCPA_BYTES],
+                      uint8_t c_j[KYBER_INDCPA_BYTES]);
+
+void cdpre_dec(uint8_t m[KYBER_INDCPA_MSGBYTES],
+               const uint8_t c[KYBER_INDCPA_BYTES],
+               const uint8_t sk[KYBER_INDCPA_SECRETKEYBYTES]);
+
+void cdpre_dec_batch(uint8_t *m,
+                     const uint8_t *c,
+                     size_t n,
+                     const uint8_t sk[KYBER_INDCPA_SECRETKEYBYTES]);
+
 #endif // CDPRE_H
\ No newline at end of file
@@ -0,0 +1,474 @@
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "params.h"
+#include "indcpa.h"
+#include "cdpre.h"
+#include "randombytes.h"
+#include "verify.h"
+
+/*
+ * CPython extension module of the IND-CPA scheme and cdPRE for one
+ * parameter set (cdpre512, cdpre768 or cdpre1024 for KYBER_K = 2, 3, 4).
+ *
+ * Inputs are any C-contiguous objects with the buffer protocol (bytes,
+ * bytearray, memoryview, array.array, numpy arrays) and are read in place.
+ * Outputs are new bytes objects written in place, or the writable buffer
+ * passed as out=, which is returned. The batch variants take the inputs of
+ * n calls concatenated and return the outputs concatenated. The GIL is
+ * released while the C functions run, so Python threads calling into the
+ * module use several cores. Random coins are drawn with randombytes unless
+ * given, which makes all outputs reproducible for tests.
+ */
+
+#if   (KYBER_K == 2)
+#define MODULE_NAME "cdpre512"
+#define MODULE_INIT PyInit_cdpre512
+#elif (KYBER_K == 3)
+#define MODULE_NAME "cdpre768"
+#define MODULE_INIT PyInit_cdpre768
+#elif (KYBER_K == 4)
+#define MODULE_NAME "cdpre1024"
+#define MODULE_INIT PyInit_cdpre1024
+#endif
+
+PyMODINIT_FUNC MODULE_INIT(void);
+
+static int check_len(const Py_buffer *b, Py_ssize_t len, const char *name)
+{
+  if(b->len != len) {
+    PyErr_Format(PyExc_ValueError, "%s must have %zd bytes, not %zd", name, len, b->len);
+    return -1;
+  }
+  return 0;
+}
+
+// number of items of unit bytes in b
+static int check_batch(Py_ssize_t *n, const Py_buffer *b, Py_ssize_t unit, const char *name)
+{
+  if(b->len % unit) {
+    PyErr_Format(PyExc_ValueError, "%s must have a multiple of %zd bytes, not %zd", name, unit, b->len);
+    return -1;
+  }
+  *n = b->len / unit;
+  return 0;
+}
+
+/*************************************************
+* Name:        output
+*
+* Description: Output of len bytes: a new bytes object to be filled in
+*              place, or the writable buffer out if one was passed
+*
+* Arguments:   - uint8_t **p: pointer to output pointer to the bytes
+*              - const Py_buffer *out: pointer to the buffer of out=,
+*                                      with out->obj NULL if none
+*              - Py_ssize_t len: number of bytes
+*
+* Returns a new reference, or NULL with an exception set
+**************************************************/
+static PyObject *output(uint8_t **p, const Py_buffer *out, Py_ssize_t len)
+{
+  PyObject *r;
+
+  if(out->obj) {
+    if(check_len(out, len, "out"))
+      return NULL;
+    *p = out->buf;
+    Py_INCREF(out->obj);
+    return out->obj;
+  }
+  r = PyBytes_FromStringAndSize(NULL, len);
+  if(r)
+    *p = (uint8_t *)PyBytes_AS_STRING(r);
+  return r;
+}
+
+/*************************************************
+* Name:        get_coins
+*
+* Description: Coins for n calls: those given, or n*KYBER_SYMBYTES fresh
+*              random bytes to be drawn with draw_coins
+*
+* Arguments:   - uint8_t **p: pointer to output pointer to the coins
+*              - const Py_buffer *coins: pointer to the buffer of coins=,
+*                                        with coins->obj NULL if none
+*              - Py_ssize_t n: number of calls
+*
+* Returns 0 on success, -1 with an exception set
+**************************************************/
+static int get_coins(uint8_t **p, const Py_buffer *coins, Py_ssize_t n)
+{
+  if(coins->obj) {
+    *p = coins->buf;
+    return check_len(coins, n*KYBER_SYMBYTES, "coins");
+  }
+  *p = PyMem_RawMalloc(n*KYBER_SYMBYTES + 1);
+  if(!*p) {
+    PyErr_NoMemory();
+    return -1;
+  }
+  return 0;
+}
+
+// to be called without the GIL
+static void draw_coins(uint8_t *p, const Py_buffer *coins, Py_ssize_t n)
+{
+  if(!coins->obj)
+    randombytes(p, n*KYBER_SYMBYTES);
+}
+
+static void free_coins(uint8_t *p, const Py_buffer *coins, Py_ssize_t n)
+{
+  if(!coins->obj && p) {
+    wipe(p, n*KYBER_SYMBYTES);
+    PyMem_RawFree(p);
+  }
+}
+
+static void keygen_n(uint8_t *pk, uint8_t *sk, const uint8_t *coins, Py_ssize_t n)
+{
+  unsigned int l;
+  Py_ssize_t k;
+  uint8_t *ppk[4], *psk[4];
+  const uint8_t *pcoins[4];
+
+  for(k=0;k+4<=n;k+=4) {
+    for(l=0;l<4;l++) {
+      ppk[l] = pk + (k+l)*KYBER_INDCPA_PUBLICKEYBYTES;
+      psk[l] = sk + (k+l)*KYBER_INDCPA_SECRETKEYBYTES;
+      pcoins[l] = coins + (k+l)*KYBER_SYMBYTES;
+    }
+    indcpa_keypair_derand_x4(ppk, psk, pcoins);
+  }
+  for(;k<n;k++)
+    indcpa_keypair_derand(pk + k*KYBER_INDCPA_PUBLICKEYBYTES, sk + k*KYBER_INDCPA_SECRETKEYBYTES,
+                          coins + k*KYBER_SYMBYTES);
+}
+
+static PyObject *keygen_common(Py_ssize_t n, Py_buffer *coins)
+{
+  uint8_t *pk, *sk, *c = NULL;
+  PyObject *opk = NULL, *osk = NULL, *r = NULL;
+  const Py_buffer none = {0};
+
+  if(get_coins(&c, coins, n))
+    goto out;
+  opk = output(&pk, &none, n*KYBER_INDCPA_PUBLICKEYBYTES);
+  osk = output(&sk, &none, n*KYBER_INDCPA_SECRETKEYBYTES);
+  if(!opk || !osk)
+    goto out;
+
+  Py_BEGIN_ALLOW_THREADS
+  draw_coins(c, coins, n);
+  keygen_n(pk, sk, c, n);
+  Py_END_ALLOW_THREADS
+
+  r = PyTuple_Pack(2, opk, osk);
+
+out:
+  free_coins(c, coins, n);
+  Py_XDECREF(opk);
+  Py_XDECREF(osk);
+  PyBuffer_Release(coins);
+  return r;
+}
+
+PyDoc_STRVAR(keygen_doc,
+"keygen(coins=None) -> (pk, sk)\n\n"
+"Generate a key pair, from KYBER_SYMBYTES coins if given.");
+
+static PyObject *keygen(PyObject *self, PyObject *args, PyObject *kwds)
+{
+  static char *kwlist[] = {"coins", NULL};
+  Py_buffer coins = {0};
+
+  (void)self;
+  if(!PyArg_ParseTupleAndKeywords(args, kwds, "|y*", kwlist, &coins))
+    return NULL;
+  if(coins.obj && check_len(&coins, KYBER_SYMBYTES, "coins")) {
+    PyBuffer_Release(&coins);
+    return NULL;
+  }
+  return keygen_common(1, &coins);
+}
+
+PyDoc_STRVAR(keygen_batch_doc,
+"keygen_batch(n, coins=None) -> (pks, sks)\n\n"
+"Generate n key pairs, four at a time, from n*KYBER_SYMBYTES coins if\n"
+"given. The keys are concatenated.");
+
+static PyObject *keygen_batch(PyObject *self, PyObject *args, PyObject *kwds)
+{
+  static char *kwlist[] = {"n", "coins", NULL};
+  Py_ssize_t n;
+  Py_buffer coins = {0};
+
+  (void)self;
+  if(!PyArg_ParseTupleAndKeywords(args, kwds, "n|y*", kwlist, &n, &coins))
+    return NULL;
+  if(n < 0 || n > PY_SSIZE_T_MAX/KYBER_INDCPA_SECRETKEYBYTES) {
+    PyErr_SetString(PyExc_ValueError, "n out of range");
+    PyBuffer_Release(&coins);
+    return NULL;
+  }
+  return keygen_common(n, &coins);
+}
+
+static PyObject *enc_common(PyObject *args, PyObject *kwds, int batch)
+{
+  static char *kwlist[] = {"m", "pk", "coins", "out", NULL};
+  Py_ssize_t n = 1;
+  uint8_t *c = NULL, *coins = NULL;
+  Py_buffer bm = {0}, bpk = {0}, bcoins = {0}, bout = {0};
+  PyObject *r = NULL;
+
+  if(!PyArg_ParseTupleAndKeywords(args, kwds, "y*y*|y*$w*", kwlist, &bm, &bpk, &bcoins, &bout))
+    return NULL;
+  if((batch ? check_batch(&n, &bm, KYBER_INDCPA_MSGBYTES, "m") : check_len(&bm, KYBER_INDCPA_MSGBYTES, "m"))
+     || check_len(&bpk, KYBER_INDCPA_PUBLICKEYBYTES, "pk") || get_coins(&coins, &bcoins, n))
+    goto out;
+  r = output(&c, &bout, n*KYBER_INDCPA_BYTES);
+  if(!r)
+    goto out;
+
+  Py_BEGIN_ALLOW_THREADS
+  draw_coins(coins, &bcoins, n);
+  if(batch)
+    indcpa_enc_batch(c, bm.buf, n, bpk.buf, coins);
+  else
+    indcpa_enc(c, bm.buf, bpk.buf, coins);
+  Py_END_ALLOW_THREADS
+
+out:
+  free_coins(coins, &bcoins, n);
+  PyBuffer_Release(&bm);
+  PyBuffer_Release(&bpk);
+  PyBuffer_Release(&bcoins);
+  PyBuffer_Release(&bout);
+  return r;
+}
+
+PyDoc_STRVAR(enc_doc,
+"enc(m, pk, coins=None, *, out=None) -> c\n\n"
+"Encrypt the KYBER_INDCPA_MSGBYTES message m under pk.");
+
+static PyObject *enc(PyObject *self, PyObject *args, PyObject *kwds)
+{
+  (void)self;
+  return enc_common(args, kwds, 0);
+}
+
+PyDoc_STRVAR(enc_batch_doc,
+"enc_batch(m, pk, coins=None, *, out=None) -> c\n\n"
+"Encrypt n concatenated messages under the same pk, with\n"
+"n*KYBER_SYMBYTES coins if given. The public key is unpacked and the\n"
+"matrix expanded once for all n.");
+
+static PyObject *enc_batch(PyObject *self, PyObject *args, PyObject *kwds)
+{
+  (void)self;
+  return enc_common(args, kwds, 1);
+}
+
+static PyObject *dec_common(PyObject *args, PyObject *kwds, int batch)
+{
+  static char *kwlist[] = {"c", "sk", "out", NULL};
+  Py_ssize_t n = 1;
+  uint8_t *m;
+  Py_buffer bc = {0}, bsk = {0}, bout = {0};
+  PyObject *r = NULL;
+
+  if(!PyArg_ParseTupleAndKeywords(args, kwds, "y*y*|$w*", kwlist, &bc, &bsk, &bout))
+    return NULL;
+  if((batch ? check_batch(&n, &bc, KYBER_INDCPA_BYTES, "c") : check_len(&bc, KYBER_INDCPA_BYTES, "c"))
+     || check_len(&bsk, KYBER_INDCPA_SECRETKEYBYTES, "sk"))
+    goto out;
+  r = output(&m, &bout, n*KYBER_INDCPA_MSGBYTES);
+  if(!r)
+    goto out;
+
+  Py_BEGIN_ALLOW_THREADS
+  if(batch)
+    cdpre_dec_batch(m, bc.buf, n, bsk.buf);
+  else
+    cdpre_dec(m, bc.buf, bsk.buf);
+  Py_END_ALLOW_THREADS
+
+out:
+  PyBuffer_Release(&bc);
+  PyBuffer_Release(&bsk);
+  PyBuffer_Release(&bout);
+  return r;
+}
+
+PyDoc_STRVAR(dec_doc,
+"dec(c, sk, *, out=None) -> m\n\n"
+"Decrypt the ciphertext c with sk.");
+
+static PyObject *dec(PyObject *self, PyObject *args, PyObject *kwds)
+{
+  (void)self;
+  return dec_common(args, kwds, 0);
+}
+
+PyDoc_STRVAR(dec_batch_doc,
+"dec_batch(c, sk, *, out=None) -> m\n\n"
+"Decrypt n concatenated ciphertexts with the same sk, which is unpacked\n"
+"once.");
+
+static PyObject *dec_batch(PyObject *self, PyObject *args, PyObject *kwds)
+{
+  (void)self;
+  return dec_common(args, kwds, 1);
+}
+
+static PyObject *rkg_common(PyObject *args, PyObject *kwds, int batch)
+{
+  static char *kwlist[] = {"sk_i", "pk_j", "c_i", "coins", "out", NULL};
+  Py_ssize_t k, n = 1;
+  uint8_t *rk = NULL, *coins = NULL;
+  Py_buffer bsk = {0}, bpk = {0}, bc = {0}, bcoins = {0}, bout = {0};
+  PyObject *r = NULL;
+
+  if(!PyArg_ParseTupleAndKeywords(args, kwds, "y*y*y*|y*$w*", kwlist, &bsk, &bpk, &bc, &bcoins, &bout))
+    return NULL;
+  if(check_len(&bsk, KYBER_INDCPA_SECRETKEYBYTES, "sk_i") || check_len(&bpk, KYBER_INDCPA_PUBLICKEYBYTES, "pk_j")
+     || (batch ? check_batch(&n, &bc, KYBER_INDCPA_BYTES, "c_i") : check_len(&bc, KYBER_INDCPA_BYTES, "c_i"))
+     || get_coins(&coins, &bcoins, n))
+    goto out;
+  r = output(&rk, &bout, n*KYBER_INDCPA_BYTES);
+  if(!r)
+    goto out;
+
+  Py_BEGIN_ALLOW_THREADS
+  draw_coins(coins, &bcoins, n);
+  for(k=0;k<n;k++)
+    cdpre_rkg(bsk.buf, bpk.buf, (uint8_t *)bc.buf + k*KYBER_INDCPA_BYTES,
+              rk + k*KYBER_INDCPA_BYTES, coins + k*KYBER_SYMBYTES);
+  Py_END_ALLOW_THREADS
+
+out:
+  free_coins(coins, &bcoins, n);
+  PyBuffer_Release(&bsk);
+  PyBuffer_Release(&bpk);
+  PyBuffer_Release(&bc);
+  PyBuffer_Release(&bcoins);
+  PyBuffer_Release(&bout);
+  return r;
+}
+
+PyDoc_STRVAR(rkg_doc,
+"rkg(sk_i, pk_j, c_i, coins=None, *, out=None) -> rk\n\n"
+"Generate the re-key of the ciphertext c_i from sk_i to pk_j.");
+
+static PyObject *rkg(PyObject *self, PyObject *args, PyObject *kwds)
+{
+  (void)self;
+  return rkg_common(args, kwds, 0);
+}
+
+PyDoc_STRVAR(rkg_batch_doc,
+"rkg_batch(sk_i, pk_j, c_i, coins=None, *, out=None) -> rk\n\n"
+"Generate the re-keys of n concatenated ciphertexts from sk_i to pk_j,\n"
+"with n*KYBER_SYMBYTES coins if given.");
+
+static PyObject *rkg_batch(PyObject *self, PyObject *args, PyObject *kwds)
+{
+  (void)self;
+  return rkg_common(args, kwds, 1);
+}
+
+static PyObject *renc_common(PyObject *args, PyObject *kwds, int batch)
+{
+  static char *kwlist[] = {"rk", "c_i", "out", NULL};
+  Py_ssize_t k, n = 1;
+  uint8_t *c;
+  Py_buffer brk = {0}, bc = {0}, bout = {0};
+  PyObject *r = NULL;
+
+  if(!PyArg_ParseTupleAndKeywords(args, kwds, "y*y*|$w*", kwlist, &brk, &bc, &bout))
+    return NULL;
+  if((batch ? check_batch(&n, &bc, KYBER_INDCPA_BYTES, "c_i") : check_len(&bc, KYBER_INDCPA_BYTES, "c_i"))
+     || check_len(&brk, n*KYBER_INDCPA_BYTES, "rk"))
+    goto out;
+  r = output(&c, &bout, n*KYBER_INDCPA_BYTES);
+  if(!r)
+    goto out;
+
+  Py_BEGIN_ALLOW_THREADS
+  for(k=0;k<n;k++)
+    cdpre_renc((uint8_t *)brk.buf + k*KYBER_INDCPA_BYTES, (uint8_t *)bc.buf + k*KYBER_INDCPA_BYTES,
+               c + k*KYBER_INDCPA_BYTES);
+  Py_END_ALLOW_THREADS
+
+out:
+  PyBuffer_Release(&brk);
+  PyBuffer_Release(&bc);
+  PyBuffer_Release(&bout);
+  return r;
+}
+
+PyDoc_STRVAR(renc_doc,
+"renc(rk, c_i, *, out=None) -> c_j\n\n"
+"Re-encrypt the ciphertext c_i with its re-key rk. out may be c_i.");
+
+static PyObject *renc(PyObject *self, PyObject *args, PyObject *kwds)
+{
+  (void)self;
+  return renc_common(args, kwds, 0);
+}
+
+PyDoc_STRVAR(renc_batch_doc,
+"renc_batch(rk, c_i, *, out=None) -> c_j\n\n"
+"Re-encrypt n concatenated ciphertexts, each with its own re-key of the\n"
+"n concatenated in rk. out may be c_i.");
+
+static PyObject *renc_batch(PyObject *self, PyObject *args, PyObject *kwds)
+{
+  (void)self;
+  return renc_common(args, kwds, 1);
+}
+
+static PyMethodDef methods[] = {
+  {"keygen", (PyCFunction)(void (*)(void))keygen, METH_VARARGS | METH_KEYWORDS, keygen_doc},
+  {"keygen_batch", (PyCFunction)(void (*)(void))keygen_batch, METH_VARARGS | METH_KEYWORDS, keygen_batch_doc},
+  {"enc", (PyCFunction)(void (*)(void))enc, METH_VARARGS | METH_KEYWORDS, enc_doc},
+  {"enc_batch", (PyCFunction)(void (*)(void))enc_batch, METH_VARARGS | METH_KEYWORDS, enc_batch_doc},
+  {"dec", (PyCFunction)(void (*)(void))dec, METH_VARARGS | METH_KEYWORDS, dec_doc},
+  {"dec_batch", (PyCFunction)(void (*)(void))dec_batch, METH_VARARGS | METH_KEYWORDS, dec_batch_doc},
+  {"rkg", (PyCFunction)(void (*)(void))rkg, METH_VARARGS | METH_KEYWORDS, rkg_doc},
+  {"rkg_batch", (PyCFunction)(void (*)(void))rkg_batch, METH_VARARGS | METH_KEYWORDS, rkg_batch_doc},
+  {"renc", (PyCFunction)(void (*)(void))renc, METH_VARARGS | METH_KEYWORDS, renc_doc},
+  {"renc_batch", (PyCFunction)(void (*)(void))renc_batch, METH_VARARGS | METH_KEYWORDS, renc_batch_doc},
+  {NULL, NULL, 0, NULL}
+};
+
+static struct PyModuleDef module = {
+  PyModuleDef_HEAD_INIT,
+  MODULE_NAME,
+  "IND-CPA encryption and cdPRE on Kyber, on any buffer and without the GIL.",
+  -1,
+  methods,
+  NULL, NULL, NULL, NULL
+};
+
+PyMODINIT_FUNC MODULE_INIT(void)
+{
+  PyObject *m;
+
+  m = PyModule_Create(&module);
+  if(!m)
+    return NULL;
+  if(PyModule_AddIntConstant(m, "K", KYBER_K)
+     || PyModule_AddIntConstant(m, "SYMBYTES", KYBER_SYMBYTES)
+     || PyModule_AddIntConstant(m, "MSGBYTES", KYBER_INDCPA_MSGBYTES)
+     || PyModule_AddIntConstant(m, "PUBLICKEYBYTES", KYBER_INDCPA_PUBLICKEYBYTES)
+     || PyModule_AddIntConstant(m, "SECRETKEYBYTES", KYBER_INDCPA_SECRETKEYBYTES)
+     || PyModule_AddIntConstant(m, "CIPHERTEXTBYTES", KYBER_INDCPA_BYTES)) {
+    Py_DECREF(m);
+    return NULL;
+  }
+  return m;
+}
@@ -0,0 +1,466 @@
+#include <errno.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <immintrin.h>
+#include "fips202x4.h"
+#include "dem.h"
+#include "verify.h"
+
+/* Use implementation from the Keccak Code Package */
+#define KeccakF1600_StatePermute4x FIPS202X4_NAMESPACE(KeccakP1600times4_PermuteAll_24rounds)
+extern void KeccakF1600_StatePermute4x(__m256i *s);
+
+#define MAGIC "KDEM"
+#define VERSION 1
+#define BLOCKBYTES 128
+#define STRIDE (DEM_CHUNKBYTES + DEM_TAGBYTES)
+
+static void store_lanes(uint8_t **out, size_t pos, __m256i o, unsigned int nlanes)
+{
+  unsigned int l;
+  uint64_t w[4];
+  __m128d t;
+
+  if(nlanes == 4) {
+    t = _mm_castsi128_pd(_mm256_castsi256_si128(o));
+    _mm_storel_pd((__attribute__((__may_alias__)) double *)&out[0][pos], t);
+    _mm_storeh_pd((__attribute__((__may_alias__)) double *)&out[1][pos], t);
+    t = _mm_castsi128_pd(_mm256_extracti128_si256(o,1));
+    _mm_storel_pd((__attribute__((__may_alias__)) double *)&out[2][pos], t);
+    _mm_storeh_pd((__attribute__((__may_alias__)) double *)&out[3][pos], t);
+  }
+  else {
+    _mm256_storeu_si256((__m256i *)w, o);
+    for(l=0;l<nlanes;l++)
+      memcpy(&out[l][pos], &w[l], 8);
+  }
+}
+
+/*************************************************
+* Name:        chunks_x4
+*
+* Description: Encrypt or decrypt up to four chunks of the same length on
+*              the lanes of the four-way Keccak, with consecutive indices
+*
+* Arguments:   - uint8_t *out[4]: pointers to output data, may be equal to in
+*              - uint8_t *tag[4]: pointers to output tags
+*                                 (of length DEM_TAGBYTES)
+*              - const uint8_t *in[4]: pointers to input data
+*              - unsigned int nlanes: number of chunks, 1 to 4; only the
+*                                     first nlanes pointers are used
+*              - size_t len: length of each chunk
+*              - const uint8_t *key: pointer to key (of length DEM_KEYBYTES)
+*              - const uint8_t *nonce: pointer to nonce
+*                                      (of length DEM_NONCEBYTES)
+*              - uint64_t index: index of the first chunk
+*              - int final: whether the (single) chunk is the last one
+*              - int decrypt: whether the input is ciphertext
+**************************************************/
+static void chunks_x4(uint8_t **out,
+                      uint8_t **tag,
+                      const uint8_t **in,
+                      unsigned int nlanes,
+                      size_t len,
+                      const uint8_t key[DEM_KEYBYTES],
+                      const uint8_t nonce[DEM_NONCEBYTES],
+                      uint64_t index,
+                      int final,
+                      int decrypt)
+{
+  unsigned int i, l, r;
+  size_t pos;
+  uint64_t mask;
+  __m256i s[25], t, o, idx;
+  uint8_t blk[4][BLOCKBYTES];
+  uint8_t *pblk[4] = {blk[0], blk[1], blk[2], blk[3]};
+  const uint8_t *p[4];
+
+  for(l=0;l<4;l++)
+    p[l] = in[l < nlanes ? l : 0];
+
+  // key, nonce, le64(index), final
+  memset(blk, 0, sizeof(blk));
+  for(l=0;l<4;l++) {
+    memcpy(blk[l], key, DEM_KEYBYTES);
+    memcpy(blk[l]+DEM_KEYBYTES, nonce, DEM_NONCEBYTES);
+    for(i=0;i<8;i++)
+      blk[l][32+i] = (index + l) >> 8*i;
+    blk[l][40] = final;
+    blk[l][41] = 0x03;
+  }
+  idx = _mm256_set_epi64x((long long)blk[3], (long long)blk[2], (long long)blk[1], (long long)blk[0]);
+  for(i=0;i<BLOCKBYTES/8;i++)
+    s[i] = _mm256_i64gather_epi64((long long *)(uintptr_t)(8*i), idx, 1);
+  for(i=BLOCKBYTES/8;i<25;i++)
+    s[i] = _mm256_setzero_si256();
+  s[16] = _mm256_set1_epi64x(1ULL << 63);
+  KeccakF1600_StatePermute4x(s);
+
+  // full blocks: the ciphertext overwrites the state
+  for(pos=0;len-pos>=BLOCKBYTES;pos+=BLOCKBYTES) {
+    idx = _mm256_set_epi64x((long long)(p[3]+pos), (long long)(p[2]+pos),
+                            (long long)(p[1]+pos), (long long)(p[0]+pos));
+    for(i=0;i<BLOCKBYTES/8;i++) {
+      t = _mm256_i64gather_epi64((long long *)(uintptr_t)(8*i), idx, 1);
+      o = _mm256_xor_si256(s[i], t);
+      s[i] = decrypt ? t : o;
+      store_lanes(out, pos+8*i, o, nlanes);
+    }
+    s[16] = _mm256_xor_si256(s[16], _mm256_set1_epi64x(0x8000000000000001ULL));
+    KeccakF1600_StatePermute4x(s);
+  }
+
+  // last block of r < BLOCKBYTES bytes, possibly empty
+  r = len - pos;
+  memset(blk, 0, sizeof(blk));
+  for(l=0;l<4;l++)
+    memcpy(blk[l], p[l]+pos, r);
+  idx = _mm256_set_epi64x((long long)blk[3], (long long)blk[2], (long long)blk[1], (long long)blk[0]);
+  for(i=0;i<BLOCKBYTES/8;i++) {
+    t = _mm256_i64gather_epi64((long long *)(uintptr_t)(8*i), idx, 1);
+    o = _mm256_xor_si256(s[i], t);
+    if(8*i+8 <= r)
+      mask = -1ULL;
+    else if(8*i >= r)
+      mask = 0;
+    else
+      mask = (1ULL << 8*(r-8*i)) - 1;
+    s[i] = decrypt ? t : _mm256_and_si256(o, _mm256_set1_epi64x(mask));
+    store_lanes(pblk, 8*i, o, 4);
+  }
+  for(l=0;l<nlanes;l++)
+    memcpy(out[l]+pos, blk[l], r);
+  s[r/8] = _mm256_xor_si256(s[r/8], _mm256_set1_epi64x(2ULL << 8*(r%8)));
+  s[16] = _mm256_xor_si256(s[16], _mm256_set1_epi64x(1ULL << 63));
+  KeccakF1600_StatePermute4x(s);
+
+  store_lanes(tag, 0, s[0], nlanes);
+  store_lanes(tag, 8, s[1], nlanes);
+  wipe(blk, sizeof(blk));
+  wipe(s, sizeof(s));
+}
+
+static void pack_header(uint8_t h[DEM_HEADERBYTES], const uint8_t nonce[DEM_NONCEBYTES])
+{
+  memcpy(h, MAGIC, 4);
+  h[4] = VERSION;
+  h[5] = DEM_LOGCHUNKBYTES;
+  h[6] = h[7] = 0;
+  memcpy(h+8, nonce, DEM_NONCEBYTES);
+}
+
+static int check_header(const uint8_t h[DEM_HEADERBYTES])
+{
+  if(memcmp(h, MAGIC, 4) || h[4] != VERSION || h[5] != DEM_LOGCHUNKBYTES || h[6] || h[7])
+    return -1;
+  return 0;
+}
+
+// encrypt or decrypt n <= 4 full chunks, at the given strides in out and in
+static void full_chunks(uint8_t *out, const uint8_t *in, uint8_t (*tag)[DEM_TAGBYTES],
+                        unsigned int n, size_t ostride, size_t istride,
+                        const uint8_t key[DEM_KEYBYTES], const uint8_t nonce[DEM_NONCEBYTES],
+                        uint64_t index, int decrypt)
+{
+  unsigned int l;
+  uint8_t *po[4], *pt[4];
+  const uint8_t *pi[4];
+
+  for(l=0;l<n;l++) {
+    po[l] = out + l*ostride;
+    pi[l] = in + l*istride;
+    pt[l] = tag[l];
+  }
+  chunks_x4(po, pt, pi, n, DEM_CHUNKBYTES, key, nonce, index, 0, decrypt);
+}
+
+/*************************************************
+* Name:        dem_encrypt
+*
+* Description: Encrypt a payload in one buffer, e.g. a memory-mapped file
+*
+* Arguments:   - uint8_t *c: pointer to output ciphertext
+*                            (of length DEM_CIPHERTEXTBYTES(mlen))
+*              - const uint8_t *m: pointer to input payload
+*              - size_t mlen: length of the payload
+*              - const uint8_t *key: pointer to input key sek
+*                                    (of length DEM_KEYBYTES)
+*              - const uint8_t *nonce: pointer to input nonce
+*                                      (of length DEM_NONCEBYTES), never
+*                                      to be used twice with the same key
+**************************************************/
+void dem_encrypt(uint8_t *c,
+                 const uint8_t *m,
+                 size_t mlen,
+                 const uint8_t key[DEM_KEYBYTES],
+                 const uint8_t nonce[DEM_NONCEBYTES])
+{
+  unsigned int l, n;
+  size_t k, nfull = mlen/DEM_CHUNKBYTES;
+  uint8_t tag[4][DEM_TAGBYTES];
+  uint8_t *po[1], *pt[1];
+  const uint8_t *pi[1];
+
+  pack_header(c, nonce);
+  c += DEM_HEADERBYTES;
+
+  for(k=0;k<nfull;k+=n) {
+    n = (nfull - k < 4) ? nfull - k : 4;
+    full_chunks(c + k*STRIDE, m + k*DEM_CHUNKBYTES, tag, n, STRIDE, DEM_CHUNKBYTES, key, nonce, k, 0);
+    for(l=0;l<n;l++)
+      memcpy(c + (k+l)*STRIDE + DEM_CHUNKBYTES, tag[l], DEM_TAGBYTES);
+  }
+
+  po[0] = c + nfull*STRIDE;
+  pi[0] = m + nfull*DEM_CHUNKBYTES;
+  pt[0] = po[0] + mlen % DEM_CHUNKBYTES;
+  chunks_x4(po, pt, pi, 1, mlen % DEM_CHUNKBYTES, key, nonce, nfull, 1, 0);
+}
+
+/*************************************************
+* Name:        dem_decrypt
+*
+* Description: Decrypt and verify a ciphertext in one buffer
+*
+* Arguments:   - uint8_t *m: pointer to output payload, of at least
+*                            clen - DEM_HEADERBYTES - DEM_TAGBYTES bytes;
+*                            must not overlap c
+*              - size_t *mlen: pointer to output length of the payload
+*              - const uint8_t *c: pointer to input ciphertext
+*              - size_t clen: length of the ciphertext
+*              - const uint8_t *key: pointer to input key sek
+*                                    (of length DEM_KEYBYTES)
+*
+* Returns 0 on success, -1 if the ciphertext is malformed or does not
+* verify; then the output is erased
+**************************************************/
+int dem_decrypt(uint8_t *m,
+                size_t *mlen,
+                const uint8_t *c,
+                size_t clen,
+                const uint8_t key[DEM_KEYBYTES])
+{
+  int r = 0;
+  unsigned int l, n;
+  size_t k, nfull, last;
+  const uint8_t *nonce = c + 8;
+  uint8_t tag[4][DEM_TAGBYTES];
+  uint8_t *po[1], *pt[1];
+  const uint8_t *pi[1];
+
+  *mlen = 0;
+  if(clen < DEM_HEADERBYTES + DEM_TAGBYTES || check_header(c))
+    return -1;
+  clen -= DEM_HEADERBYTES;
+  c += DEM_HEADERBYTES;
+  nfull = clen/STRIDE;
+  last = clen % STRIDE;
+  if(last < DEM_TAGBYTES)
+    return -1;
+  last -= DEM_TAGBYTES;
+
+  for(k=0;k<nfull;k+=n) {
+    n = (nfull - k < 4) ? nfull - k : 4;
+    full_chunks(m + k*DEM_CHUNKBYTES, c + k*STRIDE, tag, n, DEM_CHUNKBYTES, STRIDE, key, nonce, k, 1);
+    for(l=0;l<n;l++)
+      r |= verify(tag[l], c + (k+l)*STRIDE + DEM_CHUNKBYTES, DEM_TAGBYTES);
+  }
+
+  po[0] = m + nfull*DEM_CHUNKBYTES;
+  pi[0] = c + nfull*STRIDE;
+  pt[0] = tag[0];
+  chunks_x4(po, pt, pi, 1, last, key, nonce, nfull, 1, 1);
+  r |= verify(tag[0], pi[0] + last, DEM_TAGBYTES);
+
+  if(r) {
+    wipe(m, nfull*DEM_CHUNKBYTES + last);
+    return -1;
+  }
+  *mlen = nfull*DEM_CHUNKBYTES + last;
+  return 0;
+}
+
+// read len bytes unless the end of the file comes first
+static ssize_t read_full(int fd, uint8_t *buf, size_t len)
+{
+  ssize_t n;
+  size_t pos = 0;
+
+  while(pos < len) {
+    n = read(fd, buf + pos, len - pos);
+    if(n < 0 && errno == EINTR)
+      continue;
+    if(n < 0)
+      return -1;
+    if(n == 0)
+      break;
+    pos += n;
+  }
+  return pos;
+}
+
+static int write_full(int fd, const uint8_t *buf, size_t len)
+{
+  ssize_t n;
+
+  while(len > 0) {
+    n = write(fd, buf, len);
+    if(n < 0 && errno == EINTR)
+      continue;
+    if(n <= 0)
+      return -1;
+    buf += n;
+    len -= n;
+  }
+  return 0;
+}
+
+/*************************************************
+* Name:        dem_encrypt_fd
+*
+* Description: Encrypt a stream, reading and encrypting four chunks at a
+*              time in a buffer of 4*(DEM_CHUNKBYTES+DEM_TAGBYTES) bytes
+*
+* Arguments:   - int out: file descriptor to write the ciphertext to
+*              - int in: file descriptor to read the payload from, up to
+*                        the end of the file
+*              - const uint8_t *key: pointer to input key sek
+*                                    (of length DEM_KEYBYTES)
+*              - const uint8_t *nonce: pointer to input nonce
+*                                      (of length DEM_NONCEBYTES), never
+*                                      to be used twice with the same key
+*
+* Returns 0 on success, -1 on I/O errors or out of memory
+**************************************************/
+int dem_encrypt_fd(int out, int in, const uint8_t key[DEM_KEYBYTES], const uint8_t nonce[DEM_NONCEBYTES])
+{
+  int r = -1;
+  unsigned int l, n;
+  ssize_t len = 0;
+  uint64_t index = 0;
+  uint8_t header[DEM_HEADERBYTES], tag[4][DEM_TAGBYTES];
+  uint8_t *buf, *po[1], *pt[1];
+  const uint8_t *pi[1];
+
+  buf = malloc(4*STRIDE);
+  if(!buf)
+    return -1;
+  pack_header(header, nonce);
+  if(write_full(out, header, DEM_HEADERBYTES))
+    goto out;
+
+  for(;;) {
+    for(n=0;n<4;n++) {
+      len = read_full(in, buf + n*STRIDE, DEM_CHUNKBYTES);
+      if(len < 0)
+        goto out;
+      if(len < DEM_CHUNKBYTES)
+        break;
+    }
+
+    if(n) {
+      full_chunks(buf, buf, tag, n, STRIDE, STRIDE, key, nonce, index, 0);
+      for(l=0;l<n;l++)
+        memcpy(buf + l*STRIDE + DEM_CHUNKBYTES, tag[l], DEM_TAGBYTES);
+      if(write_full(out, buf, n*STRIDE))
+        goto out;
+      index += n;
+    }
+
+    // a chunk shorter than DEM_CHUNKBYTES, possibly empty, is the last
+    if(n < 4) {
+      po[0] = buf + n*STRIDE;
+      pi[0] = po[0];
+      pt[0] = po[0] + len;
+      chunks_x4(po, pt, pi, 1, len, key, nonce, index, 1, 0);
+      if(write_full(out, po[0], len + DEM_TAGBYTES))
+        goto out;
+      break;
+    }
+  }
+  r = 0;
+
+out:
+  wipe(buf, 4*STRIDE);
+  free(buf);
+  return r;
+}
+
+/*************************************************
+* Name:        dem_decrypt_fd
+*
+* Description: Decrypt and verify a stream, four chunks at a time in a
+*              buffer of 4*(DEM_CHUNKBYTES+DEM_TAGBYTES) bytes. Only
+*              verified chunks are written; if verification fails, what
+*              has been written is a prefix of the payload and has to be
+*              discarded with it.
+*
+* Arguments:   - int out: file descriptor to write the payload to
+*              - int in: file descriptor to read the ciphertext from, up
+*                        to the end of the file
+*              - const uint8_t *key: pointer to input key sek
+*                                    (of length DEM_KEYBYTES)
+*
+* Returns 0 on success, -1 on I/O errors, out of memory, or if the
+* ciphertext is malformed, truncated or does not verify
+**************************************************/
+int dem_decrypt_fd(int out, int in, const uint8_t key[DEM_KEYBYTES])
+{
+  int r = -1;
+  unsigned int l, n;
+  ssize_t len = 0;
+  uint64_t index = 0;
+  uint8_t header[DEM_HEADERBYTES], tag[4][DEM_TAGBYTES];
+  uint8_t *buf, *po[1], *pt[1];
+  const uint8_t *pi[1];
+  const uint8_t *nonce = header + 8;
+
+  buf = malloc(4*STRIDE);
+  if(!buf)
+    return -1;
+  if(read_full(in, header, DEM_HEADERBYTES) != DEM_HEADERBYTES || check_header(header))
+    goto out;
+
+  for(;;) {
+    for(n=0;n<4;n++) {
+      len = read_full(in, buf + n*STRIDE, STRIDE);
+      if(len < 0)
+        goto out;
+      if(len < STRIDE)
+        break;
+    }
+
+    if(n) {
+      full_chunks(buf, buf, tag, n, STRIDE, STRIDE, key, nonce, index, 1);
+      for(l=0;l<n;l++)
+        if(verify(tag[l], buf + l*STRIDE + DEM_CHUNKBYTES, DEM_TAGBYTES))
+          goto out;
+      for(l=0;l<n;l++)
+        if(write_full(out, buf + l*STRIDE, DEM_CHUNKBYTES))
+          goto out;
+      index += n;
+    }
+
+    if(n < 4) {
+      if(len < DEM_TAGBYTES)
+        goto out;
+      len -= DEM_TAGBYTES;
+      po[0] = buf + n*STRIDE;
+      pi[0] = po[0];
+      pt[0] = tag[0];
+      chunks_x4(po, pt, pi, 1, len, key, nonce, index, 1, 1);
+      if(verify(tag[0], po[0] + len, DEM_TAGBYTES) || write_full(out, po[0], len))
+        goto out;
+      break;
+    }
+  }
+  r = 0;
+
+out:
+  wipe(buf, 4*STRIDE);
+  free(buf);
+  return r;
+}
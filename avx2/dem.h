@@ -0,0 +1,54 @@
+#ifndef DEM_H
+#define DEM_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Data encapsulation of epoch payloads under the symmetric key sek of an
+ * epoch: authenticated encryption in chunks of DEM_CHUNKBYTES, so that
+ * payloads of any size are encrypted and decrypted in constant memory.
+ *
+ * A ciphertext is a header (the magic "KDEM", a version byte, log2 of the
+ * chunk size, two zero bytes and a nonce) followed by the chunks, each
+ * the encrypted data and a tag. All chunks but the last have
+ * DEM_CHUNKBYTES of data; the last one has less, and no data if the
+ * payload is a multiple of the chunk size. Each chunk is encrypted on its
+ * own Keccak-f[1600] duplex, keyed with sek, the nonce, its index and
+ * whether it is the last one, so chunks cannot be reordered, dropped or
+ * truncated without failing verification. Four chunks are processed at a
+ * time on the four-way Keccak.
+ *
+ * The duplex has a rate of 136 bytes and takes 128 bytes of data per
+ * permutation. A block of ciphertext overwrites the state; the next byte
+ * marks a full block (0x01) or the end of the data (0x02, right after the
+ * last byte of data) before the 0x80 of the padding in the last byte of
+ * the rate. The tag is the first DEM_TAGBYTES of the state afterwards.
+ */
+
+#define DEM_KEYBYTES 16
+#define DEM_NONCEBYTES 16
+#define DEM_TAGBYTES 16
+#define DEM_HEADERBYTES (8+DEM_NONCEBYTES)
+#define DEM_LOGCHUNKBYTES 16
+#define DEM_CHUNKBYTES (1 << DEM_LOGCHUNKBYTES)
+
+// ciphertext length of a payload of mlen bytes
+#define DEM_CIPHERTEXTBYTES(mlen) \
+  (DEM_HEADERBYTES + (mlen) + DEM_TAGBYTES*((mlen)/DEM_CHUNKBYTES + 1))
+
+void dem_encrypt(uint8_t *c,
+                 const uint8_t *m,
+                 size_t mlen,
+                 const uint8_t key[DEM_KEYBYTES],
+                 const uint8_t nonce[DEM_NONCEBYTES]);
+int dem_decrypt(uint8_t *m,
+                size_t *mlen,
+                const uint8_t *c,
+                size_t clen,
+                const uint8_t key[DEM_KEYBYTES]);
+
+int dem_encrypt_fd(int out, int in, const uint8_t key[DEM_KEYBYTES], const uint8_t nonce[DEM_NONCEBYTES]);
+int dem_decrypt_fd(int out, int in, const uint8_t key[DEM_KEYBYTES]);
+
+#endif
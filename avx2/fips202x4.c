@@ -198,3 +198,63 @@ void shake256x4(uint8_t *out0,
     }
   }
 }
+
+/*************************************************
+* Name:        sha3_256x4
+*
+* Description: SHA3-256 of four inputs of the same length
+*
+* Arguments:   - uint8_t *out0, ..., *out3: pointers to outputs (32 bytes each)
+*              - const uint8_t *in0, ..., *in3: pointers to inputs
+*              - size_t inlen: length of each input in bytes
+**************************************************/
+void sha3_256x4(uint8_t out0[32],
+                uint8_t out1[32],
+                uint8_t out2[32],
+                uint8_t out3[32],
+                const uint8_t *in0,
+                const uint8_t *in1,
+                const uint8_t *in2,
+                const uint8_t *in3,
+                size_t inlen)
+{
+  uint8_t t[4][SHA3_256_RATE];
+  keccakx4_state state;
+
+  keccakx4_absorb_once(state.s, SHA3_256_RATE, in0, in1, in2, in3, inlen, 0x06);
+  keccakx4_squeezeblocks(t[0], t[1], t[2], t[3], 1, SHA3_256_RATE, state.s);
+  memcpy(out0, t[0], 32);
+  memcpy(out1, t[1], 32);
+  memcpy(out2, t[2], 32);
+  memcpy(out3, t[3], 32);
+}
+
+/*************************************************
+* Name:        sha3_512x4
+*
+* Description: SHA3-512 of four inputs of the same length
+*
+* Arguments:   - uint8_t *out0, ..., *out3: pointers to outputs (64 bytes each)
+*              - const uint8_t *in0, ..., *in3: pointers to inputs
+*              - size_t inlen: length of each input in bytes
+**************************************************/
+void sha3_512x4(uint8_t out0[64],
+                uint8_t out1[64],
+                uint8_t out2[64],
+                uint8_t out3[64],
+                const uint8_t *in0,
+                const uint8_t *in1,
+                const uint8_t *in2,
+                const uint8_t *in3,
+                size_t inlen)
+{
+  uint8_t t[4][SHA3_512_RATE];
+  keccakx4_state state;
+
+  keccakx4_absorb_once(state.s, SHA3_512_RATE, in0, in1, in2, in3, inlen, 0x06);
+  keccakx4_squeezeblocks(t[0], t[1], t[2], t[3], 1, SHA3_512_RATE, state.s);
+  memcpy(out0, t[0], 64);
+  memcpy(out1, t[1], 64);
+  memcpy(out2, t[2], 64);
+  memcpy(out3, t[3], 64);
+}
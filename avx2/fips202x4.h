@@ -67,4 +67,26 @@ void shake256x4(uint8_t *out0,
                 const uint8_t *in3,
                 size_t inlen);
 
+#define sha3_256x4 FIPS202X4_NAMESPACE(sha3_256x4)
+void sha3_256x4(uint8_t out0[32],
+                uint8_t out1[32],
+                uint8_t out2[32],
+                uint8_t out3[32],
+                const uint8_t *in0,
+                const uint8_t *in1,
+                const uint8_t *in2,
+                const uint8_t *in3,
+                size_t inlen);
+
+#define sha3_512x4 FIPS202X4_NAMESPACE(sha3_512x4)
+void sha3_512x4(uint8_t out0[64],
+                uint8_t out1[64],
+                uint8_t out2[64],
+                uint8_t out3[64],
+                const uint8_t *in0,
+                const uint8_t *in1,
+                const uint8_t *in2,
+                const uint8_t *in3,
+                size_t inlen);
+
 #endif
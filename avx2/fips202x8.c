@@ -0,0 +1,260 @@
+#include <stddef.h>
+#include <stdint.h>
+#include <immintrin.h>
+#include <string.h>
+#include "fips202.h"
+#include "fips202x8.h"
+
+#ifdef KECCAK_X8
+/*
+ * Keccak-p[1600] on eight independent states, lane i of every state word
+ * in the 64-bit element i of one zmm register. Compared with the four-way
+ * AVX2 code, rotations are single vprolq instructions and the five-input
+ * xor of theta and the and-not of chi are vpternlogq.
+ */
+
+static const uint64_t KeccakF_RoundConstants[24] = {
+  0x0000000000000001ULL, 0x0000000000008082ULL,
+  0x800000000000808aULL, 0x8000000080008000ULL,
+  0x000000000000808bULL, 0x0000000080000001ULL,
+  0x8000000080008081ULL, 0x8000000000008009ULL,
+  0x000000000000008aULL, 0x0000000000000088ULL,
+  0x0000000080008009ULL, 0x000000008000000aULL,
+  0x000000008000808bULL, 0x800000000000008bULL,
+  0x8000000000008089ULL, 0x8000000000008003ULL,
+  0x8000000000008002ULL, 0x8000000000000080ULL,
+  0x000000000000800aULL, 0x800000008000000aULL,
+  0x8000000080008081ULL, 0x8000000000008080ULL,
+  0x0000000080000001ULL, 0x8000000080008008ULL
+};
+
+#define XOR3(a,b,c) _mm512_ternarylogic_epi64(a, b, c, 0x96)
+#define ROL(a,n)    _mm512_rol_epi64(a, n)
+/* a ^ (~b & c) */
+#define CHI(a,b,c)  _mm512_ternarylogic_epi64(a, b, c, 0xD2)
+
+/*
+ * One round from state A to state E: theta, then rho and pi for one row of
+ * E at a time, each row followed by its chi, and iota.
+ */
+#define ROUND(A, E, rc) do { \
+    for(x = 0; x < 5; x++) \
+      C[x] = XOR3(XOR3(A[x], A[x+5], A[x+10]), A[x+15], A[x+20]); \
+    for(x = 0; x < 5; x++) \
+      D[x] = _mm512_xor_si512(C[(x+4)%5], ROL(C[(x+1)%5], 1)); \
+    B0 = _mm512_xor_si512(A[ 0], D[0]); \
+    B1 = ROL(_mm512_xor_si512(A[ 6], D[1]), 44); \
+    B2 = ROL(_mm512_xor_si512(A[12], D[2]), 43); \
+    B3 = ROL(_mm512_xor_si512(A[18], D[3]), 21); \
+    B4 = ROL(_mm512_xor_si512(A[24], D[4]), 14); \
+    E[ 0] = CHI(B0, B1, B2); \
+    E[ 1] = CHI(B1, B2, B3); \
+    E[ 2] = CHI(B2, B3, B4); \
+    E[ 3] = CHI(B3, B4, B0); \
+    E[ 4] = CHI(B4, B0, B1); \
+    B0 = ROL(_mm512_xor_si512(A[ 3], D[3]), 28); \
+    B1 = ROL(_mm512_xor_si512(A[ 9], D[4]), 20); \
+    B2 = ROL(_mm512_xor_si512(A[10], D[0]),  3); \
+    B3 = ROL(_mm512_xor_si512(A[16], D[1]), 45); \
+    B4 = ROL(_mm512_xor_si512(A[22], D[2]), 61); \
+    E[ 5] = CHI(B0, B1, B2); \
+    E[ 6] = CHI(B1, B2, B3); \
+    E[ 7] = CHI(B2, B3, B4); \
+    E[ 8] = CHI(B3, B4, B0); \
+    E[ 9] = CHI(B4, B0, B1); \
+    B0 = ROL(_mm512_xor_si512(A[ 1], D[1]),  1); \
+    B1 = ROL(_mm512_xor_si512(A[ 7], D[2]),  6); \
+    B2 = ROL(_mm512_xor_si512(A[13], D[3]), 25); \
+    B3 = ROL(_mm512_xor_si512(A[19], D[4]),  8); \
+    B4 = ROL(_mm512_xor_si512(A[20], D[0]), 18); \
+    E[10] = CHI(B0, B1, B2); \
+    E[11] = CHI(B1, B2, B3); \
+    E[12] = CHI(B2, B3, B4); \
+    E[13] = CHI(B3, B4, B0); \
+    E[14] = CHI(B4, B0, B1); \
+    B0 = ROL(_mm512_xor_si512(A[ 4], D[4]), 27); \
+    B1 = ROL(_mm512_xor_si512(A[ 5], D[0]), 36); \
+    B2 = ROL(_mm512_xor_si512(A[11], D[1]), 10); \
+    B3 = ROL(_mm512_xor_si512(A[17], D[2]), 15); \
+    B4 = ROL(_mm512_xor_si512(A[23], D[3]), 56); \
+    E[15] = CHI(B0, B1, B2); \
+    E[16] = CHI(B1, B2, B3); \
+    E[17] = CHI(B2, B3, B4); \
+    E[18] = CHI(B3, B4, B0); \
+    E[19] = CHI(B4, B0, B1); \
+    B0 = ROL(_mm512_xor_si512(A[ 2], D[2]), 62); \
+    B1 = ROL(_mm512_xor_si512(A[ 8], D[3]), 55); \
+    B2 = ROL(_mm512_xor_si512(A[14], D[4]), 39); \
+    B3 = ROL(_mm512_xor_si512(A[15], D[0]), 41); \
+    B4 = ROL(_mm512_xor_si512(A[21], D[1]),  2); \
+    E[20] = CHI(B0, B1, B2); \
+    E[21] = CHI(B1, B2, B3); \
+    E[22] = CHI(B2, B3, B4); \
+    E[23] = CHI(B3, B4, B0); \
+    E[24] = CHI(B4, B0, B1); \
+    E[0] = _mm512_xor_si512(E[0], _mm512_set1_epi64(rc)); \
+  } while(0)
+
+/*************************************************
+* Name:        KeccakF1600_StatePermute8x
+*
+* Description: The Keccak F1600 permutation on eight states. Rounds
+*              alternate between two local copies of the state so that the
+*              compiler can keep both in registers.
+*
+* Arguments:   - __m512i *s: pointer to input/output state
+**************************************************/
+static void KeccakF1600_StatePermute8x(__m512i s[25])
+{
+  unsigned int round, x;
+  __m512i A[25], E[25], C[5], D[5], B0, B1, B2, B3, B4;
+
+  for(x = 0; x < 25; x++)
+    A[x] = s[x];
+  for(round = 0; round < 24; round += 2) {
+    ROUND(A, E, KeccakF_RoundConstants[round]);
+    ROUND(E, A, KeccakF_RoundConstants[round+1]);
+  }
+  for(x = 0; x < 25; x++)
+    s[x] = A[x];
+}
+
+static void keccakx8_absorb_once(__m512i s[25],
+                                 unsigned int r,
+                                 const uint8_t *in[8],
+                                 size_t inlen,
+                                 uint8_t p)
+{
+  size_t i, j;
+  uint64_t pos = 0;
+  __m512i t, idx;
+
+  for(i = 0; i < 25; ++i)
+    s[i] = _mm512_setzero_si512();
+
+  idx = _mm512_set_epi64((long long)in[7], (long long)in[6], (long long)in[5], (long long)in[4],
+                         (long long)in[3], (long long)in[2], (long long)in[1], (long long)in[0]);
+  while(inlen >= r) {
+    for(i = 0; i < r/8; ++i) {
+      t = _mm512_i64gather_epi64(idx, (long long *)pos, 1);
+      s[i] = _mm512_xor_si512(s[i], t);
+      pos += 8;
+    }
+    inlen -= r;
+
+    KeccakF1600_StatePermute8x(s);
+  }
+
+  for(i = 0; i < inlen/8; ++i) {
+    t = _mm512_i64gather_epi64(idx, (long long *)pos, 1);
+    s[i] = _mm512_xor_si512(s[i], t);
+    pos += 8;
+  }
+  inlen -= 8*i;
+
+  // the last partial word is copied so that no lane is read past its end
+  if(inlen) {
+    uint64_t w[8] = {0};
+    for(j = 0; j < 8; ++j)
+      memcpy(&w[j], in[j] + pos, inlen);
+    t = _mm512_loadu_si512((const __m512i *)w);
+    s[i] = _mm512_xor_si512(s[i], t);
+  }
+
+  t = _mm512_set1_epi64((uint64_t)p << 8*inlen);
+  s[i] = _mm512_xor_si512(s[i], t);
+  t = _mm512_set1_epi64(1ULL << 63);
+  s[r/8 - 1] = _mm512_xor_si512(s[r/8 - 1], t);
+}
+
+static void keccakx8_squeezeblocks(uint8_t *out[8],
+                                   size_t nblocks,
+                                   unsigned int r,
+                                   __m512i s[25])
+{
+  unsigned int i;
+  uint64_t pos = 0;
+  __m512i idx;
+
+  idx = _mm512_set_epi64((long long)out[7], (long long)out[6], (long long)out[5], (long long)out[4],
+                         (long long)out[3], (long long)out[2], (long long)out[1], (long long)out[0]);
+  while(nblocks > 0) {
+    KeccakF1600_StatePermute8x(s);
+    for(i = 0; i < r/8; ++i) {
+      _mm512_i64scatter_epi64((long long *)pos, idx, s[i], 1);
+      pos += 8;
+    }
+    --nblocks;
+  }
+}
+
+void shake128x8_absorb_once(keccakx8_state *state,
+                            const uint8_t *in[8],
+                            size_t inlen)
+{
+  keccakx8_absorb_once(state->s, SHAKE128_RATE, in, inlen, 0x1F);
+}
+
+void shake128x8_squeezeblocks(uint8_t *out[8],
+                              size_t nblocks,
+                              keccakx8_state *state)
+{
+  keccakx8_squeezeblocks(out, nblocks, SHAKE128_RATE, state->s);
+}
+
+void shake256x8_absorb_once(keccakx8_state *state,
+                            const uint8_t *in[8],
+                            size_t inlen)
+{
+  keccakx8_absorb_once(state->s, SHAKE256_RATE, in, inlen, 0x1F);
+}
+
+void shake256x8_squeezeblocks(uint8_t *out[8],
+                              size_t nblocks,
+                              keccakx8_state *state)
+{
+  keccakx8_squeezeblocks(out, nblocks, SHAKE256_RATE, state->s);
+}
+
+static void shakex8(uint8_t *out[8],
+                    size_t outlen,
+                    const uint8_t *in[8],
+                    size_t inlen,
+                    unsigned int r)
+{
+  unsigned int i, j;
+  size_t nblocks = outlen/r;
+  uint8_t t[8][SHAKE128_RATE];
+  uint8_t *o[8];
+  keccakx8_state state;
+
+  keccakx8_absorb_once(state.s, r, in, inlen, 0x1F);
+  keccakx8_squeezeblocks(out, nblocks, r, state.s);
+  outlen -= nblocks*r;
+
+  if(outlen) {
+    for(j = 0; j < 8; ++j)
+      o[j] = t[j];
+    keccakx8_squeezeblocks(o, 1, r, state.s);
+    for(j = 0; j < 8; ++j)
+      for(i = 0; i < outlen; ++i)
+        out[j][nblocks*r + i] = t[j][i];
+  }
+}
+
+void shake128x8(uint8_t *out[8],
+                size_t outlen,
+                const uint8_t *in[8],
+                size_t inlen)
+{
+  shakex8(out, outlen, in, inlen, SHAKE128_RATE);
+}
+
+void shake256x8(uint8_t *out[8],
+                size_t outlen,
+                const uint8_t *in[8],
+                size_t inlen)
+{
+  shakex8(out, outlen, in, inlen, SHAKE256_RATE);
+}
+#endif
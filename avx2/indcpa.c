@@ -12,6 +12,8 @@
 #include "rejsample.h"
 #include "symmetric.h"
 #include "randombytes.h"
+#include "stats.h"
+#include "telemetry.h"
 
 /*************************************************
 * Name:        pack_pk
@@ -154,9 +156,109 @@ static unsigned int rej_uniform(int16_t *r,
   return ctr;
 }
 
+#if KYBER_K != 2 && defined(KECCAK_X8)
+static const uint8_t nonces_8x[8] = {0, 1, 2, 3, 4, 5, 6, 7};
+#endif
+
 #define gen_a(A,B)  gen_matrix(A,B,0)
 #define gen_at(A,B) gen_matrix(A,B,1)
 
+/*************************************************
+* Name:        gen_uniform_4x
+*
+* Description: Sample four matrix entries with one run of keccakx4, entry j
+*              from SHAKE128(seed[j] || xy[j] & 0xFF || xy[j] >> 8)
+*
+* Arguments:   - poly **r: array of four pointers to output polynomials
+*              - const uint8_t **seed: array of four pointers to input seeds
+*              - const uint16_t *xy: array of four domain separators
+**************************************************/
+static void gen_uniform_4x(poly *r[4], const uint8_t *seed[4], const uint16_t xy[4])
+{
+  unsigned int j, ctr[4], done;
+  ALIGNED_UINT8(REJ_UNIFORM_AVX_NBLOCKS*SHAKE128_RATE) buf[4];
+  keccakx4_state state;
+
+  for(j=0;j<4;j++) {
+    _mm256_store_si256(buf[j].vec, _mm256_loadu_si256((const __m256i *)seed[j]));
+    buf[j].coeffs[32] = xy[j] & 0xFF;
+    buf[j].coeffs[33] = xy[j] >> 8;
+  }
+
+  shake128x4_absorb_once(&state, buf[0].coeffs, buf[1].coeffs, buf[2].coeffs, buf[3].coeffs, 34);
+  shake128x4_squeezeblocks(buf[0].coeffs, buf[1].coeffs, buf[2].coeffs, buf[3].coeffs, REJ_UNIFORM_AVX_NBLOCKS, &state);
+
+  done = 1;
+  for(j=0;j<4;j++) {
+    ctr[j] = rej_uniform_avx(r[j]->coeffs, buf[j].coeffs);
+    done &= ctr[j] >= KYBER_N;
+  }
+
+  while(!done) {
+    shake128x4_squeezeblocks(buf[0].coeffs, buf[1].coeffs, buf[2].coeffs, buf[3].coeffs, 1, &state);
+
+    done = 1;
+    for(j=0;j<4;j++) {
+      ctr[j] += rej_uniform(r[j]->coeffs + ctr[j], KYBER_N - ctr[j], buf[j].coeffs, SHAKE128_RATE);
+      done &= ctr[j] >= KYBER_N;
+    }
+  }
+
+  for(j=0;j<4;j++)
+    poly_nttunpack(r[j]);
+}
+
+#ifdef KECCAK_X8
+/*************************************************
+* Name:        gen_uniform_8x
+*
+* Description: Sample eight matrix entries with one run of keccakx8, entry j
+*              from SHAKE128(seed[j] || xy[j] & 0xFF || xy[j] >> 8)
+*
+* Arguments:   - poly **r: array of eight pointers to output polynomials
+*              - const uint8_t **seed: array of eight pointers to input seeds
+*              - const uint16_t *xy: array of eight domain separators
+**************************************************/
+static void gen_uniform_8x(poly *r[8], const uint8_t *seed[8], const uint16_t xy[8])
+{
+  unsigned int j, ctr[8], done;
+  ALIGNED_UINT8(REJ_UNIFORM_AVX_NBLOCKS*SHAKE128_RATE) buf[8];
+  const uint8_t *in[8];
+  uint8_t *out[8];
+  keccakx8_state state;
+
+  for(j=0;j<8;j++) {
+    _mm256_store_si256(buf[j].vec, _mm256_loadu_si256((const __m256i *)seed[j]));
+    buf[j].coeffs[32] = xy[j] & 0xFF;
+    buf[j].coeffs[33] = xy[j] >> 8;
+    in[j] = out[j] = buf[j].coeffs;
+  }
+
+  shake128x8_absorb_once(&state, in, 34);
+  shake128x8_squeezeblocks(out, REJ_UNIFORM_AVX_NBLOCKS, &state);
+
+  done = 1;
+  for(j=0;j<8;j++) {
+    ctr[j] = rej_uniform_avx(r[j]->coeffs, buf[j].coeffs);
+    done &= ctr[j] >= KYBER_N;
+  }
+
+  while(!done) {
+    shake128x8_squeezeblocks(out, 1, &state);
+
+    done = 1;
+    for(j=0;j<8;j++) {
+      ctr[j] += rej_uniform(r[j]->coeffs + ctr[j], KYBER_N - ctr[j], buf[j].coeffs, SHAKE128_RATE);
+      done &= ctr[j] >= KYBER_N;
+    }
+  }
+
+  for(j=0;j<8;j++)
+    poly_nttunpack(r[j]);
+}
+
+#endif
+
 /*************************************************
 * Name:        gen_matrix
 *
@@ -226,6 +328,45 @@ void gen_matrix(polyvec *a, const uint8_t seed[32], int transposed)
   poly_nttunpack(&a[1].vec[0]);
   poly_nttunpack(&a[1].vec[1]);
 }
+#elif defined(KECCAK_X8)
+/*
+ * KYBER_K = 3 and 4 on AVX-512: the k^2 entries in row-major order in
+ * batches of eight, and for k = 3 the last entry with a single SHAKE128.
+ */
+void gen_matrix(polyvec *a, const uint8_t seed[32], int transposed)
+{
+  unsigned int i, j, n = 0, ctr;
+  ALIGNED_UINT8(REJ_UNIFORM_AVX_NBLOCKS*SHAKE128_RATE) buf;
+  poly *r[8];
+  const uint8_t *s[8] = {seed, seed, seed, seed, seed, seed, seed, seed};
+  uint16_t xy[8];
+  keccak_state state1x;
+
+  for(i=0;i<KYBER_K;i++) {
+    for(j=0;j<KYBER_K;j++) {
+      r[n] = &a[i].vec[j];
+      xy[n] = transposed ? (j << 8) | i : (i << 8) | j;
+      if(++n == 8) {
+        gen_uniform_8x(r, s, xy);
+        n = 0;
+      }
+    }
+  }
+
+  if(n) {
+    memcpy(buf.coeffs, seed, 32);
+    buf.coeffs[32] = xy[0] & 0xFF;
+    buf.coeffs[33] = xy[0] >> 8;
+    shake128_absorb_once(&state1x, buf.coeffs, 34);
+    shake128_squeezeblocks(buf.coeffs, REJ_UNIFORM_AVX_NBLOCKS, &state1x);
+    ctr = rej_uniform_avx(r[0]->coeffs, buf.coeffs);
+    while(ctr < KYBER_N) {
+      shake128_squeezeblocks(buf.coeffs, 1, &state1x);
+      ctr += rej_uniform(r[0]->coeffs + ctr, KYBER_N - ctr, buf.coeffs, SHAKE128_RATE);
+    }
+    poly_nttunpack(r[0]);
+  }
+}
 #elif KYBER_K == 3
 void gen_matrix(polyvec *a, const uint8_t seed[32], int transposed)
 {
@@ -430,15 +571,28 @@ void indcpa_keypair_derand(uint8_t pk[KYBER_INDCPA_PUBLICKEYBYTES],
   const uint8_t *publicseed = buf;
   const uint8_t *noiseseed = buf + KYBER_SYMBYTES;
   polyvec a[KYBER_K], e, pkpv, skpv;
+  const uint64_t t0 = telemetry_begin();
+  STATS_BEGIN(CDPRE_STATS_KEYPAIR);
 
   memcpy(buf, coins, KYBER_SYMBYTES);
   buf[KYBER_SYMBYTES] = KYBER_K;
   hash_g(buf, buf, KYBER_SYMBYTES+1);
 
   gen_a(a, publicseed);
+  STATS_STAGE(CDPRE_STAGE_GENMATRIX);
 
 #if KYBER_K == 2
   poly_getnoise_eta1_4x(skpv.vec+0, skpv.vec+1, e.vec+0, e.vec+1, noiseseed, 0, 1, 2, 3);
+#elif KYBER_K == 3 && defined(KECCAK_X8)
+  {
+    poly *r[8] = {skpv.vec+0, skpv.vec+1, skpv.vec+2, e.vec+0, e.vec+1, e.vec+2, pkpv.vec+0, pkpv.vec+1};
+    poly_getnoise_eta1_8x(r, noiseseed, nonces_8x);
+  }
+#elif KYBER_K == 4 && defined(KECCAK_X8)
+  {
+    poly *r[8] = {skpv.vec+0, skpv.vec+1, skpv.vec+2, skpv.vec+3, e.vec+0, e.vec+1, e.vec+2, e.vec+3};
+    poly_getnoise_eta1_8x(r, noiseseed, nonces_8x);
+  }
 #elif KYBER_K == 3
   poly_getnoise_eta1_4x(skpv.vec+0, skpv.vec+1, skpv.vec+2, e.vec+0, noiseseed, 0, 1, 2, 3);
   poly_getnoise_eta1_4x(e.vec+1, e.vec+2, pkpv.vec+0, pkpv.vec+1, noiseseed, 4, 5, 6, 7);
@@ -446,22 +600,222 @@ void indcpa_keypair_derand(uint8_t pk[KYBER_INDCPA_PUBLICKEYBYTES],
   poly_getnoise_eta1_4x(skpv.vec+0, skpv.vec+1, skpv.vec+2, skpv.vec+3, noiseseed,  0, 1, 2, 3);
   poly_getnoise_eta1_4x(e.vec+0, e.vec+1, e.vec+2, e.vec+3, noiseseed, 4, 5, 6, 7);
 #endif
+  STATS_STAGE(CDPRE_STAGE_NOISE);
 
   polyvec_ntt(&skpv);
+  STATS_STAGE(CDPRE_STAGE_NTT);
   polyvec_reduce(&skpv);
+  STATS_STAGE(CDPRE_STAGE_REDUCE);
   polyvec_ntt(&e);
+  STATS_STAGE(CDPRE_STAGE_NTT);
 
   // matrix-vector multiplication
   for(i=0;i<KYBER_K;i++) {
     polyvec_basemul_acc_montgomery(&pkpv.vec[i], &a[i], &skpv);
     poly_tomont(&pkpv.vec[i]);
   }
+  STATS_STAGE(CDPRE_STAGE_BASEMUL);
 
   polyvec_add(&pkpv, &pkpv, &e);
   polyvec_reduce(&pkpv);
+  STATS_STAGE(CDPRE_STAGE_REDUCE);
 
   pack_sk(sk, &skpv);
   pack_pk(pk, &pkpv, publicseed);
+  STATS_STAGE(CDPRE_STAGE_PACK);
+  telemetry_end(CDPRE_TELEMETRY_INDCPA_KEYPAIR, t0,
+                KYBER_INDCPA_PUBLICKEYBYTES + KYBER_INDCPA_SECRETKEYBYTES);
+}
+
+#ifdef KECCAK_X8
+#define NOISE_LANES 8
+#else
+#define NOISE_LANES 4
+#endif
+
+/*
+ * Noise polynomials of several keys or messages, each with its own seed,
+ * collected for the multi-way Keccak: noise_add() samples a run as soon as
+ * all lanes are taken, noise_flush() samples the rest, with throwaway
+ * polynomials in the free lanes of a last run of four or eight.
+ */
+typedef struct {
+  poly *r[NOISE_LANES];
+  const uint8_t *seed[NOISE_LANES];
+  uint8_t nonce[NOISE_LANES];
+  unsigned int n;
+  int eta2;
+} noise_queue;
+
+static void noise_run(noise_queue *q, unsigned int lanes)
+{
+#ifdef KECCAK_X8
+  if(lanes == 8) {
+    if(q->eta2)
+      poly_getnoise_eta2_8x_seeds(q->r, q->seed, q->nonce);
+    else
+      poly_getnoise_eta1_8x_seeds(q->r, q->seed, q->nonce);
+    return;
+  }
+#else
+  (void)lanes;
+#endif
+  if(q->eta2)
+    poly_getnoise_eta2_4x_seeds(q->r, q->seed, q->nonce);
+  else
+    poly_getnoise_eta1_4x_seeds(q->r, q->seed, q->nonce);
+}
+
+static void noise_add(noise_queue *q, poly *r, const uint8_t *seed, uint8_t nonce)
+{
+  q->r[q->n] = r;
+  q->seed[q->n] = seed;
+  q->nonce[q->n] = nonce;
+  if(++q->n == NOISE_LANES) {
+    noise_run(q, NOISE_LANES);
+    q->n = 0;
+  }
+}
+
+static void noise_flush(noise_queue *q)
+{
+  unsigned int lanes = (q->n <= 4) ? 4 : 8;
+  poly t;
+
+  if(!q->n)
+    return;
+  for(; q->n < lanes; q->n++) {
+    q->r[q->n] = &t;
+    q->seed[q->n] = q->seed[0];
+    q->nonce[q->n] = 0;
+  }
+  noise_run(q, lanes);
+  q->n = 0;
+}
+
+/*************************************************
+* Name:        gen_matrix_x4
+*
+* Description: Generate the matrices A of four public seeds, as
+*              gen_a(a[l], seed[l]) for l = 0, ..., 3. The 4*k^2 entries
+*              are sampled in runs of keccakx8 (keccakx4 without AVX-512)
+*              with all lanes in use.
+*
+* Arguments:   - polyvec **a: array of four pointers to output matrices
+*              - const uint8_t **seed: array of four pointers to input seeds
+**************************************************/
+static void gen_matrix_x4(polyvec *a[4], const uint8_t *seed[4])
+{
+  unsigned int i, j, l, n = 0;
+  poly *r[8];
+  const uint8_t *s[8];
+  uint16_t xy[8];
+
+  for(l=0;l<4;l++) {
+    for(i=0;i<KYBER_K;i++) {
+      for(j=0;j<KYBER_K;j++) {
+        r[n] = &a[l][i].vec[j];
+        s[n] = seed[l];
+        xy[n] = (i << 8) | j;
+#ifdef KECCAK_X8
+        if(++n == 8) {
+          gen_uniform_8x(r, s, xy);
+          n = 0;
+        }
+#else
+        if(++n == 4) {
+          gen_uniform_4x(r, s, xy);
+          n = 0;
+        }
+#endif
+      }
+    }
+  }
+
+  // 4*k^2 is a multiple of 4, and of 8 unless k = 3
+  if(n)
+    gen_uniform_4x(r, s, xy);
+}
+
+/*************************************************
+* Name:        indcpa_keypair_derand_x4
+*
+* Description: Generates four key pairs at once, with the same output as
+*              indcpa_keypair_derand(pk[l], sk[l], coins[l]) for
+*              l = 0, ..., 3. The hashes of the coins, the matrix entries
+*              and the noise polynomials of all four key pairs are computed
+*              in parallel lanes of the multi-way Keccak, the NTTs of
+*              the four secrets and errors run as one batch, and each row
+*              of the four matrices is multiplied before the next row.
+*              Telemetry and stats count the call as four key pairs.
+*
+* Arguments:   - uint8_t **pk: array of four pointers to output public keys
+*                              (of length KYBER_INDCPA_PUBLICKEYBYTES bytes)
+*              - uint8_t **sk: array of four pointers to output private keys
+*                              (of length KYBER_INDCPA_SECRETKEYBYTES bytes)
+*              - const uint8_t **coins: array of four pointers to input randomness
+*                              (of length KYBER_SYMBYTES bytes)
+**************************************************/
+void indcpa_keypair_derand_x4(uint8_t *pk[4],
+                              uint8_t *sk[4],
+                              const uint8_t *coins[4])
+{
+  unsigned int i, l;
+  uint8_t buf[4][2*KYBER_SYMBYTES];
+  const uint8_t *publicseed[4];
+  polyvec a[4][KYBER_K], e[4], pkpv[4], skpv[4];
+  polyvec *pa[4] = {a[0], a[1], a[2], a[3]};
+  noise_queue q = {.n = 0, .eta2 = 0};
+  const uint64_t t0 = telemetry_begin();
+  STATS_BEGIN_N(CDPRE_STATS_KEYPAIR, 4);
+
+  for(l=0;l<4;l++) {
+    memcpy(buf[l], coins[l], KYBER_SYMBYTES);
+    buf[l][KYBER_SYMBYTES] = KYBER_K;
+  }
+  hash_g_x4(buf[0], buf[1], buf[2], buf[3], buf[0], buf[1], buf[2], buf[3], KYBER_SYMBYTES+1);
+  for(l=0;l<4;l++)
+    publicseed[l] = buf[l];
+
+  gen_matrix_x4(pa, publicseed);
+  STATS_STAGE(CDPRE_STAGE_GENMATRIX);
+
+  // secret i with nonce i and error i with nonce k+i
+  for(l=0;l<4;l++)
+    for(i=0;i<2*KYBER_K;i++)
+      noise_add(&q, (i < KYBER_K) ? &skpv[l].vec[i] : &e[l].vec[i-KYBER_K], buf[l] + KYBER_SYMBYTES, i);
+  noise_flush(&q);
+  STATS_STAGE(CDPRE_STAGE_NOISE);
+
+  poly_ntt_batch(skpv[0].vec, 4*KYBER_K);
+  poly_ntt_batch(e[0].vec, 4*KYBER_K);
+  STATS_STAGE(CDPRE_STAGE_NTT);
+
+  for(l=0;l<4;l++)
+    polyvec_reduce(&skpv[l]);
+  STATS_STAGE(CDPRE_STAGE_REDUCE);
+
+  for(i=0;i<KYBER_K;i++) {
+    for(l=0;l<4;l++) {
+      polyvec_basemul_acc_montgomery(&pkpv[l].vec[i], &a[l][i], &skpv[l]);
+      poly_tomont(&pkpv[l].vec[i]);
+    }
+  }
+  STATS_STAGE(CDPRE_STAGE_BASEMUL);
+
+  for(l=0;l<4;l++) {
+    polyvec_add(&pkpv[l], &pkpv[l], &e[l]);
+    polyvec_reduce(&pkpv[l]);
+  }
+  STATS_STAGE(CDPRE_STAGE_REDUCE);
+
+  for(l=0;l<4;l++) {
+    pack_sk(sk[l], &skpv[l]);
+    pack_pk(pk[l], &pkpv[l], publicseed[l]);
+  }
+  STATS_STAGE(CDPRE_STAGE_PACK);
+  telemetry_end_n(CDPRE_TELEMETRY_INDCPA_KEYPAIR, t0, 4,
+                  KYBER_INDCPA_PUBLICKEYBYTES + KYBER_INDCPA_SECRETKEYBYTES);
 }
 
 /*************************************************
@@ -489,14 +843,29 @@ void indcpa_enc(uint8_t c[KYBER_INDCPA_BYTES],
   uint8_t seed[KYBER_SYMBYTES];
   polyvec sp, pkpv, ep, at[KYBER_K], b;
   poly v, k, epp;
+  const uint64_t t0 = telemetry_begin();
+  STATS_BEGIN(CDPRE_STATS_ENC);
 
   unpack_pk(&pkpv, seed, pk);
   poly_frommsg(&k, m);
+  STATS_STAGE(CDPRE_STAGE_UNPACK);
   gen_at(at, seed);
+  STATS_STAGE(CDPRE_STAGE_GENMATRIX);
 
 #if KYBER_K == 2
   poly_getnoise_eta1122_4x(sp.vec+0, sp.vec+1, ep.vec+0, ep.vec+1, coins, 0, 1, 2, 3);
   poly_getnoise_eta2(&epp, coins, 4);
+#elif KYBER_K == 3 && defined(KECCAK_X8)
+  {
+    poly *r[8] = {sp.vec+0, sp.vec+1, sp.vec+2, ep.vec+0, ep.vec+1, ep.vec+2, &epp, b.vec+0};
+    poly_getnoise_eta1_8x(r, coins, nonces_8x);
+  }
+#elif KYBER_K == 4 && defined(KECCAK_X8)
+  {
+    poly *r[8] = {sp.vec+0, sp.vec+1, sp.vec+2, sp.vec+3, ep.vec+0, ep.vec+1, ep.vec+2, ep.vec+3};
+    poly_getnoise_eta1_8x(r, coins, nonces_8x);
+  }
+  poly_getnoise_eta2(&epp, coins, 8);
 #elif KYBER_K == 3
   poly_getnoise_eta1_4x(sp.vec+0, sp.vec+1, sp.vec+2, ep.vec+0, coins, 0, 1, 2 ,3);
   poly_getnoise_eta1_4x(ep.vec+1, ep.vec+2, &epp, b.vec+0, coins,  4, 5, 6, 7);
@@ -505,24 +874,131 @@ void indcpa_enc(uint8_t c[KYBER_INDCPA_BYTES],
   poly_getnoise_eta1_4x(ep.vec+0, ep.vec+1, ep.vec+2, ep.vec+3, coins, 4, 5, 6, 7);
   poly_getnoise_eta2(&epp, coins, 8);
 #endif
+  STATS_STAGE(CDPRE_STAGE_NOISE);
 
   polyvec_ntt(&sp);
+  STATS_STAGE(CDPRE_STAGE_NTT);
 
   // matrix-vector multiplication
   for(i=0;i<KYBER_K;i++)
     polyvec_basemul_acc_montgomery(&b.vec[i], &at[i], &sp);
   polyvec_basemul_acc_montgomery(&v, &pkpv, &sp);
+  STATS_STAGE(CDPRE_STAGE_BASEMUL);
 
   polyvec_invntt_tomont(&b);
   poly_invntt_tomont(&v);
+  STATS_STAGE(CDPRE_STAGE_INVNTT);
 
   polyvec_add(&b, &b, &ep);
   poly_add(&v, &v, &epp);
   poly_add(&v, &v, &k);
   polyvec_reduce(&b);
   poly_reduce(&v);
+  STATS_STAGE(CDPRE_STAGE_REDUCE);
 
   pack_ciphertext(c, &b, &v);
+  STATS_STAGE(CDPRE_STAGE_PACK);
+  telemetry_end(CDPRE_TELEMETRY_INDCPA_ENC, t0, KYBER_INDCPA_BYTES);
+}
+
+/*************************************************
+* Name:        indcpa_enc_batch
+*
+* Description: Encrypts n messages under the same public key, with the same
+*              output as indcpa_enc(c[j], m[j], pk, coins[j]) for
+*              j = 0, ..., n-1. The public key is unpacked and A^T expanded
+*              once. The messages are processed four at a time: their noise
+*              fills all lanes of the multi-way Keccak, the NTTs of their
+*              secrets run as one batch, and each row of A^T is multiplied
+*              with the secrets of all four before the next. Telemetry
+*              records the whole batch as one encryption of
+*              n*KYBER_INDCPA_BYTES bytes.
+*
+* Arguments:   - uint8_t *c: pointer to n output ciphertexts
+*                            (of length n*KYBER_INDCPA_BYTES bytes)
+*              - const uint8_t *m: pointer to n input messages
+*                                  (of length n*KYBER_INDCPA_MSGBYTES bytes)
+*              - size_t n: number of messages
+*              - const uint8_t *pk: pointer to input public key
+*                                   (of length KYBER_INDCPA_PUBLICKEYBYTES)
+*              - const uint8_t *coins: pointer to n random coins
+*                                      (of length n*KYBER_SYMBYTES bytes)
+**************************************************/
+void indcpa_enc_batch(uint8_t *c,
+                      const uint8_t *m,
+                      size_t n,
+                      const uint8_t pk[KYBER_INDCPA_PUBLICKEYBYTES],
+                      const uint8_t *coins)
+{
+  unsigned int i, j, nb;
+  uint8_t seed[KYBER_SYMBYTES];
+  polyvec pkpv, at[KYBER_K], sp[4], ep[4], b[4];
+  poly v[4], epp[4], k;
+  noise_queue q1 = {.n = 0, .eta2 = 0};
+  noise_queue q2 = {.n = 0, .eta2 = 1};
+#if KYBER_ETA1 == KYBER_ETA2
+  noise_queue *qe = &q1;
+#else
+  noise_queue *qe = &q2;
+#endif
+  const uint64_t t0 = telemetry_begin();
+  const size_t bytes = n*KYBER_INDCPA_BYTES;
+  STATS_BEGIN(CDPRE_STATS_ENC);
+
+  unpack_pk(&pkpv, seed, pk);
+  STATS_STAGE(CDPRE_STAGE_UNPACK);
+  gen_at(at, seed);
+  STATS_STAGE(CDPRE_STAGE_GENMATRIX);
+
+  for(; n > 0; n -= nb) {
+    nb = (n < 4) ? n : 4;
+
+    for(j=0;j<nb;j++) {
+      for(i=0;i<KYBER_K;i++)
+        noise_add(&q1, &sp[j].vec[i], coins + j*KYBER_SYMBYTES, i);
+      for(i=0;i<KYBER_K;i++)
+        noise_add(qe, &ep[j].vec[i], coins + j*KYBER_SYMBYTES, KYBER_K+i);
+      noise_add(qe, &epp[j], coins + j*KYBER_SYMBYTES, 2*KYBER_K);
+    }
+    noise_flush(&q1);
+    noise_flush(&q2);
+    STATS_STAGE(CDPRE_STAGE_NOISE);
+
+    poly_ntt_batch(sp[0].vec, nb*KYBER_K);
+    STATS_STAGE(CDPRE_STAGE_NTT);
+
+    for(i=0;i<KYBER_K;i++)
+      for(j=0;j<nb;j++)
+        polyvec_basemul_acc_montgomery(&b[j].vec[i], &at[i], &sp[j]);
+    for(j=0;j<nb;j++)
+      polyvec_basemul_acc_montgomery(&v[j], &pkpv, &sp[j]);
+    STATS_STAGE(CDPRE_STAGE_BASEMUL);
+
+    for(j=0;j<nb;j++) {
+      polyvec_invntt_tomont(&b[j]);
+      poly_invntt_tomont(&v[j]);
+    }
+    STATS_STAGE(CDPRE_STAGE_INVNTT);
+
+    for(j=0;j<nb;j++) {
+      poly_frommsg(&k, m + j*KYBER_INDCPA_MSGBYTES);
+      polyvec_add(&b[j], &b[j], &ep[j]);
+      poly_add(&v[j], &v[j], &epp[j]);
+      poly_add(&v[j], &v[j], &k);
+      polyvec_reduce(&b[j]);
+      poly_reduce(&v[j]);
+    }
+    STATS_STAGE(CDPRE_STAGE_REDUCE);
+
+    for(j=0;j<nb;j++)
+      pack_ciphertext(c + j*KYBER_INDCPA_BYTES, &b[j], &v[j]);
+    STATS_STAGE(CDPRE_STAGE_PACK);
+
+    c += nb*KYBER_INDCPA_BYTES;
+    m += nb*KYBER_INDCPA_MSGBYTES;
+    coins += nb*KYBER_SYMBYTES;
+  }
+  telemetry_end(CDPRE_TELEMETRY_INDCPA_ENC, t0, bytes);
 }
 
 /*************************************************
@@ -544,16 +1020,130 @@ void indcpa_dec(uint8_t m[KYBER_INDCPA_MSGBYTES],
 {
   polyvec b, skpv;
   poly v, mp;
+  const uint64_t t0 = telemetry_begin();
+  STATS_BEGIN(CDPRE_STATS_DEC);
 
   unpack_ciphertext(&b, &v, c);
   unpack_sk(&skpv, sk);
+  STATS_STAGE(CDPRE_STAGE_UNPACK);
 
   polyvec_ntt(&b);
+  STATS_STAGE(CDPRE_STAGE_NTT);
   polyvec_basemul_acc_montgomery(&mp, &skpv, &b);
+  STATS_STAGE(CDPRE_STAGE_BASEMUL);
   poly_invntt_tomont(&mp);
+  STATS_STAGE(CDPRE_STAGE_INVNTT);
 
   poly_sub(&mp, &v, &mp);
   poly_reduce(&mp);
+  STATS_STAGE(CDPRE_STAGE_REDUCE);
 
   poly_tomsg(m, &mp);
+  STATS_STAGE(CDPRE_STAGE_PACK);
+  telemetry_end(CDPRE_TELEMETRY_INDCPA_DEC, t0, KYBER_INDCPA_MSGBYTES);
+}
+
+// indcpa_dec_batch, recording noise margins if margins is set and
+// telemetry is on
+static void dec_batch(uint8_t *m,
+                      const uint8_t *c,
+                      size_t n,
+                      const uint8_t sk[KYBER_INDCPA_SECRETKEYBYTES],
+                      int margins)
+{
+  unsigned int j, nb;
+  polyvec b[4], skpv;
+  poly v[4], mp[4];
+  const uint64_t t0 = telemetry_begin();
+  const size_t bytes = n*KYBER_INDCPA_MSGBYTES;
+  STATS_BEGIN(CDPRE_STATS_DEC);
+
+  unpack_sk(&skpv, sk);
+
+  for(; n > 0; n -= nb) {
+    nb = (n < 4) ? n : 4;
+
+    for(j=0;j<nb;j++)
+      unpack_ciphertext(&b[j], &v[j], c + j*KYBER_INDCPA_BYTES);
+    STATS_STAGE(CDPRE_STAGE_UNPACK);
+    poly_ntt_batch(b[0].vec, nb*KYBER_K);
+    STATS_STAGE(CDPRE_STAGE_NTT);
+
+    for(j=0;j<nb;j++)
+      polyvec_basemul_acc_montgomery(&mp[j], &skpv, &b[j]);
+    STATS_STAGE(CDPRE_STAGE_BASEMUL);
+    for(j=0;j<nb;j++)
+      poly_invntt_tomont(&mp[j]);
+    STATS_STAGE(CDPRE_STAGE_INVNTT);
+
+    for(j=0;j<nb;j++) {
+      poly_sub(&mp[j], &v[j], &mp[j]);
+      poly_reduce(&mp[j]);
+    }
+    STATS_STAGE(CDPRE_STAGE_REDUCE);
+
+    for(j=0;j<nb;j++) {
+      if(margins && t0)
+        telemetry_record_margin(poly_tomsg_margin(m + j*KYBER_INDCPA_MSGBYTES, &mp[j]));
+      else
+        poly_tomsg(m + j*KYBER_INDCPA_MSGBYTES, &mp[j]);
+    }
+    STATS_STAGE(CDPRE_STAGE_PACK);
+
+    m += nb*KYBER_INDCPA_MSGBYTES;
+    c += nb*KYBER_INDCPA_BYTES;
+  }
+  telemetry_end(CDPRE_TELEMETRY_INDCPA_DEC, t0, bytes);
+}
+
+/*************************************************
+* Name:        indcpa_dec_batch
+*
+* Description: Decrypts n ciphertexts under the same secret key, with the
+*              same output as indcpa_dec(m[j], c[j], sk) for
+*              j = 0, ..., n-1. The secret key is unpacked once, and the
+*              NTTs of four ciphertexts at a time run as one batch.
+*              Telemetry records the whole batch as one decryption of
+*              n*KYBER_INDCPA_MSGBYTES bytes.
+*
+* Arguments:   - uint8_t *m: pointer to n output messages
+*                            (of length n*KYBER_INDCPA_MSGBYTES bytes)
+*              - const uint8_t *c: pointer to n input ciphertexts
+*                                  (of length n*KYBER_INDCPA_BYTES bytes)
+*              - size_t n: number of ciphertexts
+*              - const uint8_t *sk: pointer to input secret key
+*                                   (of length KYBER_INDCPA_SECRETKEYBYTES)
+**************************************************/
+void indcpa_dec_batch(uint8_t *m,
+                      const uint8_t *c,
+                      size_t n,
+                      const uint8_t sk[KYBER_INDCPA_SECRETKEYBYTES])
+{
+  dec_batch(m, c, n, sk, 0);
+}
+
+/*************************************************
+* Name:        indcpa_dec_batch_margin
+*
+* Description: indcpa_dec_batch that also records the noise margin of every
+*              ciphertext in telemetry while it is enabled (see
+*              poly_tomsg_margin). Meant for re-encrypted PRE ciphertexts
+*              only: on ciphertexts chosen by an attacker, the exported
+*              margins leak information on the secret key, so the KEM
+*              decapsulation must use indcpa_dec.
+*
+* Arguments:   - uint8_t *m: pointer to n output messages
+*                            (of length n*KYBER_INDCPA_MSGBYTES bytes)
+*              - const uint8_t *c: pointer to n input ciphertexts
+*                                  (of length n*KYBER_INDCPA_BYTES bytes)
+*              - size_t n: number of ciphertexts
+*              - const uint8_t *sk: pointer to input secret key
+*                                   (of length KYBER_INDCPA_SECRETKEYBYTES)
+**************************************************/
+void indcpa_dec_batch_margin(uint8_t *m,
+                             const uint8_t *c,
+                             size_t n,
+                             const uint8_t sk[KYBER_INDCPA_SECRETKEYBYTES])
+{
+  dec_batch(m, c, n, sk, 1);
 }
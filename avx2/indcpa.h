@@ -1 +0,0 @@
-../ref/indcpa.h
\ No newline at end of file
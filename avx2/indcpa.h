@@ -0,0 +1,52 @@
+#ifndef INDCPA_H
+#define INDCPA_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "params.h"
+#include "polyvec.h"
+
+#define gen_matrix KYBER_NAMESPACE(gen_matrix)
+void gen_matrix(polyvec *a, const uint8_t seed[KYBER_SYMBYTES], int transposed);
+
+#define indcpa_keypair_derand KYBER_NAMESPACE(indcpa_keypair_derand)
+void indcpa_keypair_derand(uint8_t pk[KYBER_INDCPA_PUBLICKEYBYTES],
+                           uint8_t sk[KYBER_INDCPA_SECRETKEYBYTES],
+                           const uint8_t coins[KYBER_SYMBYTES]);
+
+#define indcpa_keypair_derand_x4 KYBER_NAMESPACE(indcpa_keypair_derand_x4)
+void indcpa_keypair_derand_x4(uint8_t *pk[4],
+                              uint8_t *sk[4],
+                              const uint8_t *coins[4]);
+
+#define indcpa_enc KYBER_NAMESPACE(indcpa_enc)
+void indcpa_enc(uint8_t c[KYBER_INDCPA_BYTES],
+                const uint8_t m[KYBER_INDCPA_MSGBYTES],
+                const uint8_t pk[KYBER_INDCPA_PUBLICKEYBYTES],
+                const uint8_t coins[KYBER_SYMBYTES]);
+
+#define indcpa_enc_batch KYBER_NAMESPACE(indcpa_enc_batch)
+void indcpa_enc_batch(uint8_t *c,
+                      const uint8_t *m,
+                      size_t n,
+                      const uint8_t pk[KYBER_INDCPA_PUBLICKEYBYTES],
+                      const uint8_t *coins);
+
+#define indcpa_dec KYBER_NAMESPACE(indcpa_dec)
+void indcpa_dec(uint8_t m[KYBER_INDCPA_MSGBYTES],
+                const uint8_t c[KYBER_INDCPA_BYTES],
+                const uint8_t sk[KYBER_INDCPA_SECRETKEYBYTES]);
+
+#define indcpa_dec_batch KYBER_NAMESPACE(indcpa_dec_batch)
+void indcpa_dec_batch(uint8_t *m,
+                      const uint8_t *c,
+                      size_t n,
+                      const uint8_t sk[KYBER_INDCPA_SECRETKEYBYTES]);
+
+#define indcpa_dec_batch_margin KYBER_NAMESPACE(indcpa_dec_batch_margin)
+void indcpa_dec_batch_margin(uint8_t *m,
+                             const uint8_t *c,
+                             size_t n,
+                             const uint8_t sk[KYBER_INDCPA_SECRETKEYBYTES]);
+
+#endif
@@ -0,0 +1,359 @@
+#include <fcntl.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "fips202.h"
+#include "kdfchain.h"
+#include "verify.h"
+
+#define MAGIC "KDFC"
+#define VERSION 1
+#define HEADERBYTES 24
+#define TAGBYTES 32
+
+static void store64(uint8_t x[8], uint64_t u)
+{
+  unsigned int i;
+
+  for(i=0;i<8;i++)
+    x[i] = u >> 8*i;
+}
+
+static uint64_t load64(const uint8_t x[8])
+{
+  unsigned int i;
+  uint64_t r = 0;
+
+  for(i=0;i<8;i++)
+    r |= (uint64_t)x[i] << 8*i;
+  return r;
+}
+
+// ceil(sqrt(nepochs)), the distance of the checkpoints
+static uint64_t chain_interval(uint64_t nepochs)
+{
+  uint64_t s;
+
+  for(s=1;s*s<nepochs;s++);
+  return s;
+}
+
+static uint64_t ncheckpoints(const struct kdf_chain *c)
+{
+  return (c->nepochs - 1)/c->interval + 1;
+}
+
+/*************************************************
+* Name:        kdf_chain_step
+*
+* Description: One step of the KDF chain: derive the symmetric key of an
+*              epoch and the derivation key of the next epoch
+*
+* Arguments:   - uint8_t *sek: pointer to output symmetric key of the epoch
+*                              (of length KDF_CHAIN_KEYBYTES)
+*              - uint8_t *dk_next: pointer to output derivation key of the
+*                                  next epoch (of length KDF_CHAIN_KEYBYTES),
+*                                  may be equal to dk
+*              - const uint8_t *dk: pointer to input derivation key of the
+*                                   epoch (of length KDF_CHAIN_KEYBYTES)
+*              - uint64_t epoch: epoch number
+**************************************************/
+void kdf_chain_step(uint8_t sek[KDF_CHAIN_KEYBYTES],
+                    uint8_t dk_next[KDF_CHAIN_KEYBYTES],
+                    const uint8_t dk[KDF_CHAIN_KEYBYTES],
+                    uint64_t epoch)
+{
+  uint8_t buf[9+KDF_CHAIN_KEYBYTES];
+  uint8_t out[2*KDF_CHAIN_KEYBYTES];
+
+  buf[0] = KDF_CHAIN_DOMAIN;
+  store64(buf+1, epoch);
+  memcpy(buf+9, dk, KDF_CHAIN_KEYBYTES);
+  shake256(out, sizeof(out), buf, sizeof(buf));
+  memcpy(sek, out, KDF_CHAIN_KEYBYTES);
+  memcpy(dk_next, out+KDF_CHAIN_KEYBYTES, KDF_CHAIN_KEYBYTES);
+  wipe(buf, sizeof(buf));
+  wipe(out, sizeof(out));
+}
+
+/*************************************************
+* Name:        kdf_chain_init
+*
+* Description: Walk a chain of nepochs epochs from its root once and keep
+*              every ceil(sqrt(nepochs))-th derivation key as a checkpoint
+*
+* Arguments:   - struct kdf_chain *c: pointer to output chain, to be freed
+*                                    with kdf_chain_free
+*              - const uint8_t *root: pointer to input derivation key of
+*                                     epoch 0 (of length KDF_CHAIN_KEYBYTES)
+*              - uint64_t nepochs: number of epochs, at least 1
+*
+* Returns 0 on success, -1 if nepochs is 0 or out of memory
+**************************************************/
+int kdf_chain_init(struct kdf_chain *c, const uint8_t root[KDF_CHAIN_KEYBYTES], uint64_t nepochs)
+{
+  uint64_t e, s;
+  uint8_t sek[KDF_CHAIN_KEYBYTES], dk[KDF_CHAIN_KEYBYTES];
+
+  c->checkpoints = NULL;
+  if(nepochs == 0 || nepochs > (UINT64_C(1) << 48))
+    return -1;
+
+  s = chain_interval(nepochs);
+  c->nepochs = nepochs;
+  c->interval = s;
+  c->checkpoints = malloc(ncheckpoints(c)*KDF_CHAIN_KEYBYTES);
+  if(!c->checkpoints)
+    return -1;
+
+  memcpy(dk, root, KDF_CHAIN_KEYBYTES);
+  for(e=0;e<nepochs;e++) {
+    if(e % s == 0)
+      memcpy(c->checkpoints[e/s], dk, KDF_CHAIN_KEYBYTES);
+    kdf_chain_step(sek, dk, dk, e);
+  }
+
+  wipe(sek, sizeof(sek));
+  wipe(dk, sizeof(dk));
+  return 0;
+}
+
+/*************************************************
+* Name:        kdf_chain_free
+*
+* Description: Erase and free the checkpoints of a chain
+*
+* Arguments:   - struct kdf_chain *c: pointer to chain
+**************************************************/
+void kdf_chain_free(struct kdf_chain *c)
+{
+  if(c->checkpoints) {
+    wipe(c->checkpoints, ncheckpoints(c)*KDF_CHAIN_KEYBYTES);
+    free(c->checkpoints);
+    c->checkpoints = NULL;
+  }
+}
+
+/*************************************************
+* Name:        kdf_chain_key
+*
+* Description: Derive the keys of an epoch from the nearest checkpoint
+*              before it, in at most c->interval steps
+*
+* Arguments:   - uint8_t *sek: pointer to output symmetric key of the epoch
+*                              (of length KDF_CHAIN_KEYBYTES), may be NULL
+*              - uint8_t *dk: pointer to output derivation key of the epoch
+*                             (of length KDF_CHAIN_KEYBYTES), which gives
+*                             access to this and all later epochs; may be NULL
+*              - const struct kdf_chain *c: pointer to input chain
+*              - uint64_t epoch: epoch number
+*
+* Returns 0 on success, -1 if the epoch is not in the chain
+**************************************************/
+int kdf_chain_key(uint8_t sek[KDF_CHAIN_KEYBYTES],
+                  uint8_t dk[KDF_CHAIN_KEYBYTES],
+                  const struct kdf_chain *c,
+                  uint64_t epoch)
+{
+  struct kdf_chain_iter it;
+
+  if(kdf_chain_iter_seek(&it, c, epoch))
+    return -1;
+  if(dk)
+    memcpy(dk, it.dk, KDF_CHAIN_KEYBYTES);
+  if(sek)
+    kdf_chain_next(sek, &it);
+  wipe(&it, sizeof(it));
+  return 0;
+}
+
+// SHAKE256 of the header and checkpoints, against corrupted files
+static void tag(uint8_t t[TAGBYTES], const uint8_t header[HEADERBYTES], const struct kdf_chain *c)
+{
+  keccak_state state;
+
+  shake256_init(&state);
+  shake256_absorb(&state, header, HEADERBYTES);
+  shake256_absorb(&state, c->checkpoints[0], ncheckpoints(c)*KDF_CHAIN_KEYBYTES);
+  shake256_finalize(&state);
+  shake256_squeeze(t, TAGBYTES, &state);
+}
+
+static void pack_header(uint8_t header[HEADERBYTES], const struct kdf_chain *c)
+{
+  memcpy(header, MAGIC, 4);
+  header[4] = VERSION;
+  header[5] = header[6] = header[7] = 0;
+  store64(header+8, c->nepochs);
+  store64(header+16, c->interval);
+}
+
+/*************************************************
+* Name:        kdf_chain_save
+*
+* Description: Write the checkpoints of a chain to a file: the magic
+*              "KDFC", a version byte and three zero bytes, nepochs and
+*              interval as 64-bit little-endian integers, the checkpoints,
+*              and 32 bytes of SHAKE256 of all of these
+*
+* Arguments:   - const struct kdf_chain *c: pointer to input chain
+*              - const char *path: name of the file, which is replaced;
+*                                  its mode is set to 0600 before any key
+*                                  is written
+*
+* Returns 0 on success, -1 on I/O errors
+**************************************************/
+int kdf_chain_save(const struct kdf_chain *c, const char *path)
+{
+  int fd, r;
+  FILE *f;
+  uint8_t header[HEADERBYTES], t[TAGBYTES];
+
+  pack_header(header, c);
+  tag(t, header, c);
+
+  // the checkpoints are as secret as the root: readable by the owner only,
+  // also if the file already existed with a wider mode
+  fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0600);
+  if(fd < 0)
+    return -1;
+  if(fchmod(fd, 0600)) {
+    close(fd);
+    return -1;
+  }
+  f = fdopen(fd, "wb");
+  if(!f) {
+    close(fd);
+    return -1;
+  }
+  r = fwrite(header, 1, HEADERBYTES, f) == HEADERBYTES
+      && fwrite(c->checkpoints, KDF_CHAIN_KEYBYTES, ncheckpoints(c), f) == ncheckpoints(c)
+      && fwrite(t, 1, TAGBYTES, f) == TAGBYTES;
+  if(fclose(f) || !r)
+    return -1;
+  return 0;
+}
+
+/*************************************************
+* Name:        kdf_chain_load
+*
+* Description: Read the checkpoints of a chain written by kdf_chain_save.
+*              The interval must be the one kdf_chain_init chooses, and the
+*              length of the file must match the header before any memory
+*              is allocated for the checkpoints.
+*
+* Arguments:   - struct kdf_chain *c: pointer to output chain, to be freed
+*                                    with kdf_chain_free
+*              - const char *path: name of the file
+*
+* Returns 0 on success, -1 on I/O errors, out of memory or if the file is
+* malformed or corrupted
+**************************************************/
+int kdf_chain_load(struct kdf_chain *c, const char *path)
+{
+  int r = -1;
+  long len;
+  FILE *f;
+  uint8_t header[HEADERBYTES], t[TAGBYTES], t1[TAGBYTES];
+
+  c->checkpoints = NULL;
+  f = fopen(path, "rb");
+  if(!f)
+    return -1;
+
+  if(fread(header, 1, HEADERBYTES, f) != HEADERBYTES || memcmp(header, MAGIC, 4)
+     || header[4] != VERSION || header[5] || header[6] || header[7])
+    goto out;
+  c->nepochs = load64(header+8);
+  c->interval = load64(header+16);
+  if(c->nepochs == 0 || c->nepochs > (UINT64_C(1) << 48)
+     || c->interval != chain_interval(c->nepochs))
+    goto out;
+  if(fseek(f, 0, SEEK_END) || (len = ftell(f)) < 0
+     || (uint64_t)len != HEADERBYTES + ncheckpoints(c)*KDF_CHAIN_KEYBYTES + TAGBYTES
+     || fseek(f, HEADERBYTES, SEEK_SET))
+    goto out;
+
+  c->checkpoints = malloc(ncheckpoints(c)*KDF_CHAIN_KEYBYTES);
+  if(!c->checkpoints)
+    goto out;
+  if(fread(c->checkpoints, KDF_CHAIN_KEYBYTES, ncheckpoints(c), f) != ncheckpoints(c)
+     || fread(t, 1, TAGBYTES, f) != TAGBYTES || fgetc(f) != EOF)
+    goto out;
+  tag(t1, header, c);
+  if(memcmp(t, t1, TAGBYTES))
+    goto out;
+  r = 0;
+
+out:
+  fclose(f);
+  if(r)
+    kdf_chain_free(c);
+  return r;
+}
+
+/*************************************************
+* Name:        kdf_chain_iter_init
+*
+* Description: Start an iterator over the epochs from a given one, for
+*              whoever holds the derivation key of that epoch
+*
+* Arguments:   - struct kdf_chain_iter *it: pointer to output iterator
+*              - const uint8_t *dk: pointer to input derivation key of the
+*                                   epoch (of length KDF_CHAIN_KEYBYTES)
+*              - uint64_t epoch: epoch number
+**************************************************/
+void kdf_chain_iter_init(struct kdf_chain_iter *it, const uint8_t dk[KDF_CHAIN_KEYBYTES], uint64_t epoch)
+{
+  it->epoch = epoch;
+  memcpy(it->dk, dk, KDF_CHAIN_KEYBYTES);
+}
+
+/*************************************************
+* Name:        kdf_chain_iter_seek
+*
+* Description: Start an iterator over the epochs of a chain from a given
+*              one, in at most c->interval steps
+*
+* Arguments:   - struct kdf_chain_iter *it: pointer to output iterator
+*              - const struct kdf_chain *c: pointer to input chain
+*              - uint64_t epoch: epoch number
+*
+* Returns 0 on success, -1 if the epoch is not in the chain
+**************************************************/
+int kdf_chain_iter_seek(struct kdf_chain_iter *it, const struct kdf_chain *c, uint64_t epoch)
+{
+  uint8_t sek[KDF_CHAIN_KEYBYTES];
+
+  if(epoch >= c->nepochs)
+    return -1;
+
+  kdf_chain_iter_init(it, c->checkpoints[epoch/c->interval], epoch - epoch % c->interval);
+  while(it->epoch < epoch)
+    kdf_chain_next(sek, it);
+  wipe(sek, sizeof(sek));
+  return 0;
+}
+
+/*************************************************
+* Name:        kdf_chain_next
+*
+* Description: Derive the symmetric key of the current epoch of an
+*              iterator and advance it to the next epoch, erasing the
+*              derivation key of the current one
+*
+* Arguments:   - uint8_t *sek: pointer to output symmetric key
+*                              (of length KDF_CHAIN_KEYBYTES)
+*              - struct kdf_chain_iter *it: pointer to iterator
+*
+* Returns the epoch of sek
+**************************************************/
+uint64_t kdf_chain_next(uint8_t sek[KDF_CHAIN_KEYBYTES], struct kdf_chain_iter *it)
+{
+  kdf_chain_step(sek, it->dk, it->dk, it->epoch);
+  return it->epoch++;
+}
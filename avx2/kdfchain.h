@@ -0,0 +1,55 @@
+#ifndef KDFCHAIN_H
+#define KDFCHAIN_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * KDF chain of epoch keys: from the derivation key dk_e of epoch e,
+ *
+ *   sek_e || dk_{e+1} = SHAKE256(KDF_CHAIN_DOMAIN || le64(e) || dk_e)
+ *
+ * gives the symmetric key sek_e of epoch e and the derivation key of the
+ * next epoch, starting from the root dk_0. Whoever holds dk_e can derive
+ * the keys of epoch e and all later epochs, but not of earlier ones.
+ *
+ * The data owner keeps a table of checkpoints dk_0, dk_s, dk_2s, ... with
+ * s = ceil(sqrt(n)) for a chain of n epochs, so that the keys of any epoch
+ * are derived in at most s steps instead of e. The table can be stored in
+ * a file of 56 + 16*ceil(n/s) bytes; it is as secret as the root.
+ */
+
+#define KDF_CHAIN_KEYBYTES 16
+#define KDF_CHAIN_DOMAIN 0x01
+
+struct kdf_chain {
+  uint64_t nepochs;
+  uint64_t interval;
+  uint8_t (*checkpoints)[KDF_CHAIN_KEYBYTES];
+};
+
+struct kdf_chain_iter {
+  uint64_t epoch;
+  uint8_t dk[KDF_CHAIN_KEYBYTES];
+};
+
+void kdf_chain_step(uint8_t sek[KDF_CHAIN_KEYBYTES],
+                    uint8_t dk_next[KDF_CHAIN_KEYBYTES],
+                    const uint8_t dk[KDF_CHAIN_KEYBYTES],
+                    uint64_t epoch);
+
+int kdf_chain_init(struct kdf_chain *c, const uint8_t root[KDF_CHAIN_KEYBYTES], uint64_t nepochs);
+void kdf_chain_free(struct kdf_chain *c);
+int kdf_chain_key(uint8_t sek[KDF_CHAIN_KEYBYTES],
+                  uint8_t dk[KDF_CHAIN_KEYBYTES],
+                  const struct kdf_chain *c,
+                  uint64_t epoch);
+
+int kdf_chain_save(const struct kdf_chain *c, const char *path);
+int kdf_chain_load(struct kdf_chain *c, const char *path);
+
+void kdf_chain_iter_init(struct kdf_chain_iter *it, const uint8_t dk[KDF_CHAIN_KEYBYTES], uint64_t epoch);
+int kdf_chain_iter_seek(struct kdf_chain_iter *it, const struct kdf_chain *c, uint64_t epoch);
+uint64_t kdf_chain_next(uint8_t sek[KDF_CHAIN_KEYBYTES], struct kdf_chain_iter *it);
+
+#endif
@@ -0,0 +1,471 @@
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "fips202.h"
+#include "fips202x4.h"
+#include "fips202x8.h"
+#include "kdftree.h"
+#include "verify.h"
+
+#ifdef KECCAK_X8
+#define LANES 8
+#else
+#define LANES 4
+#endif
+
+// input of the hash of a node: domain, depth, le64(index), key
+static void node_input(uint8_t buf[10+KDF_TREE_KEYBYTES],
+                       const uint8_t key[KDF_TREE_KEYBYTES],
+                       unsigned int depth,
+                       uint64_t index)
+{
+  unsigned int i;
+
+  buf[0] = KDF_TREE_DOMAIN;
+  buf[1] = depth;
+  for(i=0;i<8;i++)
+    buf[2+i] = index >> 8*i;
+  memcpy(buf+10, key, KDF_TREE_KEYBYTES);
+}
+
+/*************************************************
+* Name:        kdf_tree_children
+*
+* Description: Derive the keys of the two children of a node
+*
+* Arguments:   - uint8_t *left: pointer to output key of the left child
+*                               (of length KDF_TREE_KEYBYTES)
+*              - uint8_t *right: pointer to output key of the right child
+*                                (of length KDF_TREE_KEYBYTES)
+*              - const uint8_t *key: pointer to input key of the node
+*                                    (of length KDF_TREE_KEYBYTES),
+*                                    may be equal to left or right
+*              - unsigned int depth: depth of the node
+*              - uint64_t index: index of the node at its depth
+**************************************************/
+void kdf_tree_children(uint8_t left[KDF_TREE_KEYBYTES],
+                       uint8_t right[KDF_TREE_KEYBYTES],
+                       const uint8_t key[KDF_TREE_KEYBYTES],
+                       unsigned int depth,
+                       uint64_t index)
+{
+  uint8_t buf[10+KDF_TREE_KEYBYTES];
+  uint8_t out[2*KDF_TREE_KEYBYTES];
+
+  node_input(buf, key, depth, index);
+  shake256(out, sizeof(out), buf, sizeof(buf));
+  memcpy(left, out, KDF_TREE_KEYBYTES);
+  memcpy(right, out+KDF_TREE_KEYBYTES, KDF_TREE_KEYBYTES);
+  wipe(buf, sizeof(buf));
+  wipe(out, sizeof(out));
+}
+
+/*************************************************
+* Name:        kdf_tree_derive
+*
+* Description: Derive the key of a node from the key of one of its
+*              ancestors (or of the node itself), in one hash per level
+*
+* Arguments:   - uint8_t *out: pointer to output key
+*                              (of length KDF_TREE_KEYBYTES)
+*              - const uint8_t *key: pointer to input key of from
+*                                    (of length KDF_TREE_KEYBYTES)
+*              - struct kdf_tree_node from: ancestor
+*              - struct kdf_tree_node to: node
+*
+* Returns 0 on success, -1 if from is not an ancestor of to
+**************************************************/
+int kdf_tree_derive(uint8_t out[KDF_TREE_KEYBYTES],
+                    const uint8_t key[KDF_TREE_KEYBYTES],
+                    struct kdf_tree_node from,
+                    struct kdf_tree_node to)
+{
+  unsigned int j;
+  uint64_t i;
+  uint8_t sibling[KDF_TREE_KEYBYTES];
+
+  if(to.depth > KDF_TREE_MAXDEPTH || to.depth < from.depth
+     || (to.index >> (to.depth - from.depth)) != from.index)
+    return -1;
+
+  memcpy(out, key, KDF_TREE_KEYBYTES);
+  for(j=from.depth;j<to.depth;j++) {
+    i = to.index >> (to.depth - j - 1);
+    if(i & 1)
+      kdf_tree_children(sibling, out, out, j, i >> 1);
+    else
+      kdf_tree_children(out, sibling, out, j, i >> 1);
+  }
+  wipe(sibling, sizeof(sibling));
+  return 0;
+}
+
+/*************************************************
+* Name:        kdf_tree_init
+*
+* Description: Set up the tree of nepochs epochs; only the root is kept
+*
+* Arguments:   - struct kdf_tree *t: pointer to output tree
+*              - const uint8_t *root: pointer to input root key
+*                                     (of length KDF_TREE_KEYBYTES)
+*              - uint64_t nepochs: number of epochs,
+*                                  1 <= nepochs <= 2^KDF_TREE_MAXDEPTH
+*
+* Returns 0 on success, -1 if nepochs is out of range
+**************************************************/
+int kdf_tree_init(struct kdf_tree *t, const uint8_t root[KDF_TREE_KEYBYTES], uint64_t nepochs)
+{
+  if(nepochs == 0 || nepochs > (UINT64_C(1) << KDF_TREE_MAXDEPTH))
+    return -1;
+
+  t->nepochs = nepochs;
+  for(t->depth=0;(UINT64_C(1) << t->depth) < nepochs;t->depth++);
+  memcpy(t->root, root, KDF_TREE_KEYBYTES);
+  return 0;
+}
+
+/*************************************************
+* Name:        kdf_tree_node_key
+*
+* Description: Derive the key of a node from the root
+*
+* Arguments:   - uint8_t *key: pointer to output key
+*                              (of length KDF_TREE_KEYBYTES)
+*              - const struct kdf_tree *t: pointer to input tree
+*              - struct kdf_tree_node node: node
+*
+* Returns 0 on success, -1 if the node is not in the tree
+**************************************************/
+int kdf_tree_node_key(uint8_t key[KDF_TREE_KEYBYTES], const struct kdf_tree *t, struct kdf_tree_node node)
+{
+  const struct kdf_tree_node root = {0, 0};
+
+  if(node.depth > t->depth)
+    return -1;
+  return kdf_tree_derive(key, t->root, root, node);
+}
+
+/*************************************************
+* Name:        kdf_tree_epoch_key
+*
+* Description: Derive the symmetric key of an epoch from the root
+*
+* Arguments:   - uint8_t *sek: pointer to output key
+*                              (of length KDF_TREE_KEYBYTES)
+*              - const struct kdf_tree *t: pointer to input tree
+*              - uint64_t epoch: epoch number
+*
+* Returns 0 on success, -1 if the epoch is not in the tree
+**************************************************/
+int kdf_tree_epoch_key(uint8_t sek[KDF_TREE_KEYBYTES], const struct kdf_tree *t, uint64_t epoch)
+{
+  const struct kdf_tree_node leaf = {t->depth, epoch};
+
+  if(epoch >= t->nepochs)
+    return -1;
+  return kdf_tree_node_key(sek, t, leaf);
+}
+
+static int cmp_range(const void *a, const void *b)
+{
+  const struct kdf_tree_range *x = a, *y = b;
+
+  return (x->first > y->first) - (x->first < y->first);
+}
+
+/*************************************************
+* Name:        kdf_tree_cover
+*
+* Description: Compute the cover of a set of epochs: the fewest nodes of
+*              the tree whose leaves are exactly the epochs of the set,
+*              in the order of their epochs. Each maximal run of epochs
+*              is split into the largest aligned subtrees, at most
+*              2*depth of them.
+*
+* Arguments:   - struct kdf_tree_node *cover: pointer to output nodes, may
+*                                             be NULL if maxnodes is 0
+*              - size_t maxnodes: number of nodes cover has room for; only
+*                                 the first maxnodes nodes are written
+*              - struct kdf_tree_range *ranges: pointer to ranges of epochs,
+*                                               which may overlap, touch or
+*                                               reach past nepochs; sorted
+*                                               in place
+*              - size_t nranges: number of ranges
+*              - uint64_t nepochs: number of epochs of the tree,
+*                                  1 <= nepochs <= 2^KDF_TREE_MAXDEPTH
+*
+* Returns the number of nodes of the cover, which may exceed maxnodes
+**************************************************/
+size_t kdf_tree_cover(struct kdf_tree_node *cover,
+                      size_t maxnodes,
+                      struct kdf_tree_range *ranges,
+                      size_t nranges,
+                      uint64_t nepochs)
+{
+  size_t i, n = 0;
+  unsigned int depth, j;
+  uint64_t a, b, size;
+
+  for(depth=0;(UINT64_C(1) << depth) < nepochs;depth++);
+  qsort(ranges, nranges, sizeof(ranges[0]), cmp_range);
+
+  for(i=0;i<nranges;) {
+    // merge the runs that overlap or touch
+    a = ranges[i].first;
+    b = ranges[i].end;
+    for(i++;i<nranges && ranges[i].first <= b;i++)
+      b = (ranges[i].end > b) ? ranges[i].end : b;
+    b = (b < nepochs) ? b : nepochs;
+
+    while(a < b) {
+      j = a ? (unsigned int)__builtin_ctzll(a) : depth;
+      j = (j < depth) ? j : depth;
+      for(size=UINT64_C(1)<<j;size > b-a;size>>=1)
+        j--;
+      if(n < maxnodes) {
+        cover[n].depth = depth - j;
+        cover[n].index = a >> j;
+      }
+      n++;
+      a += size;
+    }
+  }
+
+  return n;
+}
+
+/*************************************************
+* Name:        kdf_tree_cover_keys
+*
+* Description: Derive the keys of the nodes of a cover from the root. The
+*              path of the previous node is kept, so nodes next to each
+*              other in epoch order only derive the levels below their
+*              lowest common ancestor.
+*
+* Arguments:   - uint8_t (*keys)[KDF_TREE_KEYBYTES]: pointer to ncover
+*                                                    output keys
+*              - const struct kdf_tree *t: pointer to input tree
+*              - const struct kdf_tree_node *cover: pointer to input nodes
+*              - size_t ncover: number of nodes
+*
+* Returns 0 on success, -1 if a node is not in the tree
+**************************************************/
+int kdf_tree_cover_keys(uint8_t (*keys)[KDF_TREE_KEYBYTES],
+                        const struct kdf_tree *t,
+                        const struct kdf_tree_node *cover,
+                        size_t ncover)
+{
+  size_t k;
+  unsigned int c, j, pdepth = 0;
+  uint64_t i, pindex = 0;
+  uint8_t path[KDF_TREE_MAXDEPTH+1][KDF_TREE_KEYBYTES];
+  uint8_t sibling[KDF_TREE_KEYBYTES];
+
+  memcpy(path[0], t->root, KDF_TREE_KEYBYTES);
+  for(k=0;k<ncover;k++) {
+    if(cover[k].depth > t->depth || (cover[k].index >> cover[k].depth)) {
+      wipe(path, sizeof(path));
+      return -1;
+    }
+
+    // lowest common ancestor with the previous node
+    c = (cover[k].depth < pdepth) ? cover[k].depth : pdepth;
+    while((cover[k].index >> (cover[k].depth - c)) != (pindex >> (pdepth - c)))
+      c--;
+
+    for(j=c;j<cover[k].depth;j++) {
+      i = cover[k].index >> (cover[k].depth - j - 1);
+      if(i & 1)
+        kdf_tree_children(sibling, path[j+1], path[j], j, i >> 1);
+      else
+        kdf_tree_children(path[j+1], sibling, path[j], j, i >> 1);
+    }
+    memcpy(keys[k], path[cover[k].depth], KDF_TREE_KEYBYTES);
+    pdepth = cover[k].depth;
+    pindex = cover[k].index;
+  }
+
+  wipe(path, sizeof(path));
+  wipe(sibling, sizeof(sibling));
+  return 0;
+}
+
+/*************************************************
+* Name:        kdf_tree_iter_init
+*
+* Description: Start an iterator over the epochs below a node, for a
+*              subscriber holding the key of a cover node
+*
+* Arguments:   - struct kdf_tree_iter *it: pointer to output iterator
+*              - const uint8_t *key: pointer to input key of the node
+*                                    (of length KDF_TREE_KEYBYTES)
+*              - struct kdf_tree_node node: node
+*              - uint64_t nepochs: number of epochs of the tree,
+*                                  1 <= nepochs <= 2^KDF_TREE_MAXDEPTH
+*
+* Returns 0 on success, -1 if the node is not in the tree or has no
+* epochs below it
+**************************************************/
+int kdf_tree_iter_init(struct kdf_tree_iter *it,
+                       const uint8_t key[KDF_TREE_KEYBYTES],
+                       struct kdf_tree_node node,
+                       uint64_t nepochs)
+{
+  unsigned int j;
+
+  if(nepochs == 0 || nepochs > (UINT64_C(1) << KDF_TREE_MAXDEPTH))
+    return -1;
+  for(it->depth=0;(UINT64_C(1) << it->depth) < nepochs;it->depth++);
+  if(node.depth > it->depth || (node.index >> node.depth))
+    return -1;
+
+  it->top = node.depth;
+  it->epoch = node.index << (it->depth - node.depth);
+  it->end = (node.index + 1) << (it->depth - node.depth);
+  it->end = (it->end < nepochs) ? it->end : nepochs;
+  if(it->epoch >= it->end)
+    return -1;
+
+  // leftmost path
+  memcpy(it->key[it->top], key, KDF_TREE_KEYBYTES);
+  for(j=it->top;j<it->depth;j++)
+    kdf_tree_children(it->key[j+1], it->sibling[j+1], it->key[j], j, it->epoch >> (it->depth - j));
+  return 0;
+}
+
+/*************************************************
+* Name:        kdf_tree_next
+*
+* Description: Get the symmetric key of the next epoch of an iterator.
+*              Each node below the iterator's node is derived once, so
+*              every key costs one hash on average; the iterator holds
+*              one path of keys, independent of the number of epochs.
+*
+* Arguments:   - uint8_t *sek: pointer to output key
+*                              (of length KDF_TREE_KEYBYTES)
+*              - uint64_t *epoch: pointer to output epoch number of sek
+*              - struct kdf_tree_iter *it: pointer to iterator
+*
+* Returns 0 on success, -1 if the iterator is exhausted
+**************************************************/
+int kdf_tree_next(uint8_t sek[KDF_TREE_KEYBYTES], uint64_t *epoch, struct kdf_tree_iter *it)
+{
+  unsigned int j, t;
+
+  if(it->epoch >= it->end)
+    return -1;
+
+  memcpy(sek, it->key[it->depth], KDF_TREE_KEYBYTES);
+  *epoch = it->epoch++;
+
+  if(it->epoch < it->end) {
+    // the path turns right at the level of the lowest set bit of epoch
+    t = it->depth - __builtin_ctzll(it->epoch);
+    memcpy(it->key[t], it->sibling[t], KDF_TREE_KEYBYTES);
+    for(j=t;j<it->depth;j++)
+      kdf_tree_children(it->key[j+1], it->sibling[j+1], it->key[j], j, it->epoch >> (it->depth - j));
+  }
+  else {
+    wipe(it->key, sizeof(it->key));
+    wipe(it->sibling, sizeof(it->sibling));
+  }
+  return 0;
+}
+
+// children of LANES nodes at once, in[l] as in kdf_tree_children
+static void children_x(uint8_t out[LANES][2*KDF_TREE_KEYBYTES], uint8_t in[LANES][10+KDF_TREE_KEYBYTES])
+{
+#ifdef KECCAK_X8
+  unsigned int l;
+  uint8_t *pout[8];
+  const uint8_t *pin[8];
+
+  for(l=0;l<8;l++) {
+    pout[l] = out[l];
+    pin[l] = in[l];
+  }
+  shake256x8(pout, 2*KDF_TREE_KEYBYTES, pin, 10+KDF_TREE_KEYBYTES);
+#else
+  shake256x4(out[0], out[1], out[2], out[3], 2*KDF_TREE_KEYBYTES,
+             in[0], in[1], in[2], in[3], 10+KDF_TREE_KEYBYTES);
+#endif
+}
+
+/*************************************************
+* Name:        kdf_tree_expand
+*
+* Description: Derive all epoch keys below a node, level by level, in the
+*              output array itself: the nodes of a level are expanded from
+*              the last to the first, so that their children can overwrite
+*              them, with 8 (4 without AVX-512) nodes per run of the
+*              multi-way Keccak. The keys are the same as from
+*              kdf_tree_iter_init and kdf_tree_next.
+*
+* Arguments:   - uint8_t (*leaves)[KDF_TREE_KEYBYTES]: pointer to output keys
+*                                                      of the epochs below
+*                                                      the node, in order
+*              - size_t maxleaves: number of keys leaves has room for;
+*                                  nothing is written if it is too small
+*              - const uint8_t *key: pointer to input key of the node
+*                                    (of length KDF_TREE_KEYBYTES)
+*              - struct kdf_tree_node node: node
+*              - uint64_t nepochs: number of epochs of the tree,
+*                                  1 <= nepochs <= 2^KDF_TREE_MAXDEPTH
+*
+* Returns the number of epochs below the node, the first of which is
+* node.index << (depth of the tree - node.depth), or 0 if the node is not
+* in the tree or has no epochs below it
+**************************************************/
+size_t kdf_tree_expand(uint8_t (*leaves)[KDF_TREE_KEYBYTES],
+                       size_t maxleaves,
+                       const uint8_t key[KDF_TREE_KEYBYTES],
+                       struct kdf_tree_node node,
+                       uint64_t nepochs)
+{
+  unsigned int depth, j, l, nb;
+  uint64_t first, end, count, m, mnext, p, lo, base;
+  uint8_t in[LANES][10+KDF_TREE_KEYBYTES];
+  uint8_t out[LANES][2*KDF_TREE_KEYBYTES];
+
+  if(nepochs == 0 || nepochs > (UINT64_C(1) << KDF_TREE_MAXDEPTH))
+    return 0;
+  for(depth=0;(UINT64_C(1) << depth) < nepochs;depth++);
+  if(node.depth > depth || (node.index >> node.depth))
+    return 0;
+
+  first = node.index << (depth - node.depth);
+  end = (node.index + 1) << (depth - node.depth);
+  end = (end < nepochs) ? end : nepochs;
+  if(first >= end)
+    return 0;
+  count = end - first;
+  if(count > maxleaves)
+    return count;
+
+  memset(in, 0, sizeof(in));
+  memcpy(leaves[0], key, KDF_TREE_KEYBYTES);
+  m = 1;
+  for(j=node.depth;j<depth;j++) {
+    // nodes of the next level with epochs below nepochs
+    mnext = ((count - 1) >> (depth - j - 1)) + 1;
+    base = node.index << (j - node.depth);
+    for(p=m;p>0;p-=nb) {
+      nb = (p < LANES) ? p : LANES;
+      lo = p - nb;
+      for(l=0;l<nb;l++)
+        node_input(in[l], leaves[lo+l], j, base + lo + l);
+      children_x(out, in);
+      for(l=0;l<nb;l++) {
+        memcpy(leaves[2*(lo+l)], out[l], KDF_TREE_KEYBYTES);
+        if(2*(lo+l)+1 < mnext)
+          memcpy(leaves[2*(lo+l)+1], out[l]+KDF_TREE_KEYBYTES, KDF_TREE_KEYBYTES);
+      }
+    }
+    m = mnext;
+  }
+
+  wipe(in, sizeof(in));
+  wipe(out, sizeof(out));
+  return count;
+}
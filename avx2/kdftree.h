@@ -0,0 +1,89 @@
+#ifndef KDFTREE_H
+#define KDFTREE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * KDF tree of epoch keys: a binary tree of depth d = ceil(log2 n) over
+ * n epochs, whose leaves at depth d are the symmetric keys sek_e of the
+ * epochs e = 0, ..., n-1. The children of the node with index i at depth
+ * j (the root is index 0 at depth 0) are
+ *
+ *   left || right = SHAKE256(KDF_TREE_DOMAIN || j || le64(i) || key)
+ *
+ * with indices 2i and 2i+1. Nodes are derived on demand from the root or
+ * from any ancestor, in one hash per level; nothing is stored per node.
+ *
+ * Access to a set of epochs is granted with the keys of its cover: the
+ * fewest nodes whose leaves are exactly the epochs of the set. Whoever
+ * holds the key of a node can derive the keys of all epochs below it.
+ */
+
+#define KDF_TREE_KEYBYTES 16
+#define KDF_TREE_DOMAIN 0x02
+#define KDF_TREE_MAXDEPTH 48
+
+struct kdf_tree {
+  uint64_t nepochs;
+  unsigned int depth;
+  uint8_t root[KDF_TREE_KEYBYTES];
+};
+
+struct kdf_tree_node {
+  unsigned int depth;
+  uint64_t index;
+};
+
+// half-open range [first, end) of epochs
+struct kdf_tree_range {
+  uint64_t first;
+  uint64_t end;
+};
+
+struct kdf_tree_iter {
+  uint64_t epoch;
+  uint64_t end;
+  unsigned int top;
+  unsigned int depth;
+  uint8_t key[KDF_TREE_MAXDEPTH+1][KDF_TREE_KEYBYTES];
+  uint8_t sibling[KDF_TREE_MAXDEPTH+1][KDF_TREE_KEYBYTES];
+};
+
+void kdf_tree_children(uint8_t left[KDF_TREE_KEYBYTES],
+                       uint8_t right[KDF_TREE_KEYBYTES],
+                       const uint8_t key[KDF_TREE_KEYBYTES],
+                       unsigned int depth,
+                       uint64_t index);
+int kdf_tree_derive(uint8_t out[KDF_TREE_KEYBYTES],
+                    const uint8_t key[KDF_TREE_KEYBYTES],
+                    struct kdf_tree_node from,
+                    struct kdf_tree_node to);
+
+int kdf_tree_init(struct kdf_tree *t, const uint8_t root[KDF_TREE_KEYBYTES], uint64_t nepochs);
+int kdf_tree_node_key(uint8_t key[KDF_TREE_KEYBYTES], const struct kdf_tree *t, struct kdf_tree_node node);
+int kdf_tree_epoch_key(uint8_t sek[KDF_TREE_KEYBYTES], const struct kdf_tree *t, uint64_t epoch);
+
+size_t kdf_tree_cover(struct kdf_tree_node *cover,
+                      size_t maxnodes,
+                      struct kdf_tree_range *ranges,
+                      size_t nranges,
+                      uint64_t nepochs);
+int kdf_tree_cover_keys(uint8_t (*keys)[KDF_TREE_KEYBYTES],
+                        const struct kdf_tree *t,
+                        const struct kdf_tree_node *cover,
+                        size_t ncover);
+
+int kdf_tree_iter_init(struct kdf_tree_iter *it,
+                       const uint8_t key[KDF_TREE_KEYBYTES],
+                       struct kdf_tree_node node,
+                       uint64_t nepochs);
+int kdf_tree_next(uint8_t sek[KDF_TREE_KEYBYTES], uint64_t *epoch, struct kdf_tree_iter *it);
+
+size_t kdf_tree_expand(uint8_t (*leaves)[KDF_TREE_KEYBYTES],
+                       size_t maxleaves,
+                       const uint8_t key[KDF_TREE_KEYBYTES],
+                       struct kdf_tree_node node,
+                       uint64_t nepochs);
+
+#endif
@@ -1 +0,0 @@
-../ref/kem.c
\ No newline at end of file
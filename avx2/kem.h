@@ -1 +0,0 @@
-../ref/kem.h
\ No newline at end of file
@@ -25,4 +25,32 @@ void ntttobytes_avx(uint8_t *r, const __m256i *a, const __m256i *qdata);
 #define nttfrombytes_avx KYBER_NAMESPACE(nttfrombytes_avx)
 void nttfrombytes_avx(__m256i *r, const uint8_t *a, const __m256i *qdata);
 
+#if defined(__AVX512F__) && defined(__AVX512BW__) && !defined(KYBER_NO_AVX512)
+/* AVX-512 versions of ntt_avx, invntt_avx and basemul_avx, see ntt512.c */
+#define KYBER_AVX512
+
+#define ntt_avx512 KYBER_NAMESPACE(ntt_avx512)
+void ntt_avx512(__m256i *r, const __m256i *qdata);
+#define invntt_avx512 KYBER_NAMESPACE(invntt_avx512)
+void invntt_avx512(__m256i *r, const __m256i *qdata);
+
+#define basemul_avx512 KYBER_NAMESPACE(basemul_avx512)
+void basemul_avx512(__m256i *r,
+                    const __m256i *a,
+                    const __m256i *b,
+                    const __m256i *qdata);
+#define basemul_acc_avx512 KYBER_NAMESPACE(basemul_acc_avx512)
+void basemul_acc_avx512(__m256i *r,
+                        const __m256i *a,
+                        const __m256i *b,
+                        unsigned int n,
+                        const __m256i *qdata);
+
+#if defined(__AVX512VBMI__) && defined(__AVX512VBMI2__)
+/* Byte permutes and word compression for the AVX-512 versions of
+ * rej_uniform_avx, the CBD samplers and the ciphertext compression */
+#define KYBER_AVX512_VBMI
+#endif
+#endif
+
 #endif
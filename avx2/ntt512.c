@@ -0,0 +1,586 @@
+#include <stdint.h>
+#include <immintrin.h>
+#include "params.h"
+#include "consts.h"
+#include "ntt.h"
+
+#ifdef KYBER_AVX512
+/*
+ * AVX-512 versions of ntt.S, invntt.S and basemul.S. Every 512-bit register
+ * holds in its two halves the 256-bit registers that the AVX2 code uses for
+ * the two independent halves (off = 0 and 1) of a polynomial, or for two
+ * 64-coefficient blocks in basemul, so each 16-bit lane goes through
+ * exactly the same operations as in the AVX2 code and the outputs are
+ * bit-identical. The macros follow the AVX2 macros of the same name, with
+ * the register numbers turned into variables y0, ..., y15.
+ */
+
+// 256-bit rows lo and hi as the two halves of one register
+static inline __m512i load2(const int16_t *lo, const int16_t *hi)
+{
+  __m512i t = _mm512_castsi256_si512(_mm256_load_si256((const __m256i *)lo));
+  return _mm512_inserti64x4(t, _mm256_load_si256((const __m256i *)hi), 1);
+}
+
+static inline void store2(int16_t *lo, int16_t *hi, __m512i a)
+{
+  _mm256_store_si256((__m256i *)lo, _mm512_castsi512_si256(a));
+  _mm256_store_si256((__m256i *)hi, _mm512_extracti64x4_epi64(a, 1));
+}
+
+static inline __m512i bcast256(const int16_t *a)
+{
+  return _mm512_broadcast_i64x4(_mm256_load_si256((const __m256i *)a));
+}
+
+static inline __m512i bcast64(const int16_t *a)
+{
+  int64_t t;
+
+  __builtin_memcpy(&t, a, sizeof(t));
+  return _mm512_set1_epi64(t);
+}
+
+#define add(a,b) _mm512_add_epi16(a,b)
+#define sub(a,b) _mm512_sub_epi16(a,b)
+#define mullo(a,b) _mm512_mullo_epi16(a,b)
+#define mulhi(a,b) _mm512_mulhi_epi16(a,b)
+
+/* shuffle.inc */
+#define SHUFFLE8(r0,r1,r2,r3) \
+  y##r2 = _mm512_permutex2var_epi64(y##r0, idx8lo, y##r1); \
+  y##r3 = _mm512_permutex2var_epi64(y##r0, idx8hi, y##r1)
+
+#define SHUFFLE4(r0,r1,r2,r3) \
+  y##r2 = _mm512_unpacklo_epi64(y##r0, y##r1); \
+  y##r3 = _mm512_unpackhi_epi64(y##r0, y##r1)
+
+#define SHUFFLE2(r0,r1,r2,r3) \
+  y##r2 = _mm512_castps_si512(_mm512_moveldup_ps(_mm512_castsi512_ps(y##r1))); \
+  y##r2 = _mm512_mask_blend_epi32(0xAAAA, y##r0, y##r2); \
+  y##r0 = _mm512_srli_epi64(y##r0, 32); \
+  y##r3 = _mm512_mask_blend_epi32(0xAAAA, y##r0, y##r1)
+
+#define SHUFFLE1(r0,r1,r2,r3) \
+  y##r2 = _mm512_slli_epi32(y##r1, 16); \
+  y##r2 = _mm512_mask_blend_epi16(0xAAAAAAAA, y##r0, y##r2); \
+  y##r0 = _mm512_srli_epi32(y##r0, 16); \
+  y##r3 = _mm512_mask_blend_epi16(0xAAAAAAAA, y##r0, y##r1)
+
+/* fq.inc */
+#define RED16(r) \
+  y12 = mulhi(y1, y##r); \
+  y12 = _mm512_srai_epi16(y12, 10); \
+  y12 = mullo(y0, y12); \
+  y##r = sub(y##r, y12)
+
+#define FQMULPRECOMP(al,ah,b) \
+  y12 = mullo(y##al, y##b); \
+  y##b = mulhi(y##ah, y##b); \
+  y12 = mulhi(y0, y12); \
+  y##b = sub(y##b, y12)
+
+/* ntt.S */
+#define MUL(rh0,rh1,rh2,rh3,zl0,zl1,zh0,zh1) \
+  y12 = mullo(y##zl0, y##rh0); \
+  y13 = mullo(y##zl0, y##rh1); \
+  y14 = mullo(y##zl1, y##rh2); \
+  y15 = mullo(y##zl1, y##rh3); \
+  y##rh0 = mulhi(y##zh0, y##rh0); \
+  y##rh1 = mulhi(y##zh0, y##rh1); \
+  y##rh2 = mulhi(y##zh1, y##rh2); \
+  y##rh3 = mulhi(y##zh1, y##rh3)
+
+#define REDUCE() \
+  y12 = mulhi(y0, y12); \
+  y13 = mulhi(y0, y13); \
+  y14 = mulhi(y0, y14); \
+  y15 = mulhi(y0, y15)
+
+#define UPDATE(rln,rl0,rl1,rl2,rl3,rh0,rh1,rh2,rh3) \
+  y##rln = add(y##rl0, y##rh0); \
+  y##rh0 = sub(y##rl0, y##rh0); \
+  y##rl0 = add(y##rl1, y##rh1); \
+  y##rh1 = sub(y##rl1, y##rh1); \
+  y##rl1 = add(y##rl2, y##rh2); \
+  y##rh2 = sub(y##rl2, y##rh2); \
+  y##rl2 = add(y##rl3, y##rh3); \
+  y##rh3 = sub(y##rl3, y##rh3); \
+  y##rln = sub(y##rln, y12); \
+  y##rh0 = add(y##rh0, y12); \
+  y##rl0 = sub(y##rl0, y13); \
+  y##rh1 = add(y##rh1, y13); \
+  y##rl1 = sub(y##rl1, y14); \
+  y##rh2 = add(y##rh2, y14); \
+  y##rl2 = sub(y##rl2, y15); \
+  y##rh3 = add(y##rh3, y15)
+
+/* invntt.S */
+#define BUTTERFLY(rl0,rl1,rl2,rl3,rh0,rh1,rh2,rh3,zl0,zl1,zh0,zh1) \
+  y12 = sub(y##rh0, y##rl0); \
+  y##rl0 = add(y##rl0, y##rh0); \
+  y13 = sub(y##rh1, y##rl1); \
+  y##rh0 = mullo(y##zl0, y12); \
+  y##rl1 = add(y##rl1, y##rh1); \
+  y14 = sub(y##rh2, y##rl2); \
+  y##rh1 = mullo(y##zl0, y13); \
+  y##rl2 = add(y##rl2, y##rh2); \
+  y15 = sub(y##rh3, y##rl3); \
+  y##rh2 = mullo(y##zl1, y14); \
+  y##rl3 = add(y##rl3, y##rh3); \
+  y##rh3 = mullo(y##zl1, y15); \
+  y12 = mulhi(y##zh0, y12); \
+  y13 = mulhi(y##zh0, y13); \
+  y14 = mulhi(y##zh1, y14); \
+  y15 = mulhi(y##zh1, y15); \
+  y##rh0 = mulhi(y0, y##rh0); \
+  y##rh1 = mulhi(y0, y##rh1); \
+  y##rh2 = mulhi(y0, y##rh2); \
+  y##rh3 = mulhi(y0, y##rh3); \
+  y##rh0 = sub(y12, y##rh0); \
+  y##rh1 = sub(y13, y##rh1); \
+  y##rh2 = sub(y14, y##rh2); \
+  y##rh3 = sub(y15, y##rh3)
+
+/*************************************************
+* Name:        ntt_avx512
+*
+* Description: Forward NTT, bit-identical to ntt_avx
+*
+* Arguments:   - __m256i *r: pointer to in/output polynomial
+*              - const __m256i *consts: pointer to constants
+**************************************************/
+void ntt_avx512(__m256i *r, const __m256i *consts)
+{
+  int16_t *c = (int16_t *)r;
+  const int16_t *qd = (const int16_t *)consts;
+  const int16_t *zeta = qd + _ZETAS_EXP;
+  const __m512i idx8lo = _mm512_set_epi64(13, 12, 5, 4, 9, 8, 1, 0);
+  const __m512i idx8hi = _mm512_set_epi64(15, 14, 7, 6, 11, 10, 3, 2);
+  __m512i y0, y1, y2, y3, y4, y5, y6, y7, y8, y9, y10, y11, y12, y13, y14, y15;
+  __m512i z0, z1, z2, z3, z4, z5, z6, z7;
+
+  y0 = bcast256(qd + _16XQ);
+
+  /* level 0 on both halves of the polynomial at once */
+  y15 = bcast64(zeta + 0);
+  y8 = _mm512_loadu_si512((const __m512i *)(c + 128));
+  y9 = _mm512_loadu_si512((const __m512i *)(c + 160));
+  y10 = _mm512_loadu_si512((const __m512i *)(c + 192));
+  y11 = _mm512_loadu_si512((const __m512i *)(c + 224));
+  y2 = bcast64(zeta + 4);
+  MUL(8,9,10,11,15,15,2,2);
+  y4 = _mm512_loadu_si512((const __m512i *)(c + 0));
+  y5 = _mm512_loadu_si512((const __m512i *)(c + 32));
+  y6 = _mm512_loadu_si512((const __m512i *)(c + 64));
+  y7 = _mm512_loadu_si512((const __m512i *)(c + 96));
+  REDUCE();
+  UPDATE(3,4,5,6,7,8,9,10,11);
+
+  /* rows 16k of the two halves into the two halves of one register */
+  z0 = _mm512_shuffle_i64x2(y3, y8, 0x44);
+  z1 = _mm512_shuffle_i64x2(y3, y8, 0xEE);
+  z2 = _mm512_shuffle_i64x2(y4, y9, 0x44);
+  z3 = _mm512_shuffle_i64x2(y4, y9, 0xEE);
+  z4 = _mm512_shuffle_i64x2(y5, y10, 0x44);
+  z5 = _mm512_shuffle_i64x2(y5, y10, 0xEE);
+  z6 = _mm512_shuffle_i64x2(y6, y11, 0x44);
+  z7 = _mm512_shuffle_i64x2(y6, y11, 0xEE);
+
+  /* level 1 */
+  y15 = load2(zeta + 16, zeta + 224 + 16);
+  y8 = z4;
+  y9 = z5;
+  y10 = z6;
+  y11 = z7;
+  y2 = load2(zeta + 32, zeta + 224 + 32);
+  MUL(8,9,10,11,15,15,2,2);
+  y4 = z0;
+  y5 = z1;
+  y6 = z2;
+  y7 = z3;
+  REDUCE();
+  UPDATE(3,4,5,6,7,8,9,10,11);
+
+  /* level 2 */
+  SHUFFLE8(5,10,7,10);
+  SHUFFLE8(6,11,5,11);
+  y15 = load2(zeta + 48, zeta + 224 + 48);
+  y2 = load2(zeta + 64, zeta + 224 + 64);
+  MUL(7,10,5,11,15,15,2,2);
+  SHUFFLE8(3,8,6,8);
+  SHUFFLE8(4,9,3,9);
+  REDUCE();
+  UPDATE(4,6,8,3,9,7,10,5,11);
+
+  /* level 3 */
+  SHUFFLE4(8,5,9,5);
+  SHUFFLE4(3,11,8,11);
+  y15 = load2(zeta + 80, zeta + 224 + 80);
+  y2 = load2(zeta + 96, zeta + 224 + 96);
+  MUL(9,5,8,11,15,15,2,2);
+  SHUFFLE4(4,7,3,7);
+  SHUFFLE4(6,10,4,10);
+  REDUCE();
+  UPDATE(6,3,7,4,10,9,5,8,11);
+
+  /* level 4 */
+  SHUFFLE2(7,8,10,8);
+  SHUFFLE2(4,11,7,11);
+  y15 = load2(zeta + 112, zeta + 224 + 112);
+  y2 = load2(zeta + 128, zeta + 224 + 128);
+  MUL(10,8,7,11,15,15,2,2);
+  SHUFFLE2(6,9,4,9);
+  SHUFFLE2(3,5,6,5);
+  REDUCE();
+  UPDATE(3,4,9,6,5,10,8,7,11);
+
+  /* level 5 */
+  SHUFFLE1(9,7,5,7);
+  SHUFFLE1(6,11,9,11);
+  y15 = load2(zeta + 144, zeta + 224 + 144);
+  y2 = load2(zeta + 160, zeta + 224 + 160);
+  MUL(5,7,9,11,15,15,2,2);
+  SHUFFLE1(3,10,6,10);
+  SHUFFLE1(4,8,3,8);
+  REDUCE();
+  UPDATE(4,6,10,3,8,5,7,9,11);
+
+  /* level 6 */
+  y14 = load2(zeta + 176, zeta + 224 + 176);
+  y15 = load2(zeta + 208, zeta + 224 + 208);
+  y8 = load2(zeta + 192, zeta + 224 + 192);
+  y2 = load2(zeta + 224, zeta + 224 + 224);
+  MUL(10,3,9,11,14,15,8,2);
+  REDUCE();
+  UPDATE(8,4,6,5,7,10,3,9,11);
+
+  store2(c +   0, c + 128 +   0, y8);
+  store2(c +  16, c + 128 +  16, y4);
+  store2(c +  32, c + 128 +  32, y10);
+  store2(c +  48, c + 128 +  48, y3);
+  store2(c +  64, c + 128 +  64, y6);
+  store2(c +  80, c + 128 +  80, y5);
+  store2(c +  96, c + 128 +  96, y9);
+  store2(c + 112, c + 128 + 112, y11);
+  (void)y1;
+}
+
+/*************************************************
+* Name:        invntt_avx512
+*
+* Description: Inverse NTT, bit-identical to invntt_avx
+*
+* Arguments:   - __m256i *r: pointer to in/output polynomial
+*              - const __m256i *consts: pointer to constants
+**************************************************/
+void invntt_avx512(__m256i *r, const __m256i *consts)
+{
+  int16_t *c = (int16_t *)r;
+  const int16_t *qd = (const int16_t *)consts;
+  // the half off = 0 uses the zetas of (1-off)*224
+  const int16_t *zeta0 = qd + _ZETAS_EXP + 224;
+  const int16_t *zeta1 = qd + _ZETAS_EXP;
+  const __m512i idx8lo = _mm512_set_epi64(13, 12, 5, 4, 9, 8, 1, 0);
+  const __m512i idx8hi = _mm512_set_epi64(15, 14, 7, 6, 11, 10, 3, 2);
+  __m256i revidxd;
+  __m512i y0, y1, y2, y3, y4, y5, y6, y7, y8, y9, y10, y11, y12, y13, y14, y15;
+  __m512i z0, z1, z2, z3, z4, z5, z6, z7;
+
+  y0 = bcast256(qd + _16XQ);
+
+  /* level 0 */
+  y2 = bcast256(qd + _16XFLO);
+  y3 = bcast256(qd + _16XFHI);
+  y4 = load2(c +  0, c + 128 +  0);
+  y6 = load2(c + 32, c + 128 + 32);
+  y5 = load2(c + 16, c + 128 + 16);
+  y7 = load2(c + 48, c + 128 + 48);
+  FQMULPRECOMP(2,3,4);
+  FQMULPRECOMP(2,3,6);
+  FQMULPRECOMP(2,3,5);
+  FQMULPRECOMP(2,3,7);
+  y8 = load2(c +  64, c + 128 +  64);
+  y10 = load2(c +  96, c + 128 +  96);
+  y9 = load2(c +  80, c + 128 +  80);
+  y11 = load2(c + 112, c + 128 + 112);
+  FQMULPRECOMP(2,3,8);
+  FQMULPRECOMP(2,3,10);
+  FQMULPRECOMP(2,3,9);
+  FQMULPRECOMP(2,3,11);
+  y15 = _mm512_permutex_epi64(load2(zeta0 + 208, zeta1 + 208), 0x4E);
+  y1 = _mm512_permutex_epi64(load2(zeta0 + 176, zeta1 + 176), 0x4E);
+  y2 = _mm512_permutex_epi64(load2(zeta0 + 224, zeta1 + 224), 0x4E);
+  y3 = _mm512_permutex_epi64(load2(zeta0 + 192, zeta1 + 192), 0x4E);
+  y12 = bcast256(qd + _REVIDXB);
+  y15 = _mm512_shuffle_epi8(y15, y12);
+  y1 = _mm512_shuffle_epi8(y1, y12);
+  y2 = _mm512_shuffle_epi8(y2, y12);
+  y3 = _mm512_shuffle_epi8(y3, y12);
+  BUTTERFLY(4,5,8,9,6,7,10,11,15,1,2,3);
+
+  /* level 1 */
+  y2 = _mm512_permutex_epi64(load2(zeta0 + 144, zeta1 + 144), 0x4E);
+  y3 = _mm512_permutex_epi64(load2(zeta0 + 160, zeta1 + 160), 0x4E);
+  y1 = bcast256(qd + _REVIDXB);
+  y2 = _mm512_shuffle_epi8(y2, y1);
+  y3 = _mm512_shuffle_epi8(y3, y1);
+  BUTTERFLY(4,5,6,7,8,9,10,11,2,2,3,3);
+  SHUFFLE1(4,5,3,5);
+  SHUFFLE1(6,7,4,7);
+  SHUFFLE1(8,9,6,9);
+  SHUFFLE1(10,11,8,11);
+
+  /* level 2 */
+  revidxd = _mm256_load_si256((const __m256i *)(qd + _REVIDXD));
+  y12 = _mm512_inserti64x4(_mm512_castsi256_si512(revidxd),
+                           _mm256_add_epi32(revidxd, _mm256_set1_epi32(8)), 1);
+  y2 = _mm512_permutexvar_epi32(y12, load2(zeta0 + 112, zeta1 + 112));
+  y10 = _mm512_permutexvar_epi32(y12, load2(zeta0 + 128, zeta1 + 128));
+  BUTTERFLY(3,4,6,8,5,7,9,11,2,2,10,10);
+  y1 = bcast256(qd + _16XV);
+  RED16(3);
+  SHUFFLE2(3,4,10,4);
+  SHUFFLE2(6,8,3,8);
+  SHUFFLE2(5,7,6,7);
+  SHUFFLE2(9,11,5,11);
+
+  /* level 3 */
+  y2 = _mm512_permutex_epi64(load2(zeta0 + 80, zeta1 + 80), 0x1B);
+  y9 = _mm512_permutex_epi64(load2(zeta0 + 96, zeta1 + 96), 0x1B);
+  BUTTERFLY(10,3,6,5,4,8,7,11,2,2,9,9);
+  SHUFFLE4(10,3,9,3);
+  SHUFFLE4(6,5,10,5);
+  SHUFFLE4(4,8,6,8);
+  SHUFFLE4(7,11,4,11);
+
+  /* level 4 */
+  y2 = _mm512_permutex_epi64(load2(zeta0 + 48, zeta1 + 48), 0x4E);
+  y7 = _mm512_permutex_epi64(load2(zeta0 + 64, zeta1 + 64), 0x4E);
+  BUTTERFLY(9,10,6,4,3,5,8,11,2,2,7,7);
+  RED16(9);
+  SHUFFLE8(9,10,7,10);
+  SHUFFLE8(6,4,9,4);
+  SHUFFLE8(3,5,6,5);
+  SHUFFLE8(8,11,3,11);
+
+  /* level 5 */
+  y2 = load2(zeta0 + 16, zeta1 + 16);
+  y8 = load2(zeta0 + 32, zeta1 + 32);
+  BUTTERFLY(7,9,6,3,10,4,5,11,2,2,8,8);
+
+  /* rows 16k of the two halves back into rows of 32 coefficients */
+  z0 = _mm512_shuffle_i64x2(y7, y9, 0x44);
+  z1 = _mm512_shuffle_i64x2(y7, y9, 0xEE);
+  z2 = _mm512_shuffle_i64x2(y6, y3, 0x44);
+  z3 = _mm512_shuffle_i64x2(y6, y3, 0xEE);
+  z4 = _mm512_shuffle_i64x2(y10, y4, 0x44);
+  z5 = _mm512_shuffle_i64x2(y10, y4, 0xEE);
+  z6 = _mm512_shuffle_i64x2(y5, y11, 0x44);
+  z7 = _mm512_shuffle_i64x2(y5, y11, 0xEE);
+
+  /* level 6 on both halves of the polynomial at once */
+  y4 = z0;
+  y8 = z1;
+  y5 = z2;
+  y9 = z3;
+  y2 = bcast64(zeta1 + 0);
+  y6 = z4;
+  y10 = z5;
+  y7 = z6;
+  y11 = z7;
+  y3 = bcast64(zeta1 + 4);
+  BUTTERFLY(4,5,6,7,8,9,10,11,2,2,3,3);
+
+  // red16 of the first 16 coefficients only, as for off = 0 in invntt.S
+  y1 = bcast256(qd + _16XV);
+  y12 = mulhi(y1, y4);
+  y12 = _mm512_srai_epi16(y12, 10);
+  y12 = mullo(y0, y12);
+  y4 = _mm512_mask_sub_epi16(y4, 0x0000FFFF, y4, y12);
+
+  _mm512_storeu_si512((__m512i *)(c +   0), y4);
+  _mm512_storeu_si512((__m512i *)(c +  32), y5);
+  _mm512_storeu_si512((__m512i *)(c +  64), y6);
+  _mm512_storeu_si512((__m512i *)(c +  96), y7);
+  _mm512_storeu_si512((__m512i *)(c + 128), y8);
+  _mm512_storeu_si512((__m512i *)(c + 160), y9);
+  _mm512_storeu_si512((__m512i *)(c + 192), y10);
+  _mm512_storeu_si512((__m512i *)(c + 224), y11);
+  (void)y13; (void)y14;
+}
+
+/*************************************************
+* Name:        schoolbook
+*
+* Description: The schoolbook macro of basemul.S on the 64-coefficient blocks
+*              off and off+1 of a and b at once
+*
+* Arguments:   - __m512i *r: pointer to output rows (4 registers)
+*              - const int16_t *a, *b: pointers to input polynomials
+*              - const int16_t *qd: pointer to constants
+*              - unsigned int off: first block, 0 or 2
+*              - const int16_t *z0, *z1: zetas of the two blocks
+**************************************************/
+static inline void schoolbook(__m512i r[4],
+                              const int16_t *a,
+                              const int16_t *b,
+                              const int16_t *qd,
+                              unsigned int off,
+                              const int16_t *z0,
+                              const int16_t *z1)
+{
+  const int16_t *a0 = a + 64*off, *a1 = a + 64*(off+1);
+  const int16_t *b0 = b + 64*off, *b1 = b + 64*(off+1);
+  __m512i y0, y1, y2, y3, y4, y5, y6, y7, y8, y9, y10, y11, y12, y13, y14, y15, t;
+
+  y0 = bcast256(qd + _16XQINV);
+  y1 = load2(a0 +  0, a1 +  0);                  // a0
+  y2 = load2(a0 + 16, a1 + 16);                  // b0
+  y3 = load2(a0 + 32, a1 + 32);                  // a1
+  y4 = load2(a0 + 48, a1 + 48);                  // b1
+
+  y9 = mullo(y0, y1);                            // a0.lo
+  y10 = mullo(y0, y2);                           // b0.lo
+  y11 = mullo(y0, y3);                           // a1.lo
+  y12 = mullo(y0, y4);                           // b1.lo
+
+  y5 = load2(b0 +  0, b1 +  0);                  // c0
+  y6 = load2(b0 + 16, b1 + 16);                  // d0
+
+  y13 = mulhi(y5, y1);                           // a0c0.hi
+  y1 = mulhi(y6, y1);                            // a0d0.hi
+  y14 = mulhi(y5, y2);                           // b0c0.hi
+  y2 = mulhi(y6, y2);                            // b0d0.hi
+
+  y7 = load2(b0 + 32, b1 + 32);                  // c1
+  y8 = load2(b0 + 48, b1 + 48);                  // d1
+
+  y15 = mulhi(y7, y3);                           // a1c1.hi
+  y3 = mulhi(y8, y3);                            // a1d1.hi
+  y0 = mulhi(y7, y4);                            // b1c1.hi
+  y4 = mulhi(y8, y4);                            // b1d1.hi
+
+  t = y13;
+
+  y13 = mullo(y5, y9);                           // a0c0.lo
+  y9 = mullo(y6, y9);                            // a0d0.lo
+  y5 = mullo(y5, y10);                           // b0c0.lo
+  y10 = mullo(y6, y10);                          // b0d0.lo
+
+  y6 = mullo(y7, y11);                           // a1c1.lo
+  y11 = mullo(y8, y11);                          // a1d1.lo
+  y7 = mullo(y7, y12);                           // b1c1.lo
+  y12 = mullo(y8, y12);                          // b1d1.lo
+
+  y8 = bcast256(qd + _16XQ);
+  y13 = mulhi(y8, y13);
+  y9 = mulhi(y8, y9);
+  y5 = mulhi(y8, y5);
+  y10 = mulhi(y8, y10);
+  y6 = mulhi(y8, y6);
+  y11 = mulhi(y8, y11);
+  y7 = mulhi(y8, y7);
+  y12 = mulhi(y8, y12);
+
+  y13 = sub(y13, t);                             // -a0c0
+  y9 = sub(y1, y9);                              // a0d0
+  y5 = sub(y14, y5);                             // b0c0
+  y10 = sub(y2, y10);                            // b0d0
+
+  y6 = sub(y15, y6);                             // a1c1
+  y11 = sub(y3, y11);                            // a1d1
+  y7 = sub(y0, y7);                              // b1c1
+  y12 = sub(y4, y12);                            // b1d1
+
+  y0 = load2(z0, z1);
+  y1 = load2(z0 + 16, z1 + 16);
+  y2 = mullo(y0, y10);
+  y3 = mullo(y0, y12);
+  y10 = mulhi(y1, y10);
+  y12 = mulhi(y1, y12);
+  y2 = mulhi(y8, y2);
+  y3 = mulhi(y8, y3);
+  y10 = sub(y10, y2);                            // rb0d0
+  y12 = sub(y12, y3);                            // rb1d1
+
+  y9 = add(y9, y5);
+  y11 = add(y11, y7);
+  y13 = sub(y10, y13);
+  y6 = sub(y6, y12);
+
+  r[0] = y13;
+  r[1] = y9;
+  r[2] = y6;
+  r[3] = y11;
+}
+
+static inline void store_rows(int16_t *c, unsigned int off, const __m512i r[4])
+{
+  store2(c + 64*off +  0, c + 64*(off+1) +  0, r[0]);
+  store2(c + 64*off + 16, c + 64*(off+1) + 16, r[1]);
+  store2(c + 64*off + 32, c + 64*(off+1) + 32, r[2]);
+  store2(c + 64*off + 48, c + 64*(off+1) + 48, r[3]);
+}
+
+/*************************************************
+* Name:        basemul_avx512
+*
+* Description: Multiplication in NTT domain, bit-identical to basemul_avx
+*
+* Arguments:   - __m256i *r: pointer to output polynomial
+*              - const __m256i *a, *b: pointers to input polynomials
+*              - const __m256i *consts: pointer to constants
+**************************************************/
+void basemul_avx512(__m256i *r,
+                    const __m256i *a,
+                    const __m256i *b,
+                    const __m256i *consts)
+{
+  const int16_t *qd = (const int16_t *)consts;
+  const int16_t *zeta = qd + _ZETAS_EXP;
+  __m512i t[4];
+
+  schoolbook(t, (const int16_t *)a, (const int16_t *)b, qd, 0, zeta + 176, zeta + 208);
+  store_rows((int16_t *)r, 0, t);
+  schoolbook(t, (const int16_t *)a, (const int16_t *)b, qd, 2, zeta + 400, zeta + 432);
+  store_rows((int16_t *)r, 2, t);
+}
+
+/*************************************************
+* Name:        basemul_acc_avx512
+*
+* Description: Sum of the products in NTT domain of n pairs of polynomials,
+*              bit-identical to adding up the outputs of basemul_avx.
+*              The sums are kept in registers across the n products.
+*
+* Arguments:   - __m256i *r: pointer to output polynomial
+*              - const __m256i *a, *b: pointers to n consecutive input
+*                                      polynomials each
+*              - unsigned int n: number of products, at least 1
+*              - const __m256i *consts: pointer to constants
+**************************************************/
+void basemul_acc_avx512(__m256i *r,
+                        const __m256i *a,
+                        const __m256i *b,
+                        unsigned int n,
+                        const __m256i *consts)
+{
+  unsigned int i, j, off;
+  const int16_t *qd = (const int16_t *)consts;
+  const int16_t *zeta = qd + _ZETAS_EXP;
+  const int16_t *pa = (const int16_t *)a, *pb = (const int16_t *)b;
+  __m512i acc[4], t[4];
+
+  for(off=0;off<4;off+=2) {
+    schoolbook(acc, pa, pb, qd, off, zeta + 176 + 112*off, zeta + 208 + 112*off);
+    for(i=1;i<n;i++) {
+      schoolbook(t, pa + i*KYBER_N, pb + i*KYBER_N, qd, off,
+                 zeta + 176 + 112*off, zeta + 208 + 112*off);
+      for(j=0;j<4;j++)
+        acc[j] = add(acc[j], t[j]);
+    }
+    store_rows((int16_t *)r, off, acc);
+  }
+}
+#endif
@@ -149,6 +149,103 @@ void poly_decompress(poly * restrict r, const uint8_t a[160])
 
 #endif
 
+/*************************************************
+* Name:        poly_compress_bits
+*
+* Description: Compression of a polynomial to d bits per coefficient,
+*              round(x*2^d/q) mod 2^d, with coefficient i stored at bit
+*              position i*d of the output (little endian). The packing is
+*              scalar; it serves storage formats where compression is
+*              done once and decompression is on the fast path.
+*              The coefficients of the input polynomial are assumed to
+*              lie in the invertal [0,q].
+*
+* Arguments:   - uint8_t *r: pointer to output byte array
+*                            (of length KYBER_N/8*d bytes)
+*              - const poly *a: pointer to input polynomial
+*              - unsigned int d: number of bits per coefficient, 1 <= d <= 12
+**************************************************/
+void poly_compress_bits(uint8_t *r, const poly * restrict a, unsigned int d)
+{
+  unsigned int i, n = 0;
+  uint32_t t;
+  uint64_t acc = 0;
+
+  for(i=0;i<KYBER_N;i++) {
+    t = ((uint32_t)a->coeffs[i] << d) + KYBER_Q/2;
+    t = (t / KYBER_Q) & ((1U << d) - 1);
+    acc |= (uint64_t)t << n;
+    n += d;
+    while(n >= 8) {
+      *r++ = acc;
+      acc >>= 8;
+      n -= 8;
+    }
+  }
+}
+
+/*************************************************
+* Name:        poly_decompress_bits
+*
+* Description: De-serialization and subsequent decompression of a polynomial
+*              compressed with poly_compress_bits; approximate inverse of
+*              poly_compress_bits. Each 128-bit lane extracts four d-bit
+*              fields with one byte shuffle and one variable shift.
+*              Output coefficients lie in [0,q).
+*
+* Arguments:   - poly *r: pointer to output polynomial
+*              - const uint8_t *a: pointer to input byte array
+*                                  (of length KYBER_N/8*d bytes)
+*              - unsigned int d: number of bits per coefficient, 1 <= d <= 12
+**************************************************/
+void poly_decompress_bits(poly * restrict r, const uint8_t *a, unsigned int d)
+{
+  unsigned int i, j, bit, off;
+  __m256i f0, f1, shufbidx, shift;
+  ALIGNED_UINT8(12*KYBER_N/8+32) buf;
+  int8_t idx[32];
+  int32_t sh[8];
+  const unsigned int hioff = (4*d) >> 3;
+  const __m256i q = _mm256_set1_epi32(KYBER_Q);
+  const __m256i round = _mm256_set1_epi32(1 << (d-1));
+  const __m256i mask = _mm256_set1_epi32((1 << d) - 1);
+  const __m128i dshift = _mm_cvtsi32_si128(d);
+
+  // the loads below read up to 16 bytes past the field of a group
+  memcpy(buf.coeffs, a, KYBER_N/8*d);
+  memset(buf.coeffs+KYBER_N/8*d, 0, 32);
+
+  // field j of a group of eight starts at bit j*d; the upper lane
+  // is loaded from byte hioff of the group
+  for(j=0;j<8;j++) {
+    bit = j*d;
+    off = (bit >> 3) - (j < 4 ? 0 : hioff);
+    idx[4*j+0] = off+0;
+    idx[4*j+1] = off+1;
+    idx[4*j+2] = off+2;
+    idx[4*j+3] = off+3;
+    sh[j] = bit & 7;
+  }
+  shufbidx = _mm256_loadu_si256((__m256i *)idx);
+  shift = _mm256_loadu_si256((__m256i *)sh);
+
+  for(i=0;i<KYBER_N/16;i++) {
+    const uint8_t *p = &buf.coeffs[2*d*i];
+    f0 = _mm256_loadu2_m128i((const __m128i *)(p+hioff), (const __m128i *)p);
+    f1 = _mm256_loadu2_m128i((const __m128i *)(p+d+hioff), (const __m128i *)(p+d));
+    f0 = _mm256_shuffle_epi8(f0, shufbidx);
+    f1 = _mm256_shuffle_epi8(f1, shufbidx);
+    f0 = _mm256_and_si256(_mm256_srlv_epi32(f0, shift), mask);
+    f1 = _mm256_and_si256(_mm256_srlv_epi32(f1, shift), mask);
+    // (x*q + 2^(d-1)) >> d; x and q both fit into the low 16 bits
+    f0 = _mm256_srl_epi32(_mm256_add_epi32(_mm256_madd_epi16(f0, q), round), dshift);
+    f1 = _mm256_srl_epi32(_mm256_add_epi32(_mm256_madd_epi16(f1, q), round), dshift);
+    f0 = _mm256_packus_epi32(f0, f1);
+    f0 = _mm256_permute4x64_epi64(f0, 0xD8);
+    _mm256_store_si256(&r->vec[i], f0);
+  }
+}
+
 /*************************************************
 * Name:        poly_tobytes
 *
@@ -251,6 +348,22 @@ void poly_tomsg(uint8_t msg[KYBER_INDCPA_MSGBYTES], const poly * restrict a)
 {
   unsigned int i;
   uint32_t small;
+#ifdef KYBER_AVX512
+  // 32 coefficients per register, vpmovw2m takes their sign bits in order
+  __m512i f, g;
+  const __m512i hq = _mm512_set1_epi16((KYBER_Q - 1)/2);
+  const __m512i hhq = _mm512_set1_epi16((KYBER_Q - 1)/4);
+
+  for(i=0;i<KYBER_N/32;i++) {
+    f = _mm512_loadu_si512(&a->vec[2*i]);
+    f = _mm512_sub_epi16(hq, f);
+    g = _mm512_srai_epi16(f, 15);
+    f = _mm512_xor_si512(f, g);
+    f = _mm512_sub_epi16(f, hhq);
+    small = _mm512_movepi16_mask(f);
+    memcpy(&msg[4*i], &small, 4);
+  }
+#else
   __m256i f0, f1, g0, g1;
   const __m256i hq = _mm256_set1_epi16((KYBER_Q - 1)/2);
   const __m256i hhq = _mm256_set1_epi16((KYBER_Q - 1)/4);
@@ -271,6 +384,78 @@ void poly_tomsg(uint8_t msg[KYBER_INDCPA_MSGBYTES], const poly * restrict a)
     small = _mm256_movemask_epi8(f0);
     memcpy(&msg[4*i], &small, 4);
   }
+#endif
+}
+
+/*************************************************
+* Name:        poly_tomsg_margin
+*
+* Description: Convert polynomial to 32-byte message like poly_tomsg, and
+*              compute the noise margin: the smallest distance of a
+*              coefficient from the decision boundary of its bit, in steps
+*              the coefficient can move before the bit flips. It is at
+*              most (q-1)/4 and is 0 for coefficients next to a boundary.
+*
+* Arguments:   - uint8_t *msg: pointer to output message
+*              - poly *a: pointer to input polynomial, reduced as for
+*                         poly_tomsg
+*
+* Returns the noise margin
+**************************************************/
+unsigned int poly_tomsg_margin(uint8_t msg[KYBER_INDCPA_MSGBYTES], const poly * restrict a)
+{
+  unsigned int i;
+  uint32_t small;
+  __m256i t;
+  __m128i u;
+#ifdef KYBER_AVX512
+  __m512i f, g, m = _mm512_set1_epi16(-1);
+  const __m512i hq = _mm512_set1_epi16((KYBER_Q - 1)/2);
+  const __m512i hhq = _mm512_set1_epi16((KYBER_Q - 1)/4);
+
+  for(i=0;i<KYBER_N/32;i++) {
+    f = _mm512_loadu_si512(&a->vec[2*i]);
+    f = _mm512_sub_epi16(hq, f);
+    g = _mm512_srai_epi16(f, 15);
+    f = _mm512_xor_si512(f, g);
+    f = _mm512_sub_epi16(f, hhq);
+    small = _mm512_movepi16_mask(f);
+    memcpy(&msg[4*i], &small, 4);
+    // distance in [0,(q-1)/4] on either side of the boundary
+    g = _mm512_srai_epi16(f, 15);
+    m = _mm512_min_epu16(m, _mm512_xor_si512(f, g));
+  }
+  t = _mm256_min_epu16(_mm512_castsi512_si256(m), _mm512_extracti64x4_epi64(m, 1));
+#else
+  __m256i f0, f1, g0, g1;
+  const __m256i hq = _mm256_set1_epi16((KYBER_Q - 1)/2);
+  const __m256i hhq = _mm256_set1_epi16((KYBER_Q - 1)/4);
+
+  t = _mm256_set1_epi16(-1);
+  for(i=0;i<KYBER_N/32;i++) {
+    f0 = _mm256_load_si256(&a->vec[2*i+0]);
+    f1 = _mm256_load_si256(&a->vec[2*i+1]);
+    f0 = _mm256_sub_epi16(hq, f0);
+    f1 = _mm256_sub_epi16(hq, f1);
+    g0 = _mm256_srai_epi16(f0, 15);
+    g1 = _mm256_srai_epi16(f1, 15);
+    f0 = _mm256_xor_si256(f0, g0);
+    f1 = _mm256_xor_si256(f1, g1);
+    f0 = _mm256_sub_epi16(f0, hhq);
+    f1 = _mm256_sub_epi16(f1, hhq);
+    // distance in [0,(q-1)/4] on either side of the boundary
+    g0 = _mm256_srai_epi16(f0, 15);
+    g1 = _mm256_srai_epi16(f1, 15);
+    t = _mm256_min_epu16(t, _mm256_xor_si256(f0, g0));
+    t = _mm256_min_epu16(t, _mm256_xor_si256(f1, g1));
+    f0 = _mm256_packs_epi16(f0, f1);
+    f0 = _mm256_permute4x64_epi64(f0, 0xD8);
+    small = _mm256_movemask_epi8(f0);
+    memcpy(&msg[4*i], &small, 4);
+  }
+#endif
+  u = _mm_min_epu16(_mm256_castsi256_si128(t), _mm256_extracti128_si256(t, 1));
+  return _mm_cvtsi128_si32(_mm_minpos_epu16(u)) & 0xFFFF;
 }
 
 /*************************************************
@@ -382,6 +567,139 @@ void poly_getnoise_eta1122_4x(poly *r0,
   poly_cbd_eta2(r3, buf[3].vec);
 }
 #endif
+
+static void getnoise_4x_seeds(poly *r[4],
+                              const uint8_t *seed[4],
+                              const uint8_t nonce[4],
+                              void (*cbd)(poly *, const __m256i *))
+{
+  unsigned int j;
+  ALIGNED_UINT8(NOISE_NBLOCKS*SHAKE256_RATE) buf[4];
+  keccakx4_state state;
+
+  for(j=0;j<4;j++) {
+    _mm256_store_si256(buf[j].vec, _mm256_loadu_si256((const __m256i *)seed[j]));
+    buf[j].coeffs[32] = nonce[j];
+  }
+
+  shake256x4_absorb_once(&state, buf[0].coeffs, buf[1].coeffs, buf[2].coeffs, buf[3].coeffs, 33);
+  shake256x4_squeezeblocks(buf[0].coeffs, buf[1].coeffs, buf[2].coeffs, buf[3].coeffs, NOISE_NBLOCKS, &state);
+
+  for(j=0;j<4;j++)
+    cbd(r[j], buf[j].vec);
+}
+
+/*************************************************
+* Name:        poly_getnoise_eta1_4x_seeds
+*
+* Description: Sample four polynomials with one run of keccakx4, each from
+*              its own seed, as poly_getnoise_eta1(r[j], seed[j], nonce[j])
+*              for j = 0, ..., 3
+*
+* Arguments:   - poly **r: array of four pointers to output polynomials
+*              - const uint8_t **seed: array of four pointers to input seeds
+*                                      (of length KYBER_SYMBYTES bytes)
+*              - const uint8_t *nonce: array of four nonces
+**************************************************/
+void poly_getnoise_eta1_4x_seeds(poly *r[4], const uint8_t *seed[4], const uint8_t nonce[4])
+{
+  getnoise_4x_seeds(r, seed, nonce, poly_cbd_eta1);
+}
+
+/*************************************************
+* Name:        poly_getnoise_eta2_4x_seeds
+*
+* Description: Sample four polynomials with one run of keccakx4, each from
+*              its own seed, as poly_getnoise_eta2(r[j], seed[j], nonce[j])
+*              for j = 0, ..., 3
+*
+* Arguments:   - poly **r: array of four pointers to output polynomials
+*              - const uint8_t **seed: array of four pointers to input seeds
+*                                      (of length KYBER_SYMBYTES bytes)
+*              - const uint8_t *nonce: array of four nonces
+**************************************************/
+void poly_getnoise_eta2_4x_seeds(poly *r[4], const uint8_t *seed[4], const uint8_t nonce[4])
+{
+  getnoise_4x_seeds(r, seed, nonce, poly_cbd_eta2);
+}
+
+#ifdef KECCAK_X8
+static void getnoise_8x_seeds(poly *r[8],
+                              const uint8_t *seed[8],
+                              const uint8_t nonce[8],
+                              void (*cbd)(poly *, const __m256i *))
+{
+  unsigned int j;
+  ALIGNED_UINT8(NOISE_NBLOCKS*SHAKE256_RATE) buf[8];
+  const uint8_t *in[8];
+  uint8_t *out[8];
+  keccakx8_state state;
+
+  for(j=0;j<8;j++) {
+    _mm256_store_si256(buf[j].vec, _mm256_loadu_si256((const __m256i *)seed[j]));
+    buf[j].coeffs[32] = nonce[j];
+    in[j] = out[j] = buf[j].coeffs;
+  }
+
+  shake256x8_absorb_once(&state, in, 33);
+  shake256x8_squeezeblocks(out, NOISE_NBLOCKS, &state);
+
+  for(j=0;j<8;j++)
+    cbd(r[j], buf[j].vec);
+}
+
+/*************************************************
+* Name:        poly_getnoise_eta1_8x_seeds
+*
+* Description: Sample eight polynomials with one run of keccakx8, each from
+*              its own seed, as poly_getnoise_eta1(r[j], seed[j], nonce[j])
+*              for j = 0, ..., 7
+*
+* Arguments:   - poly **r: array of eight pointers to output polynomials
+*              - const uint8_t **seed: array of eight pointers to input seeds
+*                                      (of length KYBER_SYMBYTES bytes)
+*              - const uint8_t *nonce: array of eight nonces
+**************************************************/
+void poly_getnoise_eta1_8x_seeds(poly *r[8], const uint8_t *seed[8], const uint8_t nonce[8])
+{
+  getnoise_8x_seeds(r, seed, nonce, poly_cbd_eta1);
+}
+
+/*************************************************
+* Name:        poly_getnoise_eta2_8x_seeds
+*
+* Description: Sample eight polynomials with one run of keccakx8, each from
+*              its own seed, as poly_getnoise_eta2(r[j], seed[j], nonce[j])
+*              for j = 0, ..., 7
+*
+* Arguments:   - poly **r: array of eight pointers to output polynomials
+*              - const uint8_t **seed: array of eight pointers to input seeds
+*                                      (of length KYBER_SYMBYTES bytes)
+*              - const uint8_t *nonce: array of eight nonces
+**************************************************/
+void poly_getnoise_eta2_8x_seeds(poly *r[8], const uint8_t *seed[8], const uint8_t nonce[8])
+{
+  getnoise_8x_seeds(r, seed, nonce, poly_cbd_eta2);
+}
+
+/*************************************************
+* Name:        poly_getnoise_eta1_8x
+*
+* Description: Sample eight polynomials with one run of keccakx8, as
+*              poly_getnoise_eta1(r[j], seed, nonce[j]) for j = 0, ..., 7
+*
+* Arguments:   - poly **r: array of eight pointers to output polynomials
+*              - const uint8_t *seed: pointer to input seed
+*                                     (of length KYBER_SYMBYTES bytes)
+*              - const uint8_t *nonce: array of eight nonces
+**************************************************/
+void poly_getnoise_eta1_8x(poly *r[8], const uint8_t seed[32], const uint8_t nonce[8])
+{
+  const uint8_t *s[8] = {seed, seed, seed, seed, seed, seed, seed, seed};
+
+  poly_getnoise_eta1_8x_seeds(r, s, nonce);
+}
+#endif
 #endif
 
 /*************************************************
@@ -399,7 +717,39 @@ void poly_getnoise_eta1122_4x(poly *r0,
 **************************************************/
 void poly_ntt(poly *r)
 {
+#ifdef KYBER_AVX512
+  ntt_avx512(r->vec, qdata.vec);
+#else
   ntt_avx(r->vec, qdata.vec);
+#endif
+}
+
+/*************************************************
+* Name:        poly_ntt_batch
+*
+* Description: Computes the forward NTT of n consecutive polynomials in place.
+*              The next polynomial is prefetched while the current one is
+*              transformed, so that long batches (e.g. the noise columns of a
+*              satoPRE re-key) run from L1. Input and output bounds are as
+*              for poly_ntt().
+*
+* Arguments:   - poly *r: pointer to array of n in/output polynomials
+*              - unsigned int n: number of polynomials
+**************************************************/
+void poly_ntt_batch(poly *r, unsigned int n)
+{
+  unsigned int i, j;
+
+  for(i=0;i<n;i++) {
+    if(i+1 < n)
+      for(j=0;j<KYBER_N/32;j++)
+        _mm_prefetch((const char *)&r[i+1].coeffs[32*j], _MM_HINT_T0);
+#ifdef KYBER_AVX512
+    ntt_avx512(r[i].vec, qdata.vec);
+#else
+    ntt_avx(r[i].vec, qdata.vec);
+#endif
+  }
 }
 
 /*************************************************
@@ -416,7 +766,11 @@ void poly_ntt(poly *r)
 **************************************************/
 void poly_invntt_tomont(poly *r)
 {
+#ifdef KYBER_AVX512
+  invntt_avx512(r->vec, qdata.vec);
+#else
   invntt_avx(r->vec, qdata.vec);
+#endif
 }
 
 void poly_nttunpack(poly *r)
@@ -438,7 +792,11 @@ void poly_nttunpack(poly *r)
 **************************************************/
 void poly_basemul_montgomery(poly *r, const poly *a, const poly *b)
 {
+#ifdef KYBER_AVX512
+  basemul_avx512(r->vec, a->vec, b->vec, qdata.vec);
+#else
   basemul_avx(r->vec, a->vec, b->vec, qdata.vec);
+#endif
 }
 
 /*************************************************
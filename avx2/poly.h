@@ -4,6 +4,7 @@
 #include <stdint.h>
 #include "align.h"
 #include "params.h"
+#include "fips202x8.h"
 
 typedef ALIGNED_INT16(KYBER_N) poly;
 
@@ -11,6 +12,10 @@ typedef ALIGNED_INT16(KYBER_N) poly;
 void poly_compress(uint8_t r[KYBER_POLYCOMPRESSEDBYTES], const poly *a);
 #define poly_decompress KYBER_NAMESPACE(poly_decompress)
 void poly_decompress(poly *r, const uint8_t a[KYBER_POLYCOMPRESSEDBYTES]);
+#define poly_compress_bits KYBER_NAMESPACE(poly_compress_bits)
+void poly_compress_bits(uint8_t *r, const poly *a, unsigned int d);
+#define poly_decompress_bits KYBER_NAMESPACE(poly_decompress_bits)
+void poly_decompress_bits(poly *r, const uint8_t *a, unsigned int d);
 
 #define poly_tobytes KYBER_NAMESPACE(poly_tobytes)
 void poly_tobytes(uint8_t r[KYBER_POLYBYTES], const poly *a);
@@ -21,6 +26,8 @@ void poly_frombytes(poly *r, const uint8_t a[KYBER_POLYBYTES]);
 void poly_frommsg(poly *r, const uint8_t msg[KYBER_INDCPA_MSGBYTES]);
 #define poly_tomsg KYBER_NAMESPACE(poly_tomsg)
 void poly_tomsg(uint8_t msg[KYBER_INDCPA_MSGBYTES], const poly *r);
+#define poly_tomsg_margin KYBER_NAMESPACE(poly_tomsg_margin)
+unsigned int poly_tomsg_margin(uint8_t msg[KYBER_INDCPA_MSGBYTES], const poly *r);
 
 #define poly_getnoise_eta1 KYBER_NAMESPACE(poly_getnoise_eta1)
 void poly_getnoise_eta1(poly *r, const uint8_t seed[KYBER_SYMBYTES], uint8_t nonce);
@@ -52,11 +59,30 @@ void poly_getnoise_eta1122_4x(poly *r0,
                               uint8_t nonce2,
                               uint8_t nonce3);
 #endif
+
+#define poly_getnoise_eta1_4x_seeds KYBER_NAMESPACE(poly_getnoise_eta1_4x_seeds)
+void poly_getnoise_eta1_4x_seeds(poly *r[4], const uint8_t *seed[4], const uint8_t nonce[4]);
+
+#define poly_getnoise_eta2_4x_seeds KYBER_NAMESPACE(poly_getnoise_eta2_4x_seeds)
+void poly_getnoise_eta2_4x_seeds(poly *r[4], const uint8_t *seed[4], const uint8_t nonce[4]);
+
+#ifdef KECCAK_X8
+#define poly_getnoise_eta1_8x_seeds KYBER_NAMESPACE(poly_getnoise_eta1_8x_seeds)
+void poly_getnoise_eta1_8x_seeds(poly *r[8], const uint8_t *seed[8], const uint8_t nonce[8]);
+
+#define poly_getnoise_eta2_8x_seeds KYBER_NAMESPACE(poly_getnoise_eta2_8x_seeds)
+void poly_getnoise_eta2_8x_seeds(poly *r[8], const uint8_t *seed[8], const uint8_t nonce[8]);
+
+#define poly_getnoise_eta1_8x KYBER_NAMESPACE(poly_getnoise_eta1_8x)
+void poly_getnoise_eta1_8x(poly *r[8], const uint8_t seed[32], const uint8_t nonce[8]);
+#endif
 #endif
 
 
 #define poly_ntt KYBER_NAMESPACE(poly_ntt)
 void poly_ntt(poly *r);
+#define poly_ntt_batch KYBER_NAMESPACE(poly_ntt_batch)
+void poly_ntt_batch(poly *r, unsigned int n);
 #define poly_invntt_tomont KYBER_NAMESPACE(poly_invntt_tomont)
 void poly_invntt_tomont(poly *r);
 #define poly_nttunpack KYBER_NAMESPACE(poly_nttunpack)
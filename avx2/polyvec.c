@@ -8,7 +8,7 @@
 #include "consts.h"
 
 #if (KYBER_POLYVECCOMPRESSEDBYTES == (KYBER_K * 320))
-static void poly_compress10(uint8_t r[320], const poly * restrict a)
+void poly_compress10_avx2(uint8_t r[320], const poly * restrict a)
 {
   unsigned int i;
   __m256i f0, f1, f2;
@@ -47,6 +47,45 @@ static void poly_compress10(uint8_t r[320], const poly * restrict a)
   }
 }
 
+#ifdef KYBER_AVX512_VBMI
+void poly_compress10_avx512(uint8_t r[320], const poly * restrict a)
+{
+  unsigned int i;
+  __m512i f0, f1, f2;
+  const __m512i v = _mm512_broadcast_i64x4(_mm256_load_si256(&qdata.vec[_16XV/16]));
+  const __m512i v8 = _mm512_slli_epi16(v,3);
+  const __m512i off = _mm512_set1_epi16(15);
+  const __m512i shift1 = _mm512_set1_epi16(1 << 12);
+  const __m512i mask = _mm512_set1_epi16(1023);
+  const __m512i shift2 = _mm512_set1_epi64((1024LL << 48) + (1LL << 32) + (1024 << 16) + 1);
+  const __m512i sllvdidx = _mm512_set1_epi64(12);
+  // low five bytes of every qword
+  const __m512i permbidx = _mm512_set_epi8( 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+                                            0, 0, 0, 0, 0, 0, 0, 0,60,59,58,57,56,52,51,50,
+                                           49,48,44,43,42,41,40,36,35,34,33,32,28,27,26,25,
+                                           24,20,19,18,17,16,12,11,10, 9, 8, 4, 3, 2, 1, 0);
+
+  for(i=0;i<KYBER_N/32;i++) {
+    f0 = _mm512_loadu_si512((__m512i *)&a->vec[2*i]);
+    f1 = _mm512_mullo_epi16(f0,v8);
+    f2 = _mm512_add_epi16(f0,off);
+    f0 = _mm512_slli_epi16(f0,3);
+    f0 = _mm512_mulhi_epi16(f0,v);
+    f2 = _mm512_sub_epi16(f1,f2);
+    f1 = _mm512_andnot_si512(f1,f2);
+    f1 = _mm512_srli_epi16(f1,15);
+    f0 = _mm512_sub_epi16(f0,f1);
+    f0 = _mm512_mulhrs_epi16(f0,shift1);
+    f0 = _mm512_and_si512(f0,mask);
+    f0 = _mm512_madd_epi16(f0,shift2);
+    f0 = _mm512_sllv_epi32(f0,sllvdidx);
+    f0 = _mm512_srli_epi64(f0,12);
+    f0 = _mm512_permutexvar_epi8(permbidx,f0);
+    _mm512_mask_storeu_epi8(&r[40*i],0xFFFFFFFFFF,f0);
+  }
+}
+#endif
+
 static void poly_decompress10(poly * restrict r, const uint8_t a[320+12])
 {
   unsigned int i;
@@ -72,7 +111,7 @@ static void poly_decompress10(poly * restrict r, const uint8_t a[320+12])
 }
 
 #elif (KYBER_POLYVECCOMPRESSEDBYTES == (KYBER_K * 352))
-static void poly_compress11(uint8_t r[352+2], const poly * restrict a)
+void poly_compress11_avx2(uint8_t r[352+2], const poly * restrict a)
 {
   unsigned int i;
   __m256i f0, f1, f2;
@@ -115,6 +154,49 @@ static void poly_compress11(uint8_t r[352+2], const poly * restrict a)
   }
 }
 
+#ifdef KYBER_AVX512_VBMI
+void poly_compress11_avx512(uint8_t r[352+2], const poly * restrict a)
+{
+  unsigned int i;
+  __m512i f0, f1, f2;
+  const __m512i v = _mm512_broadcast_i64x4(_mm256_load_si256(&qdata.vec[_16XV/16]));
+  const __m512i v8 = _mm512_slli_epi16(v,3);
+  const __m512i off = _mm512_set1_epi16(36);
+  const __m512i shift1 = _mm512_set1_epi16(1 << 13);
+  const __m512i mask = _mm512_set1_epi16(2047);
+  const __m512i shift2 = _mm512_set1_epi64((2048LL << 48) + (1LL << 32) + (2048 << 16) + 1);
+  const __m512i sllvdidx = _mm512_set1_epi64(10);
+  const __m512i srlvqidx = _mm512_set_epi64(30,10,30,10,30,10,30,10);
+  // low eleven bytes of every 128-bit lane
+  const __m512i permbidx = _mm512_set_epi8( 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+                                            0, 0, 0, 0,58,57,56,55,54,53,52,51,50,49,48,42,
+                                           41,40,39,38,37,36,35,34,33,32,26,25,24,23,22,21,
+                                           20,19,18,17,16,10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0);
+
+  for(i=0;i<KYBER_N/32;i++) {
+    f0 = _mm512_loadu_si512((__m512i *)&a->vec[2*i]);
+    f1 = _mm512_mullo_epi16(f0,v8);
+    f2 = _mm512_add_epi16(f0,off);
+    f0 = _mm512_slli_epi16(f0,3);
+    f0 = _mm512_mulhi_epi16(f0,v);
+    f2 = _mm512_sub_epi16(f1,f2);
+    f1 = _mm512_andnot_si512(f1,f2);
+    f1 = _mm512_srli_epi16(f1,15);
+    f0 = _mm512_sub_epi16(f0,f1);
+    f0 = _mm512_mulhrs_epi16(f0,shift1);
+    f0 = _mm512_and_si512(f0,mask);
+    f0 = _mm512_madd_epi16(f0,shift2);
+    f0 = _mm512_sllv_epi32(f0,sllvdidx);
+    f1 = _mm512_bsrli_epi128(f0,8);
+    f0 = _mm512_srlv_epi64(f0,srlvqidx);
+    f1 = _mm512_slli_epi64(f1,34);
+    f0 = _mm512_add_epi64(f0,f1);
+    f0 = _mm512_permutexvar_epi8(permbidx,f0);
+    _mm512_mask_storeu_epi8(&r[44*i],0xFFFFFFFFFFF,f0);
+  }
+}
+#endif
+
 static void poly_decompress11(poly * restrict r, const uint8_t a[352+10])
 {
   unsigned int i;
@@ -158,12 +240,18 @@ void polyvec_compress(uint8_t r[KYBER_POLYVECCOMPRESSEDBYTES+2], const polyvec *
 {
   unsigned int i;
 
-#if (KYBER_POLYVECCOMPRESSEDBYTES == (KYBER_K * 320))
+#if (KYBER_POLYVECCOMPRESSEDBYTES == (KYBER_K * 320)) && defined(KYBER_AVX512_VBMI)
   for(i=0;i<KYBER_K;i++)
-    poly_compress10(&r[320*i],&a->vec[i]);
+    poly_compress10_avx512(&r[320*i],&a->vec[i]);
+#elif (KYBER_POLYVECCOMPRESSEDBYTES == (KYBER_K * 320))
+  for(i=0;i<KYBER_K;i++)
+    poly_compress10_avx2(&r[320*i],&a->vec[i]);
+#elif (KYBER_POLYVECCOMPRESSEDBYTES == (KYBER_K * 352)) && defined(KYBER_AVX512_VBMI)
+  for(i=0;i<KYBER_K;i++)
+    poly_compress11_avx512(&r[352*i],&a->vec[i]);
 #elif (KYBER_POLYVECCOMPRESSEDBYTES == (KYBER_K * 352))
   for(i=0;i<KYBER_K;i++)
-    poly_compress11(&r[352*i],&a->vec[i]);
+    poly_compress11_avx2(&r[352*i],&a->vec[i]);
 #endif
 }
 
@@ -232,9 +320,7 @@ void polyvec_frombytes(polyvec *r, const uint8_t a[KYBER_POLYVECBYTES])
 **************************************************/
 void polyvec_ntt(polyvec *r)
 {
-  unsigned int i;
-  for(i=0;i<KYBER_K;i++)
-    poly_ntt(&r->vec[i]);
+  poly_ntt_batch(r->vec, KYBER_K);
 }
 
 /*************************************************
@@ -264,6 +350,9 @@ void polyvec_invntt_tomont(polyvec *r)
 **************************************************/
 void polyvec_basemul_acc_montgomery(poly *r, const polyvec *a, const polyvec *b)
 {
+#ifdef KYBER_AVX512
+  basemul_acc_avx512(r->vec, a->vec[0].vec, b->vec[0].vec, KYBER_K, qdata.vec);
+#else
   unsigned int i;
   poly tmp;
 
@@ -272,6 +361,135 @@ void polyvec_basemul_acc_montgomery(poly *r, const polyvec *a, const polyvec *b)
     poly_basemul_montgomery(&tmp,&a->vec[i],&b->vec[i]);
     poly_add(r,r,&tmp);
   }
+#endif
+}
+
+/*************************************************
+* Name:        fqmul
+*
+* Description: Montgomery multiplication of 16 coefficients by b,
+*              given blo = b*q^-1 mod 2^16
+**************************************************/
+static inline __m256i fqmul(__m256i a, __m256i b, __m256i blo, __m256i q)
+{
+  __m256i hi, lo;
+  hi = _mm256_mulhi_epi16(a, b);
+  lo = _mm256_mullo_epi16(a, blo);
+  lo = _mm256_mulhi_epi16(lo, q);
+  return _mm256_sub_epi16(hi, lo);
+}
+
+/*************************************************
+* Name:        montred32
+*
+* Description: Montgomery reduction of 16 signed 32-bit values given as
+*              x0 (pairs 0-3, 8-11) and x1 (pairs 4-7, 12-15), i.e. in the
+*              order produced by madd on unpacklo/unpackhi inputs.
+*              Returns x*2^-16 mod q in natural order.
+**************************************************/
+static inline __m256i montred32(__m256i x0, __m256i x1, __m256i q, __m256i qinv)
+{
+  const __m256i mask = _mm256_set1_epi32(0xFFFF);
+  __m256i lo, hi;
+  lo = _mm256_packus_epi32(_mm256_and_si256(x0, mask), _mm256_and_si256(x1, mask));
+  hi = _mm256_packs_epi32(_mm256_srai_epi32(x0, 16), _mm256_srai_epi32(x1, 16));
+  lo = _mm256_mullo_epi16(lo, qinv);
+  lo = _mm256_mulhi_epi16(lo, q);
+  return _mm256_sub_epi16(hi, lo);
+}
+
+/*************************************************
+* Name:        polyvec_matmul_montgomery
+*
+* Description: Multiply the nrows x KYBER_K matrix a with the KYBER_K x ncols
+*              matrix b in NTT domain, i.e. r[c*nrows+i] = a[i]^T b[c] * 2^-16
+*              for every row i and column c; the result is congruent modulo q
+*              to polyvec_basemul_acc_montgomery(&r[c*nrows+i], &a[i], &b[c]).
+*
+*              The kernel works on one 64-coefficient block at a time. The
+*              block of every entry of a is interleaved into (x_0, x_1) pairs
+*              once and kept in a tile of at most 2.5KB that stays in L1,
+*              while the columns of b are streamed through it. Each column
+*              block is interleaved once (with its zeta multiples) for all
+*              rows, products are accumulated in 32 bits with madd, and each
+*              output is Montgomery-reduced once instead of once per product.
+*
+*              Entries of a must be bounded by q in absolute value, entries
+*              of b by 2^15 (e.g. output of poly_ntt()); output coefficients
+*              are bounded by (KYBER_K+1)*q in absolute value.
+*
+* Arguments: - poly *r: pointer to output polynomials (ncols*nrows)
+*            - const polyvec *a: pointer to rows of the first matrix
+*            - unsigned int nrows: number of rows of a, at most KYBER_K+1
+*            - const polyvec *b: pointer to columns of the second matrix
+*            - unsigned int ncols: number of columns of b
+**************************************************/
+void polyvec_matmul_montgomery(poly *r,
+                               const polyvec *a,
+                               unsigned int nrows,
+                               const polyvec *b,
+                               unsigned int ncols)
+{
+  unsigned int blk, i, j, c, k;
+  __m256i at[KYBER_K+1][KYBER_K][4];
+  __m256i bt[KYBER_K][8];
+  __m256i f0, f1, f2, f3, zl, zh, acc[8];
+  const __m256i q = _mm256_load_si256(&qdata.vec[_16XQ/16]);
+  const __m256i qinv = _mm256_load_si256(&qdata.vec[_16XQINV/16]);
+  static const unsigned int zoff[4] = {176, 208, 400, 432};
+
+  for(blk=0;blk<4;blk++) {
+    zl = _mm256_loadu_si256((const __m256i *)&qdata.coeffs[_ZETAS_EXP+zoff[blk]]);
+    zh = _mm256_loadu_si256((const __m256i *)&qdata.coeffs[_ZETAS_EXP+zoff[blk]+16]);
+
+    for(i=0;i<nrows;i++) {
+      for(j=0;j<KYBER_K;j++) {
+        f0 = _mm256_load_si256(&a[i].vec[j].vec[4*blk+0]);
+        f1 = _mm256_load_si256(&a[i].vec[j].vec[4*blk+1]);
+        f2 = _mm256_load_si256(&a[i].vec[j].vec[4*blk+2]);
+        f3 = _mm256_load_si256(&a[i].vec[j].vec[4*blk+3]);
+        at[i][j][0] = _mm256_unpacklo_epi16(f0, f1);
+        at[i][j][1] = _mm256_unpackhi_epi16(f0, f1);
+        at[i][j][2] = _mm256_unpacklo_epi16(f2, f3);
+        at[i][j][3] = _mm256_unpackhi_epi16(f2, f3);
+      }
+    }
+
+    for(c=0;c<ncols;c++) {
+      /* (a0 + a1 X)(b0 + b1 X) = (a0 b0 + a1 b1 zeta) + (a0 b1 + a1 b0) X,
+         and the same with -zeta for the second half of the block */
+      for(j=0;j<KYBER_K;j++) {
+        f0 = _mm256_load_si256(&b[c].vec[j].vec[4*blk+0]);
+        f1 = _mm256_load_si256(&b[c].vec[j].vec[4*blk+1]);
+        f2 = _mm256_load_si256(&b[c].vec[j].vec[4*blk+2]);
+        f3 = _mm256_load_si256(&b[c].vec[j].vec[4*blk+3]);
+        bt[j][4] = fqmul(f1, zh, zl, q);
+        bt[j][5] = fqmul(f3, zh, zl, q);
+        bt[j][5] = _mm256_sub_epi16(_mm256_setzero_si256(), bt[j][5]);
+        bt[j][0] = _mm256_unpacklo_epi16(f0, bt[j][4]);
+        bt[j][1] = _mm256_unpackhi_epi16(f0, bt[j][4]);
+        bt[j][2] = _mm256_unpacklo_epi16(f2, bt[j][5]);
+        bt[j][3] = _mm256_unpackhi_epi16(f2, bt[j][5]);
+        bt[j][4] = _mm256_unpacklo_epi16(f1, f0);
+        bt[j][5] = _mm256_unpackhi_epi16(f1, f0);
+        bt[j][6] = _mm256_unpacklo_epi16(f3, f2);
+        bt[j][7] = _mm256_unpackhi_epi16(f3, f2);
+      }
+
+      for(i=0;i<nrows;i++) {
+        for(k=0;k<8;k++)
+          acc[k] = _mm256_madd_epi16(at[i][0][k&3], bt[0][k]);
+        for(j=1;j<KYBER_K;j++)
+          for(k=0;k<8;k++)
+            acc[k] = _mm256_add_epi32(acc[k], _mm256_madd_epi16(at[i][j][k&3], bt[j][k]));
+
+        _mm256_store_si256(&r[c*nrows+i].vec[4*blk+0], montred32(acc[0], acc[1], q, qinv));
+        _mm256_store_si256(&r[c*nrows+i].vec[4*blk+1], montred32(acc[4], acc[5], q, qinv));
+        _mm256_store_si256(&r[c*nrows+i].vec[4*blk+2], montred32(acc[2], acc[3], q, qinv));
+        _mm256_store_si256(&r[c*nrows+i].vec[4*blk+3], montred32(acc[6], acc[7], q, qinv));
+      }
+    }
+  }
 }
 
 /*************************************************
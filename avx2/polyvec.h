@@ -4,6 +4,7 @@
 #include <stdint.h>
 #include "params.h"
 #include "poly.h"
+#include "ntt.h"
 
 typedef struct{
   poly vec[KYBER_K];
@@ -14,6 +15,22 @@ void polyvec_compress(uint8_t r[KYBER_POLYVECCOMPRESSEDBYTES+2], const polyvec *
 #define polyvec_decompress KYBER_NAMESPACE(polyvec_decompress)
 void polyvec_decompress(polyvec *r, const uint8_t a[KYBER_POLYVECCOMPRESSEDBYTES+12]);
 
+#if (KYBER_POLYVECCOMPRESSEDBYTES == (KYBER_K * 320))
+#define poly_compress10_avx2 KYBER_NAMESPACE(poly_compress10_avx2)
+void poly_compress10_avx2(uint8_t r[320], const poly *a);
+#ifdef KYBER_AVX512_VBMI
+#define poly_compress10_avx512 KYBER_NAMESPACE(poly_compress10_avx512)
+void poly_compress10_avx512(uint8_t r[320], const poly *a);
+#endif
+#elif (KYBER_POLYVECCOMPRESSEDBYTES == (KYBER_K * 352))
+#define poly_compress11_avx2 KYBER_NAMESPACE(poly_compress11_avx2)
+void poly_compress11_avx2(uint8_t r[352+2], const poly *a);
+#ifdef KYBER_AVX512_VBMI
+#define poly_compress11_avx512 KYBER_NAMESPACE(poly_compress11_avx512)
+void poly_compress11_avx512(uint8_t r[352+2], const poly *a);
+#endif
+#endif
+
 #define polyvec_tobytes KYBER_NAMESPACE(polyvec_tobytes)
 void polyvec_tobytes(uint8_t r[KYBER_POLYVECBYTES], const polyvec *a);
 #define polyvec_frombytes KYBER_NAMESPACE(polyvec_frombytes)
@@ -27,6 +44,13 @@ void polyvec_invntt_tomont(polyvec *r);
 #define polyvec_basemul_acc_montgomery KYBER_NAMESPACE(polyvec_basemul_acc_montgomery)
 void polyvec_basemul_acc_montgomery(poly *r, const polyvec *a, const polyvec *b);
 
+#define polyvec_matmul_montgomery KYBER_NAMESPACE(polyvec_matmul_montgomery)
+void polyvec_matmul_montgomery(poly *r,
+                               const polyvec *a,
+                               unsigned int nrows,
+                               const polyvec *b,
+                               unsigned int ncols);
+
 #define polyvec_reduce KYBER_NAMESPACE(polyvec_reduce)
 void polyvec_reduce(polyvec *r);
 
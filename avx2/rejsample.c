@@ -271,7 +271,7 @@ static const uint8_t idx[256][8] = {
 #define _mm256_cmpge_epu16(a, b) _mm256_cmpeq_epi16(_mm256_max_epu16(a, b), a)
 #define _mm_cmpge_epu16(a, b) _mm_cmpeq_epi16(_mm_max_epu16(a, b), a)
 
-unsigned int rej_uniform_avx(int16_t * restrict r, const uint8_t *buf)
+unsigned int rej_uniform_avx2(int16_t * restrict r, const uint8_t *buf)
 {
   unsigned int ctr, pos;
   uint16_t val0, val1;
@@ -396,3 +396,76 @@ unsigned int rej_uniform_avx(int16_t * restrict r, const uint8_t *buf)
 
   return ctr;
 }
+
+#ifdef KYBER_AVX512_VBMI
+// candidate 2j is bytes 3j, 3j+1 and candidate 2j+1 is bytes 3j+1, 3j+2
+static const uint8_t idx512[64] = {
+   0,  1,  1,  2,  3,  4,  4,  5,  6,  7,  7,  8,  9, 10, 10, 11,
+  12, 13, 13, 14, 15, 16, 16, 17, 18, 19, 19, 20, 21, 22, 22, 23,
+  24, 25, 25, 26, 27, 28, 28, 29, 30, 31, 31, 32, 33, 34, 34, 35,
+  36, 37, 37, 38, 39, 40, 40, 41, 42, 43, 43, 44, 45, 46, 46, 47
+};
+
+/*************************************************
+* Name:        rej_uniform_avx512
+*
+* Description: AVX-512 version of rej_uniform_avx2 with the same output.
+*              Each step unpacks 48 bytes into 32 candidates with one byte
+*              permute and packs the accepted ones with vpcompressw, so
+*              no shuffle table is needed. Loads are masked and never
+*              read past the end of buf.
+*
+* Arguments:   - int16_t *r: pointer to output coefficients
+*              - const uint8_t *buf: pointer to input byte array
+*                                    (of length REJ_UNIFORM_AVX_BUFLEN)
+*
+* Returns number of sampled coefficients, at most KYBER_N
+**************************************************/
+unsigned int rej_uniform_avx512(int16_t * restrict r, const uint8_t *buf)
+{
+  unsigned int ctr, pos, n, cnt;
+  uint32_t good;
+  __m512i f;
+  const __m512i bound = _mm512_set1_epi16(KYBER_Q);
+  const __m512i mask = _mm512_set1_epi16(0xFFF);
+  const __m512i perm = _mm512_loadu_si512((__m512i *)idx512);
+
+  ctr = pos = 0;
+  while(ctr <= KYBER_N - 32 && pos <= REJ_UNIFORM_AVX_BUFLEN - 48) {
+    f = _mm512_maskz_loadu_epi8(0xFFFFFFFFFFFF, &buf[pos]);
+    f = _mm512_permutexvar_epi8(perm, f);
+    f = _mm512_mask_srli_epi16(f, 0xAAAAAAAA, f, 4);
+    f = _mm512_and_si512(f, mask);
+    pos += 48;
+
+    good = _mm512_cmplt_epu16_mask(f, bound);
+    f = _mm512_maskz_compress_epi16(good, f);
+    _mm512_storeu_si512((__m512i *)&r[ctr], f);
+    ctr += _mm_popcnt_u32(good);
+  }
+
+  // last, possibly partial steps, never writing past r[KYBER_N-1]
+  while(ctr < KYBER_N && pos <= REJ_UNIFORM_AVX_BUFLEN - 3) {
+    n = REJ_UNIFORM_AVX_BUFLEN - pos;
+    n = (n < 48) ? n - n%3 : 48;
+    f = _mm512_maskz_loadu_epi8(_bzhi_u64(-1ULL, n), &buf[pos]);
+    f = _mm512_permutexvar_epi8(perm, f);
+    f = _mm512_mask_srli_epi16(f, 0xAAAAAAAA, f, 4);
+    f = _mm512_and_si512(f, mask);
+    pos += n;
+
+    good = _mm512_cmplt_epu16_mask(f, bound);
+    good = _bzhi_u32(good, 2*n/3);
+    cnt = _mm_popcnt_u32(good);
+    if(cnt > KYBER_N - ctr) {
+      good = _pdep_u32((1U << (KYBER_N - ctr)) - 1, good);
+      cnt = KYBER_N - ctr;
+    }
+    f = _mm512_maskz_compress_epi16(good, f);
+    _mm512_mask_storeu_epi16(&r[ctr], _bzhi_u32(-1U, cnt), f);
+    ctr += cnt;
+  }
+
+  return ctr;
+}
+#endif
@@ -4,11 +4,21 @@
 #include <stdint.h>
 #include "params.h"
 #include "symmetric.h"
+#include "ntt.h"
 
 #define REJ_UNIFORM_AVX_NBLOCKS ((12*KYBER_N/8*(1 << 12)/KYBER_Q + XOF_BLOCKBYTES)/XOF_BLOCKBYTES)
 #define REJ_UNIFORM_AVX_BUFLEN (REJ_UNIFORM_AVX_NBLOCKS*XOF_BLOCKBYTES)
 
-#define rej_uniform_avx KYBER_NAMESPACE(rej_uniform_avx)
-unsigned int rej_uniform_avx(int16_t *r, const uint8_t *buf);
+#define rej_uniform_avx2 KYBER_NAMESPACE(rej_uniform_avx2)
+unsigned int rej_uniform_avx2(int16_t *r, const uint8_t *buf);
+
+#ifdef KYBER_AVX512_VBMI
+#define rej_uniform_avx512 KYBER_NAMESPACE(rej_uniform_avx512)
+unsigned int rej_uniform_avx512(int16_t *r, const uint8_t *buf);
+
+#define rej_uniform_avx rej_uniform_avx512
+#else
+#define rej_uniform_avx rej_uniform_avx2
+#endif
 
 #endif
@@ -2,6 +2,8 @@
 #include <stdint.h>
 #include <immintrin.h>
 #include <string.h>
+#include <pthread.h>
+#include <stdatomic.h>
 #include "align.h"
 #include "params.h"
 #include "indcpa.h"
@@ -9,63 +11,53 @@
 #include "polyvec.h"
 #include "poly.h"
 #include "ntt.h"
+#include "consts.h"
 #include "cbd.h"
-#include "rejsample.h"
 #include "symmetric.h"
-#include "randombytes.h"
-#include "fips202.h"
 #include "fips202x4.h"
+#include "fips202x8.h"
+#include "telemetry.h"
 
-static const l = 12;
+/*
+ * satoPRE is the CPA-secure lattice PRE used as the baseline for cdPRE.
+ * A user holds two IND-CPA key pairs: (pk1, sk1) for original ciphertexts
+ * and (pk2, sk2) for re-encrypted ones. The re-key from i to j is a
+ * column-wise encryption of the gadget matrix -s_i^T G under sk2_j,
+ *
+ *   U = A_j^T R1 + R2,   w = U^T s_j + r3 - s_i^T G,
+ *
+ * with G = I_k (x) (1, 2, ..., 2^{l-1}). Re-encryption bit-decomposes u_i
+ * into kl binary polynomials d and outputs (U d, v_i + w d), which sk2_j
+ * decrypts to v_i - s_i^T u_i + r3^T d.
+ *
+ * Column c = i*SATOPRE_L + b of the re-key belongs to bit b of u_i[i] and
+ * is stored (in NTT domain) as the k polynomials of U followed by w[c].
+ *
+ * The re-key is a key-switching key and needs j's secret key. Encrypting
+ * under pk2_j instead (w = t_j^T R1 + r3 - s_i^T G) adds e_j^T R1 - s_j^T R2
+ * to every column, and with Kyber's q no gadget keeps the sum of these
+ * times d below q/4: even the binary gadget, which minimizes |d|^2, gives
+ * a standard deviation of about 2300. Multiplying only r3 with the digits
+ * adds about 75 (Kyber512) to 80 (Kyber768, Kyber1024), for a total of
+ * about 115, 120 and 100 with the two compressions of the ciphertext, so
+ * that re-encrypted ciphertexts are about 7 standard deviations away from
+ * a decryption failure.
+ */
 
-static void concatenate_pks(uint8_t combined_pk[2 * KYBER_INDCPA_PUBLICKEYBYTES],
-    const uint8_t pk1[KYBER_INDCPA_PUBLICKEYBYTES],
-    const uint8_t pk2[KYBER_INDCPA_PUBLICKEYBYTES])
-{
-    memcpy(combined_pk, pk1, KYBER_INDCPA_PUBLICKEYBYTES);
-    memcpy(combined_pk + KYBER_INDCPA_PUBLICKEYBYTES, pk2, KYBER_INDCPA_PUBLICKEYBYTES);
-}
-
-static void split_pks(uint8_t pk1[KYBER_INDCPA_PUBLICKEYBYTES],
-    uint8_t pk2[KYBER_INDCPA_PUBLICKEYBYTES],
-    const uint8_t combined_pk[2 * KYBER_INDCPA_PUBLICKEYBYTES])
-{
-    memcpy(pk1, combined_pk, KYBER_INDCPA_PUBLICKEYBYTES);
-    memcpy(pk2, combined_pk + KYBER_INDCPA_PUBLICKEYBYTES, KYBER_INDCPA_PUBLICKEYBYTES);
-}
-
-static void concatenate_sks(uint8_t combined_sk[2 * KYBER_INDCPA_SECRETKEYBYTES],
-    const uint8_t sk1[KYBER_INDCPA_SECRETKEYBYTES],
-    const uint8_t sk2[KYBER_INDCPA_SECRETKEYBYTES])
-{
-    memcpy(combined_sk, sk1, KYBER_INDCPA_SECRETKEYBYTES);
-    memcpy(combined_sk + KYBER_INDCPA_SECRETKEYBYTES, sk2, KYBER_INDCPA_SECRETKEYBYTES);
-}
-
-static void split_sks(uint8_t sk1[KYBER_INDCPA_SECRETKEYBYTES],
-    uint8_t sk2[KYBER_INDCPA_SECRETKEYBYTES],
-    const uint8_t combined_sk[2 * KYBER_INDCPA_SECRETKEYBYTES])
-{
-    memcpy(sk1, combined_sk, KYBER_INDCPA_SECRETEYBYTES);
-    memcpy(sk2, combined_sk + KYBER_INDCPA_SECRETEYBYTES, KYBER_INDCPA_SECRETEYBYTES);
-}
+/* noise polynomials per re-key column: k of R1, k of R2 and one of r3 */
+#define SATOPRE_NOISE_PER_COL (2*KYBER_K+1)
 
 /*************************************************
-* Name:        unpack_pk
+* Name:        unpack_sk
 *
-* Description: De-serialize public key from a byte array;
-*              approximate inverse of pack_pk
+* Description: De-serialize the secret key; inverse of pack_sk
 *
-* Arguments:   - polyvec *pk: pointer to output public-key polynomial vector
-*              - uint8_t *seed: pointer to output seed to generate matrix A
-*              - const uint8_t *packedpk: pointer to input serialized public key
+* Arguments:   - polyvec *sk: pointer to output vector of polynomials (secret key)
+*              - const uint8_t *packedsk: pointer to input serialized secret key
 **************************************************/
-static void unpack_pk(polyvec *pk,
-                      uint8_t seed[KYBER_SYMBYTES],
-                      const uint8_t packedpk[KYBER_INDCPA_PUBLICKEYBYTES])
+static void unpack_sk(polyvec *sk, const uint8_t packedsk[KYBER_INDCPA_SECRETKEYBYTES])
 {
-    polyvec_frombytes(pk, packedpk);
-    memcpy(seed, packedpk + KYBER_POLYVECBYTES, KYBER_SYMBYTES);
+  polyvec_frombytes(sk, packedsk);
 }
 
 /*************************************************
@@ -84,8 +76,8 @@ static void unpack_pk(polyvec *pk,
 **************************************************/
 static void pack_ciphertext(uint8_t r[KYBER_INDCPA_BYTES], polyvec *b, poly *v)
 {
-    polyvec_compress(r, b);
-    poly_compress(r + KYBER_POLYVECCOMPRESSEDBYTES, v);
+  polyvec_compress(r, b);
+  poly_compress(r+KYBER_POLYVECCOMPRESSEDBYTES, v);
 }
 
 /*************************************************
@@ -100,117 +92,805 @@ static void pack_ciphertext(uint8_t r[KYBER_INDCPA_BYTES], polyvec *b, poly *v)
 **************************************************/
 static void unpack_ciphertext(polyvec *b, poly *v, const uint8_t c[KYBER_INDCPA_BYTES])
 {
-    polyvec_decompress(b, c);
-    poly_decompress(v, c + KYBER_POLYVECCOMPRESSEDBYTES);
+  polyvec_decompress(b, c);
+  poly_decompress(v, c+KYBER_POLYVECCOMPRESSEDBYTES);
 }
 
 #define gen_a(A,B)  gen_matrix(A,B,0)
 #define gen_at(A,B) gen_matrix(A,B,1)
 
 /*************************************************
-* Name:        generate_noise_matrix
-*
-* Description: Generate a noise matrix with the specified noise generation function
-*
-* Arguments:   - polyvec R[KYBER_K][l]: output noise matrix
-*              - const uint8_t noiseseed[KYBER_SYMBYTES]: input noise seed
-*              - void (*noise_func_4x)(poly *r0, poly *r1, poly *r2, poly *r3, const uint8_t *seed, uint8_t nonce0, uint8_t nonce1, uint8_t nonce2, uint8_t nonce3): noise generation function
-*              - void (*noise_func)(poly *r, const uint8_t *seed, uint8_t nonce)
-**************************************************/
-static void generate_noise_matrix(polyvec R[KYBER_K][l], const uint8_t noiseseed[KYBER_SYMBYTES],
-                                  void (*noise_func_4x)(poly *r0, poly *r1, poly *r2, poly *r3, const uint8_t *seed, uint8_t nonce0, uint8_t nonce1, uint8_t nonce2, uint8_t nonce3),
-                                  void (*noise_func)(poly *r, const uint8_t *seed, uint8_t nonce))
-{
-    unsigned int j, k;
-    uint8_t nonce = 0;
-
-    if (KYBER_K == 2) {
-        for (j = 0; j < l; j += 1) {
-            noise_func_4x(R[0][j].vec + 0, R[0][j].vec + 1, R[1][j].vec + 0, R[1][j].vec + 1, noiseseed, nonce++, nonce++, nonce++, nonce++);
-        }
-    } else if (KYBER_K == 3) {
-        for (j = 0; j < l; j += 1) {
-            noise_func_4x(R[0][j].vec + 0, R[0][j].vec + 1, R[0][j].vec + 2, R[1][j].vec + 0, noiseseed, nonce++, nonce++, nonce++, nonce++);
-            noise_func_4x(R[1][j].vec + 1, R[1][j].vec + 2, R[2][j].vec + 0, R[2][j].vec + 1, noiseseed, nonce++, nonce++, nonce++, nonce++);
-            noise_func(R[2][j].vec + 2, noiseseed, nonce++);
-        }
-    } else if (KYBER_K == 4) {
-        for (j = 0; j < KYBER_K * l; j += 1) {
-            for (k = 0; k < KYBER_K; k++) {
-                noise_func_4x(R[k][j].vec + 0, R[k][j].vec + 1, R[k][j].vec + 2, R[k][j].vec + 3, noiseseed, nonce++, nonce++, nonce++, nonce++);
-            }
-        }
+* Name:        getnoise_4x
+*
+* Description: Sample four polynomials from SHAKE256(seed || nonce) with
+*              a 16-bit little-endian nonce per lane, so that all
+*              (2k+1)kl noise polynomials of a re-key get distinct nonces.
+*              Lanes with eta1[j] != 0 are sampled with KYBER_ETA1, the
+*              others with KYBER_ETA2.
+*
+* Arguments:   - poly **r: array of four pointers to output polynomials
+*              - const uint8_t *seed: pointer to input seed
+*                                     (of length KYBER_SYMBYTES bytes)
+*              - const uint16_t *nonce: array of four nonces
+*              - const int *eta1: array of four distribution selectors
+**************************************************/
+#define NOISE_NBLOCKS ((KYBER_ETA1*KYBER_N/4+SHAKE256_RATE-1)/SHAKE256_RATE)
+static void getnoise_4x(poly *r[4],
+                        const uint8_t seed[KYBER_SYMBYTES],
+                        const uint16_t nonce[4],
+                        const int eta1[4])
+{
+  unsigned int j;
+  ALIGNED_UINT8(NOISE_NBLOCKS*SHAKE256_RATE) buf[4];
+  __m256i f;
+  keccakx4_state state;
+
+  f = _mm256_loadu_si256((__m256i *)seed);
+  for(j=0;j<4;j++) {
+    _mm256_store_si256(buf[j].vec, f);
+    buf[j].coeffs[32] = nonce[j] & 0xFF;
+    buf[j].coeffs[33] = nonce[j] >> 8;
+  }
+
+  shake256x4_absorb_once(&state, buf[0].coeffs, buf[1].coeffs, buf[2].coeffs, buf[3].coeffs, 34);
+  shake256x4_squeezeblocks(buf[0].coeffs, buf[1].coeffs, buf[2].coeffs, buf[3].coeffs, NOISE_NBLOCKS, &state);
+
+  for(j=0;j<4;j++) {
+    if(eta1[j])
+      poly_cbd_eta1(r[j], buf[j].vec);
+    else
+      poly_cbd_eta2(r[j], buf[j].vec);
+  }
+}
+
+#ifdef KECCAK_X8
+/*************************************************
+* Name:        getnoise_8x
+*
+* Description: getnoise_4x on eight lanes with one run of keccakx8
+*
+* Arguments:   - poly **r: array of eight pointers to output polynomials
+*              - const uint8_t *seed: pointer to input seed
+*                                     (of length KYBER_SYMBYTES bytes)
+*              - const uint16_t *nonce: array of eight nonces
+*              - const int *eta1: array of eight distribution selectors
+**************************************************/
+static void getnoise_8x(poly *r[8],
+                        const uint8_t seed[KYBER_SYMBYTES],
+                        const uint16_t nonce[8],
+                        const int eta1[8])
+{
+  unsigned int j;
+  ALIGNED_UINT8(NOISE_NBLOCKS*SHAKE256_RATE) buf[8];
+  const uint8_t *in[8];
+  uint8_t *out[8];
+  __m256i f;
+  keccakx8_state state;
+
+  f = _mm256_loadu_si256((__m256i *)seed);
+  for(j=0;j<8;j++) {
+    _mm256_store_si256(buf[j].vec, f);
+    buf[j].coeffs[32] = nonce[j] & 0xFF;
+    buf[j].coeffs[33] = nonce[j] >> 8;
+    in[j] = out[j] = buf[j].coeffs;
+  }
+
+  shake256x8_absorb_once(&state, in, 34);
+  shake256x8_squeezeblocks(out, NOISE_NBLOCKS, &state);
+
+  for(j=0;j<8;j++) {
+    if(eta1[j])
+      poly_cbd_eta1(r[j], buf[j].vec);
+    else
+      poly_cbd_eta2(r[j], buf[j].vec);
+  }
+}
+#define NOISE_LANES 8
+#else
+#define NOISE_LANES 4
+#endif
+
+/*************************************************
+* Name:        gen_noise_block
+*
+* Description: Sample the noise of SATOPRE_BLOCK consecutive re-key columns:
+*              R1 \gets \beta_{\eta_1}^k, R2 \gets \beta_{\eta_2}^k and
+*              r3 \gets \beta_{\eta_2} per column. Polynomial j of column c
+*              uses nonce c*(2k+1)+j; since SATOPRE_BLOCK*(2k+1) is a
+*              multiple of four, every keccakx4 lane is used. On AVX-512
+*              the polynomials go through keccakx8 and the last four, if
+*              any, through keccakx4.
+*
+* Arguments:   - polyvec *r1: pointer to output R1 columns
+*              - polyvec *r2: pointer to output R2 columns
+*              - poly *r3: pointer to output r3 entries
+*              - const uint8_t *seed: pointer to input noise seed
+*              - unsigned int col: index of the first column of the block
+**************************************************/
+static void gen_noise_block(polyvec r1[SATOPRE_BLOCK],
+                            polyvec r2[SATOPRE_BLOCK],
+                            poly r3[SATOPRE_BLOCK],
+                            const uint8_t seed[KYBER_SYMBYTES],
+                            unsigned int col)
+{
+  unsigned int g, b, j, lane = 0;
+  poly *r[NOISE_LANES];
+  uint16_t nonce[NOISE_LANES];
+  int eta1[NOISE_LANES];
+
+  for(g=0;g<SATOPRE_BLOCK*SATOPRE_NOISE_PER_COL;g++) {
+    b = g / SATOPRE_NOISE_PER_COL;
+    j = g % SATOPRE_NOISE_PER_COL;
+    if(j < KYBER_K)
+      r[lane] = &r1[b].vec[j];
+    else if(j < 2*KYBER_K)
+      r[lane] = &r2[b].vec[j-KYBER_K];
+    else
+      r[lane] = &r3[b];
+    nonce[lane] = (col+b)*SATOPRE_NOISE_PER_COL + j;
+    eta1[lane] = j < KYBER_K;
+
+    if(++lane == NOISE_LANES) {
+#ifdef KECCAK_X8
+      getnoise_8x(r, seed, nonce, eta1);
+#else
+      getnoise_4x(r, seed, nonce, eta1);
+#endif
+      lane = 0;
     }
+  }
+  if(lane)
+    getnoise_4x(r, seed, nonce, eta1);
 }
 
-// generate noise matrix R1 using poly_getnoise_eta1_4x and poly_getnoise_eta1
-static void generate_R1_matrix(polyvec R[KYBER_K][l], const uint8_t noiseseed[KYBER_SYMBYTES])
+/*************************************************
+* Name:        gadget_decompose
+*
+* Description: Binary (gadget) decomposition of a polynomial with
+*              coefficients in [0,q]. Only the bit-planes that are not
+*              identically zero are written, in increasing order of the bit
+*              position; all 16 coefficients of a vector are split with one
+*              shift and one and per plane.
+*
+* Arguments:   - poly *d: pointer to output binary polynomials (up to SATOPRE_L)
+*              - unsigned int *bits: pointer to output bit position of each plane
+*              - const poly *a: pointer to input polynomial
+*
+* Returns number of non-zero bit-planes
+**************************************************/
+static unsigned int gadget_decompose(poly d[SATOPRE_L],
+                                     unsigned int bits[SATOPRE_L],
+                                     const poly *a)
 {
-    generate_noise_matrix(R, noiseseed, poly_getnoise_eta1_4x, poly_getnoise_eta1);
+  unsigned int i, j, n = 0;
+  uint16_t mask;
+  __m256i f, g;
+  __m128i shift[SATOPRE_L];
+  const __m256i one = _mm256_set1_epi16(1);
+
+  g = _mm256_setzero_si256();
+  for(i=0;i<KYBER_N/16;i++)
+    g = _mm256_or_si256(g, _mm256_load_si256(&a->vec[i]));
+  g = _mm256_or_si256(g, _mm256_srli_si256(g, 8));
+  g = _mm256_or_si256(g, _mm256_srli_si256(g, 4));
+  g = _mm256_or_si256(g, _mm256_srli_si256(g, 2));
+  mask = _mm256_extract_epi16(g, 0) | _mm256_extract_epi16(g, 8);
+
+  for(j=0;j<SATOPRE_L;j++) {
+    if((mask >> j) & 1) {
+      bits[n] = j;
+      shift[n++] = _mm_cvtsi32_si128(j);
+    }
+  }
+
+  for(i=0;i<KYBER_N/16;i++) {
+    f = _mm256_load_si256(&a->vec[i]);
+    for(j=0;j<n;j++) {
+      g = _mm256_srl_epi16(f, shift[j]);
+      g = _mm256_and_si256(g, one);
+      _mm256_store_si256(&d[j].vec[i], g);
+    }
+  }
+
+  return n;
 }
 
-// generate noise matrix R2 using poly_getnoise_eta2_4x and poly_getnoise_eta2
-static void generate_R2_matrix(polyvec R[KYBER_K][l], const uint8_t noiseseed[KYBER_SYMBYTES])
+/*************************************************
+* Name:        binmul_prepare
+*
+* Description: Bring a reduced NTT-domain polynomial into the form consumed
+*              by binmul_acc: per 64-coefficient block, the pairs (b0, b1*zeta)
+*              and (b1, b0) interleaved, such that one madd against the
+*              interleaved pairs (a0, a1) yields both halves of the product
+*              in Z_q[X]/(X^2-zeta).
+*
+* Arguments:   - __m256i *bt: pointer to output (KYBER_N/8 vectors)
+*              - const poly *b: pointer to input polynomial
+**************************************************/
+static void binmul_prepare(__m256i bt[KYBER_N/8], const poly *b)
+{
+  unsigned int blk;
+  __m256i f0, f1, f2, f3, z1, z3, zl, zh, t;
+  const __m256i q = _mm256_load_si256(&qdata.vec[_16XQ/16]);
+  static const unsigned int zoff[4] = {176, 208, 400, 432};
+
+  for(blk=0;blk<4;blk++) {
+    zl = _mm256_loadu_si256((const __m256i *)&qdata.coeffs[_ZETAS_EXP+zoff[blk]]);
+    zh = _mm256_loadu_si256((const __m256i *)&qdata.coeffs[_ZETAS_EXP+zoff[blk]+16]);
+    f0 = _mm256_load_si256(&b->vec[4*blk+0]);
+    f1 = _mm256_load_si256(&b->vec[4*blk+1]);
+    f2 = _mm256_load_si256(&b->vec[4*blk+2]);
+    f3 = _mm256_load_si256(&b->vec[4*blk+3]);
+
+    // b1*zeta and -b3*zeta in Montgomery form
+    z1 = _mm256_mulhi_epi16(f1, zh);
+    t = _mm256_mullo_epi16(f1, zl);
+    t = _mm256_mulhi_epi16(t, q);
+    z1 = _mm256_sub_epi16(z1, t);
+    z3 = _mm256_mulhi_epi16(f3, zh);
+    t = _mm256_mullo_epi16(f3, zl);
+    t = _mm256_mulhi_epi16(t, q);
+    z3 = _mm256_sub_epi16(t, z3);
+
+    bt[8*blk+0] = _mm256_unpacklo_epi16(f0, z1);
+    bt[8*blk+1] = _mm256_unpackhi_epi16(f0, z1);
+    bt[8*blk+2] = _mm256_unpacklo_epi16(f2, z3);
+    bt[8*blk+3] = _mm256_unpackhi_epi16(f2, z3);
+    bt[8*blk+4] = _mm256_unpacklo_epi16(f1, f0);
+    bt[8*blk+5] = _mm256_unpackhi_epi16(f1, f0);
+    bt[8*blk+6] = _mm256_unpacklo_epi16(f3, f2);
+    bt[8*blk+7] = _mm256_unpackhi_epi16(f3, f2);
+  }
+}
+
+/*************************************************
+* Name:        binmul_acc
+*
+* Description: Accumulate the products of the k+1 polynomials of a re-key
+*              column with a binary polynomial (given as output of
+*              binmul_prepare of its reduced NTT) in 32-bit accumulators.
+*              Since re-key coefficients are below 2^12 and the prepared
+*              polynomial is bounded by q, all SATOPRE_COLS columns can be
+*              accumulated without intermediate reduction.
+*
+* Arguments:   - __m256i acc: pointer to in/output accumulators
+*              - const poly *a: pointer to re-key column in NTT domain
+*              - const __m256i *bt: pointer to prepared binary polynomial
+**************************************************/
+static void binmul_acc(__m256i acc[KYBER_K+1][KYBER_N/8],
+                       const poly a[KYBER_K+1],
+                       const __m256i bt[KYBER_N/8])
+{
+  unsigned int i, blk, k;
+  __m256i f0, f1, f2, f3, at[4];
+
+  for(i=0;i<KYBER_K+1;i++) {
+    for(blk=0;blk<4;blk++) {
+      f0 = _mm256_load_si256(&a[i].vec[4*blk+0]);
+      f1 = _mm256_load_si256(&a[i].vec[4*blk+1]);
+      f2 = _mm256_load_si256(&a[i].vec[4*blk+2]);
+      f3 = _mm256_load_si256(&a[i].vec[4*blk+3]);
+      at[0] = _mm256_unpacklo_epi16(f0, f1);
+      at[1] = _mm256_unpackhi_epi16(f0, f1);
+      at[2] = _mm256_unpacklo_epi16(f2, f3);
+      at[3] = _mm256_unpackhi_epi16(f2, f3);
+      for(k=0;k<8;k++)
+        acc[i][8*blk+k] = _mm256_add_epi32(acc[i][8*blk+k], _mm256_madd_epi16(at[k&3], bt[8*blk+k]));
+    }
+  }
+}
+
+/*************************************************
+* Name:        binmul_reduce
+*
+* Description: Montgomery-reduce 32-bit accumulators of binmul_acc to a
+*              polynomial in NTT domain (scaled by 2^-16 like the output of
+*              poly_basemul_montgomery) with coefficients below 2^15.
+*
+* Arguments:   - poly *r: pointer to output polynomial
+*              - const __m256i *acc: pointer to input accumulators
+**************************************************/
+static void binmul_reduce(poly *r, const __m256i acc[KYBER_N/8])
+{
+  unsigned int i;
+  __m256i lo, hi;
+  const __m256i q = _mm256_load_si256(&qdata.vec[_16XQ/16]);
+  const __m256i qinv = _mm256_load_si256(&qdata.vec[_16XQINV/16]);
+  const __m256i mask = _mm256_set1_epi32(0xFFFF);
+  // output vector i of a block collects accumulators 2j and 2j+1 of the block
+  static const unsigned char idx[4] = {0, 4, 2, 6};
+
+  for(i=0;i<KYBER_N/16;i++) {
+    const __m256i *x = &acc[8*(i/4) + idx[i%4]];
+    lo = _mm256_packus_epi32(_mm256_and_si256(x[0], mask), _mm256_and_si256(x[1], mask));
+    hi = _mm256_packs_epi32(_mm256_srai_epi32(x[0], 16), _mm256_srai_epi32(x[1], 16));
+    lo = _mm256_mullo_epi16(lo, qinv);
+    lo = _mm256_mulhi_epi16(lo, q);
+    _mm256_store_si256(&r->vec[i], _mm256_sub_epi16(hi, lo));
+  }
+}
+
+/*************************************************
+* Name:        load_column
+*
+* Description: Load column c of a re-key into NTT domain. For d = 0 the re-key
+*              is in the format output by satopre_rkg; otherwise it is in the
+*              format of satopre_rk_pack (without the leading width byte) and
+*              only the k+1 polynomials of this column are decompressed and
+*              transformed, so that the re-key is never expanded as a whole.
+*
+* Arguments:   - poly *a: pointer to output column (k+1 polynomials)
+*              - const uint8_t *rk: pointer to input re-key
+*              - unsigned int d: bits per coefficient, 0 for NTT format
+*              - unsigned int c: index of the column
+**************************************************/
+static void load_column(poly a[KYBER_K+1],
+                        const uint8_t *rk,
+                        unsigned int d,
+                        unsigned int c)
+{
+  unsigned int i;
+
+  if(d == 0) {
+    rk += c*SATOPRE_RKCOLBYTES;
+    for(i=0;i<KYBER_K+1;i++)
+      poly_frombytes(&a[i], rk+i*KYBER_POLYBYTES);
+  }
+  else {
+    rk += c*SATOPRE_RKPACKEDCOLBYTES(d);
+    for(i=0;i<KYBER_K+1;i++)
+      poly_decompress_bits(&a[i], rk+i*KYBER_N/8*d, d);
+    poly_ntt_batch(a, KYBER_K+1);
+    for(i=0;i<KYBER_K+1;i++)
+      poly_reduce(&a[i]);
+  }
+}
+
+/*************************************************
+* Name:        renc
+*
+* Description: Re-encryption of c_i to c_j with a re-key in either format
+*
+* Arguments:   - uint8_t *c_j: pointer to output ciphertext
+*              - const uint8_t *rk: pointer to input re-key
+*              - unsigned int d: bits per coefficient of rk, 0 for NTT format
+*              - const uint8_t *c_i: pointer to input ciphertext
+**************************************************/
+static void renc(uint8_t c_j[SATOPRE_BYTES],
+                 const uint8_t *rk,
+                 unsigned int d,
+                 const uint8_t c_i[SATOPRE_BYTES])
 {
-    generate_noise_matrix(R, noiseseed, poly_getnoise_eta2_4x, poly_getnoise_eta2);
+  unsigned int i, j, n;
+  unsigned int bits[SATOPRE_L];
+  polyvec u_i, u_j;
+  poly v_i, v_j, d_i[SATOPRE_L], a[KYBER_K+1];
+  __m256i bt[KYBER_N/8];
+  __m256i acc[KYBER_K+1][KYBER_N/8];
+
+  unpack_ciphertext(&u_i, &v_i, c_i);
+  memset(acc, 0, sizeof(acc));
+
+  for(i=0;i<KYBER_K;i++) {
+    // zero bit-planes contribute nothing, so neither their NTT nor
+    // the matching re-key columns are needed
+    n = gadget_decompose(d_i, bits, &u_i.vec[i]);
+    poly_ntt_batch(d_i, n);
+    for(j=0;j<n;j++) {
+      poly_reduce(&d_i[j]);
+      binmul_prepare(bt, &d_i[j]);
+      load_column(a, rk, d, i*SATOPRE_L + bits[j]);
+      binmul_acc(acc, a, bt);
+    }
+  }
+
+  for(i=0;i<KYBER_K;i++)
+    binmul_reduce(&u_j.vec[i], acc[i]);
+  binmul_reduce(&v_j, acc[KYBER_K]);
+
+  polyvec_invntt_tomont(&u_j); // u_j = U * d
+  poly_invntt_tomont(&v_j);
+  poly_add(&v_j, &v_j, &v_i); // v_j = v_i + w * d
+  polyvec_reduce(&u_j);
+  poly_reduce(&v_j);
+
+  pack_ciphertext(c_j, &u_j, &v_j);
 }
 
-// get keypairs
-void satopre_keypair(uint8_t pk[2 * KYBER_INDCPA_PUBLICKEYBYTES],
-                     uint8_t sk[2 * KYBER_INDCPA_SECRETKEYBYTES],
+/*************************************************
+* Name:        satopre_keypair
+*
+* Description: Generates the two IND-CPA key pairs of a satoPRE user;
+*              pk = (pk1 || pk2), sk = (sk1 || sk2)
+*
+* Arguments:   - uint8_t *pk: pointer to output public key
+*                             (of length SATOPRE_PUBLICKEYBYTES bytes)
+*              - uint8_t *sk: pointer to output private key
+*                             (of length SATOPRE_SECRETKEYBYTES bytes)
+*              - const uint8_t *coins1: pointer to input randomness of the first pair
+*                             (of length KYBER_SYMBYTES bytes)
+*              - const uint8_t *coins2: pointer to input randomness of the second pair
+*                             (of length KYBER_SYMBYTES bytes)
+**************************************************/
+void satopre_keypair(uint8_t pk[SATOPRE_PUBLICKEYBYTES],
+                     uint8_t sk[SATOPRE_SECRETKEYBYTES],
                      const uint8_t coins1[KYBER_SYMBYTES],
                      const uint8_t coins2[KYBER_SYMBYTES])
 {
-    uint8_t pk1[KYBER_INDCPA_PUBLICKEYBYTES], sk1[KYBER_INDCPA_SECRETKEYBYTES], pk2[KYBER_INDCPA_PUBLICKEYBYTES], sk2[KYBER_INDCPA_SECRETKEYBYTES];
-    indcpa_keypair_derand(pk1, sk1, coins1);
-    indcpa_keypair_derand(pk2, sk2, coins2);
+  indcpa_keypair_derand(pk, sk, coins1);
+  indcpa_keypair_derand(pk+KYBER_INDCPA_PUBLICKEYBYTES, sk+KYBER_INDCPA_SECRETKEYBYTES, coins2);
+}
+
+/*************************************************
+* Name:        satopre_enc
+*
+* Description: Encryption of a re-encryptable ciphertext under pk1
+*
+* Arguments:   - uint8_t *c: pointer to output ciphertext
+*                            (of length SATOPRE_BYTES bytes)
+*              - const uint8_t *m: pointer to input message
+*                                  (of length KYBER_INDCPA_MSGBYTES bytes)
+*              - const uint8_t *pk: pointer to input public key
+*                                   (of length SATOPRE_PUBLICKEYBYTES)
+*              - const uint8_t *coins: pointer to input random coins used as seed
+*                                      (of length KYBER_SYMBYTES) to deterministically
+*                                      generate all randomness
+**************************************************/
+void satopre_enc(uint8_t c[SATOPRE_BYTES],
+                 const uint8_t m[KYBER_INDCPA_MSGBYTES],
+                 const uint8_t pk[SATOPRE_PUBLICKEYBYTES],
+                 const uint8_t coins[KYBER_SYMBYTES])
+{
+  indcpa_enc(c, m, pk, coins);
+}
+
+/*************************************************
+* Name:        satopre_dec
+*
+* Description: Decryption of an original (not re-encrypted) ciphertext
+*              with sk1
+*
+* Arguments:   - uint8_t *m: pointer to output decrypted message
+*                            (of length KYBER_INDCPA_MSGBYTES)
+*              - const uint8_t *c: pointer to input ciphertext
+*                                  (of length SATOPRE_BYTES)
+*              - const uint8_t *sk: pointer to input secret key
+*                                   (of length SATOPRE_SECRETKEYBYTES)
+**************************************************/
+void satopre_dec(uint8_t m[KYBER_INDCPA_MSGBYTES],
+                 const uint8_t c[SATOPRE_BYTES],
+                 const uint8_t sk[SATOPRE_SECRETKEYBYTES])
+{
+  indcpa_dec(m, c, sk);
+}
+
+/*************************************************
+* Name:        satopre_dec_re
+*
+* Description: Decryption of a re-encrypted ciphertext with sk2
+*
+* Arguments:   - uint8_t *m: pointer to output decrypted message
+*                            (of length KYBER_INDCPA_MSGBYTES)
+*              - const uint8_t *c: pointer to input ciphertext
+*                                  (of length SATOPRE_BYTES)
+*              - const uint8_t *sk: pointer to input secret key
+*                                   (of length SATOPRE_SECRETKEYBYTES)
+**************************************************/
+void satopre_dec_re(uint8_t m[KYBER_INDCPA_MSGBYTES],
+                    const uint8_t c[SATOPRE_BYTES],
+                    const uint8_t sk[SATOPRE_SECRETKEYBYTES])
+{
+  indcpa_dec(m, c, sk+KYBER_INDCPA_SECRETKEYBYTES);
+}
+
+/*************************************************
+* Name:        rkg_block
+*
+* Description: Compute the SATOPRE_BLOCK re-key columns starting at column c.
+*              The output depends only on the inputs and c, so blocks can be
+*              computed in any order and by any thread.
+*
+* Arguments:   - uint8_t *rk: pointer to output re-key
+*              - const polyvec *at: pointer to rows of A_j^T
+*              - const polyvec *skpv: pointer to secret key s_i in NTT domain
+*              - const polyvec *skpv_j: pointer to secret key s_j in NTT domain
+*              - const uint8_t *coins: pointer to input noise seed
+*              - unsigned int c: index of the first column of the block
+**************************************************/
+static void rkg_block(uint8_t rk[SATOPRE_RKBYTES],
+                      const polyvec at[KYBER_K],
+                      const polyvec *skpv,
+                      const polyvec *skpv_j,
+                      const uint8_t coins[KYBER_SYMBYTES],
+                      unsigned int c)
+{
+  unsigned int i, b;
+  uint8_t *r;
+  polyvec r1[SATOPRE_BLOCK], r2[SATOPRE_BLOCK], u[SATOPRE_BLOCK];
+  poly r3[SATOPRE_BLOCK], w[SATOPRE_BLOCK], sg;
+
+  gen_noise_block(r1, r2, r3, coins, c);
+  poly_ntt_batch(r1[0].vec, SATOPRE_BLOCK*KYBER_K);
+  poly_ntt_batch(r2[0].vec, SATOPRE_BLOCK*KYBER_K);
+  poly_ntt_batch(r3, SATOPRE_BLOCK);
+
+  // U = A^T * R1 + R2, w = U^T s_j + r3
+  polyvec_matmul_montgomery(u[0].vec, at, KYBER_K, r1, SATOPRE_BLOCK);
+  for(b=0;b<SATOPRE_BLOCK;b++) {
+    for(i=0;i<KYBER_K;i++) {
+      poly_tomont(&u[b].vec[i]);
+      poly_add(&u[b].vec[i], &u[b].vec[i], &r2[b].vec[i]);
+    }
+    polyvec_reduce(&u[b]);
+    polyvec_basemul_acc_montgomery(&w[b], &u[b], skpv_j);
+    poly_tomont(&w[b]);
+    poly_add(&w[b], &w[b], &r3[b]);
+  }
+
+  // w -= s_i^T G; a block never straddles two rows of G since 4 | l
+  i = c / SATOPRE_L;
+  sg = skpv->vec[i];
+  for(b=0;b<c % SATOPRE_L;b++) {
+    poly_add(&sg, &sg, &sg);
+    poly_reduce(&sg);
+  }
+  for(b=0;b<SATOPRE_BLOCK;b++) {
+    poly_sub(&w[b], &w[b], &sg);
+    poly_add(&sg, &sg, &sg);
+    poly_reduce(&sg);
+  }
+
+  for(b=0;b<SATOPRE_BLOCK;b++) {
+    r = rk + (c+b)*SATOPRE_RKCOLBYTES;
+    polyvec_tobytes(r, &u[b]);
+    poly_reduce(&w[b]);
+    poly_tobytes(r+KYBER_POLYVECBYTES, &w[b]);
+  }
+}
+
+/*************************************************
+* Name:        rkg_setup
+*
+* Description: Expand the inputs of re-key generation that are shared by all
+*              column blocks
+*
+* Arguments:   - polyvec *at: pointer to output rows of A_j^T
+*              - polyvec *skpv: pointer to output secret key s_i
+*              - polyvec *skpv_j: pointer to output secret key s_j
+*              - const uint8_t *sk_i: pointer to input secret key of i
+*              - const uint8_t *pk_j: pointer to input public key of j
+*              - const uint8_t *sk_j: pointer to input secret key of j
+**************************************************/
+static void rkg_setup(polyvec at[KYBER_K],
+                      polyvec *skpv,
+                      polyvec *skpv_j,
+                      const uint8_t sk_i[SATOPRE_SECRETKEYBYTES],
+                      const uint8_t pk_j[SATOPRE_PUBLICKEYBYTES],
+                      const uint8_t sk_j[SATOPRE_SECRETKEYBYTES])
+{
+  const uint8_t *seed = pk_j+KYBER_INDCPA_PUBLICKEYBYTES+KYBER_POLYVECBYTES;
 
-    concatenate_pks(pk, pk1, pk2);
-    concatenate_sks(sk, sk1, sk2);
+  unpack_sk(skpv, sk_i); // \hat{s}_i from sk1_i
+  unpack_sk(skpv_j, sk_j+KYBER_INDCPA_SECRETKEYBYTES); // \hat{s}_j from sk2_j
+  gen_at(at, seed); // A_j^T, from the seed of pk2_j
 }
 
-// re-key generation
-void satopre_rkg(uint8_t sk_i[2 * KYBER_INDCPA_SECRETKEYBYTES],
-                 const uint8_t pk_j[2 * KYBER_INDCPA_PUBLICKEYBYTES],
+/*************************************************
+* Name:        satopre_rkg
+*
+* Description: Re-encryption key generation from i to j, with the key pair
+*              of j (see the top of this file for why sk_j is needed)
+*
+* Arguments:   - const uint8_t *sk_i: pointer to input secret key of i
+*                                   (of length SATOPRE_SECRETKEYBYTES)
+*              - const uint8_t *pk_j: pointer to input public key of j
+*                                   (of length SATOPRE_PUBLICKEYBYTES)
+*              - const uint8_t *sk_j: pointer to input secret key of j
+*                                   (of length SATOPRE_SECRETKEYBYTES)
+*              - uint8_t *rk: pointer to output re-key
+*                                  (of length SATOPRE_RKBYTES)
+*              - const uint8_t *coins: pointer to input random coins used as seed
+*                                      (of length KYBER_SYMBYTES) to deterministically
+*                                      generate all randomness
+**************************************************/
+void satopre_rkg(const uint8_t sk_i[SATOPRE_SECRETKEYBYTES],
+                 const uint8_t pk_j[SATOPRE_PUBLICKEYBYTES],
+                 const uint8_t sk_j[SATOPRE_SECRETKEYBYTES],
+                 uint8_t rk[SATOPRE_RKBYTES],
                  const uint8_t coins[KYBER_SYMBYTES])
 {
-    uint8_t pk1_j[KYBER_INDCPA_PUBLICKEYBYTES], pk2_j[KYBER_INDCPA_PUBLICKEYBYTES];
-    uint8_t sk1_i[KYBER_INDCPA_SECRETKEYBYTES], sk2_i[KYBER_INDCPA_SECRETKEYBYTES];
-    uint8_t rk1[KYBER_INDCPA_BYTES], rk2[KYBER_INDCPA_BYTES];
-    uint8_t seed[KYBER_SYMBYTES];
-    polyvec pkpv, at[KYBER_K];
-    polyvec R1[KYBER_K][l], R2[KYBER_K][l], U[KYBER_K][l], r3;
-    uint8_t buf[2 * KYBER_SYMBYTES];
-    const uint8_t *noiseseed = buf + KYBER_SYMBYTES;
-    unsigned int i, j;
-
-    gen_at(at, seed); // A^T
-
-    split_pks(pk1_j, pk2_j, pk_j);
-    split_sks(sk1_i, sk2_i, sk_i);
-
-    unpack_pk(&pkpv, seed, pk2_j); // \hat{t}_j \gets Decompression
-
-    generate_R1_matrix(&R1, noiseseed); // R1 \gets \beta_\eta^{k\times k\ell}
-    generate_R2_matrix(&R2, noiseseed); // R2 \gets \beta_\eta^{k\times k\ell}
-    generate_polyvec(&r3, noiseseed); // r3 \gets \beta_\eta^k
-
-	// compute A^T * R1
-	for (j = 0; j < l; j++) {
-		for (i = 0; i < KYBER_K; i++) {
-			polyvec_basemul_acc_montgomery(&U[i][j], &at[i], &R1[i][j]);
-		}
-	}
-
-	// compute U = A^T * R1 + R2
-	for (j = 0; j < l; j++) {
-		for (i = 0; i < KYBER_K; i++) {
-			polyvec_add(&U[i][j], &U[i][j], &R2[i][j]);
-		}
-	}
-
-	// compute \hat{t}_B^T * R1
-	for (j = 0; j < l; j++) {
-		polyvec_basemul_acc_montgomery(&r3, &pkpv, &R1[i][j]);
-	}
-}
\ No newline at end of file
+  unsigned int c;
+  polyvec at[KYBER_K], skpv, skpv_j;
+  const uint64_t t0 = telemetry_begin();
+
+  rkg_setup(at, &skpv, &skpv_j, sk_i, pk_j, sk_j);
+  for(c=0;c<SATOPRE_COLS;c+=SATOPRE_BLOCK)
+    rkg_block(rk, at, &skpv, &skpv_j, coins, c);
+  telemetry_end(CDPRE_TELEMETRY_SATOPRE_RKG, t0, SATOPRE_RKBYTES);
+}
+
+struct rkg_ctx {
+  uint8_t *rk;
+  const polyvec *at;
+  const polyvec *skpv;
+  const polyvec *skpv_j;
+  const uint8_t *coins;
+  atomic_uint next;
+};
+
+/*************************************************
+* Name:        rkg_worker
+*
+* Description: Worker of satopre_rkg_mt; claims column blocks from the shared
+*              counter until all blocks are taken
+*
+* Arguments:   - void *arg: pointer to struct rkg_ctx
+**************************************************/
+static void *rkg_worker(void *arg)
+{
+  struct rkg_ctx *ctx = arg;
+  unsigned int c;
+
+  while((c = atomic_fetch_add(&ctx->next, SATOPRE_BLOCK)) < SATOPRE_COLS)
+    rkg_block(ctx->rk, ctx->at, ctx->skpv, ctx->skpv_j, ctx->coins, c);
+  return NULL;
+}
+
+/*************************************************
+* Name:        satopre_rkg_mt
+*
+* Description: Multi-threaded re-encryption key generation from i to j.
+*              The column blocks are distributed dynamically over the calling
+*              thread and up to nthreads-1 additional threads. The noise of
+*              every column is derived from coins and the column index only,
+*              so the output equals that of satopre_rkg for any nthreads.
+*              If a thread cannot be created, its share is computed by the
+*              remaining threads.
+*
+* Arguments:   - const uint8_t *sk_i: pointer to input secret key of i
+*                                   (of length SATOPRE_SECRETKEYBYTES)
+*              - const uint8_t *pk_j: pointer to input public key of j
+*                                   (of length SATOPRE_PUBLICKEYBYTES)
+*              - const uint8_t *sk_j: pointer to input secret key of j
+*                                   (of length SATOPRE_SECRETKEYBYTES)
+*              - uint8_t *rk: pointer to output re-key
+*                                  (of length SATOPRE_RKBYTES)
+*              - const uint8_t *coins: pointer to input random coins used as seed
+*                                      (of length KYBER_SYMBYTES) to deterministically
+*                                      generate all randomness
+*              - unsigned int nthreads: number of threads, at most
+*                                      SATOPRE_COLS/SATOPRE_BLOCK are used
+**************************************************/
+void satopre_rkg_mt(const uint8_t sk_i[SATOPRE_SECRETKEYBYTES],
+                    const uint8_t pk_j[SATOPRE_PUBLICKEYBYTES],
+                    const uint8_t sk_j[SATOPRE_SECRETKEYBYTES],
+                    uint8_t rk[SATOPRE_RKBYTES],
+                    const uint8_t coins[KYBER_SYMBYTES],
+                    unsigned int nthreads)
+{
+  unsigned int i, n = 0;
+  polyvec at[KYBER_K], skpv, skpv_j;
+  pthread_t tid[SATOPRE_COLS/SATOPRE_BLOCK];
+  struct rkg_ctx ctx;
+  const uint64_t t0 = telemetry_begin();
+
+  rkg_setup(at, &skpv, &skpv_j, sk_i, pk_j, sk_j);
+  ctx.rk = rk;
+  ctx.at = at;
+  ctx.skpv = &skpv;
+  ctx.skpv_j = &skpv_j;
+  ctx.coins = coins;
+  atomic_init(&ctx.next, 0);
+
+  if(nthreads > SATOPRE_COLS/SATOPRE_BLOCK)
+    nthreads = SATOPRE_COLS/SATOPRE_BLOCK;
+  for(i=1;i<nthreads;i++)
+    if(pthread_create(&tid[n], NULL, rkg_worker, &ctx) == 0)
+      n++;
+
+  rkg_worker(&ctx);
+  for(i=0;i<n;i++)
+    pthread_join(tid[i], NULL);
+  telemetry_end(CDPRE_TELEMETRY_SATOPRE_RKG, t0, SATOPRE_RKBYTES);
+}
+
+/*************************************************
+* Name:        satopre_renc
+*
+* Description: Re-encryption of c_i to c_j
+*
+* Arguments:   - const uint8_t *rk: pointer to input re-key
+*                                  (of length SATOPRE_RKBYTES)
+*              - const uint8_t *c_i: pointer to input ciphertext
+*                                  (of length SATOPRE_BYTES)
+*              - uint8_t *c_j: pointer to output ciphertext
+*                                  (of length SATOPRE_BYTES)
+**************************************************/
+void satopre_renc(const uint8_t rk[SATOPRE_RKBYTES],
+                  const uint8_t c_i[SATOPRE_BYTES],
+                  uint8_t c_j[SATOPRE_BYTES])
+{
+  const uint64_t t0 = telemetry_begin();
+
+  renc(c_j, rk, 0, c_i);
+  telemetry_end(CDPRE_TELEMETRY_SATOPRE_RENC, t0, SATOPRE_BYTES);
+}
+
+/*************************************************
+* Name:        satopre_rk_pack
+*
+* Description: Convert a re-key to the compressed storage format: one byte
+*              holding d, followed by the columns in order, each column
+*              holding its k+1 polynomials in normal domain with d bits
+*              per coefficient. Only d = 12, which is lossless, is accepted:
+*              rounding U to fewer bits adds s_j^T dU to every column, which
+*              like the noise of a re-key under pk2_j is far above q/4 after
+*              the multiplication with the digits.
+*
+* Arguments:   - uint8_t *prk: pointer to output packed re-key
+*                                  (of length SATOPRE_RKPACKEDBYTES(d))
+*              - const uint8_t *rk: pointer to input re-key
+*                                  (of length SATOPRE_RKBYTES)
+*              - unsigned int d: bits per coefficient,
+*                                  SATOPRE_RKMINBITS <= d <= SATOPRE_RKMAXBITS
+*
+* Returns 0 on success and -1 if d is out of range
+**************************************************/
+int satopre_rk_pack(uint8_t *prk,
+                    const uint8_t rk[SATOPRE_RKBYTES],
+                    unsigned int d)
+{
+  unsigned int c, i;
+  poly a, one;
+
+  if(d < SATOPRE_RKMINBITS || d > SATOPRE_RKMAXBITS)
+    return -1;
+
+  // basemul with NTT(1) removes the Montgomery factor of the inverse NTT
+  memset(&one, 0, sizeof(one));
+  one.coeffs[0] = 1;
+  poly_ntt(&one);
+
+  *prk++ = d;
+  for(c=0;c<SATOPRE_COLS;c++) {
+    for(i=0;i<KYBER_K+1;i++) {
+      poly_frombytes(&a, rk + c*SATOPRE_RKCOLBYTES + i*KYBER_POLYBYTES);
+      poly_basemul_montgomery(&a, &a, &one);
+      poly_invntt_tomont(&a);
+      poly_reduce(&a);
+      poly_compress_bits(prk, &a, d);
+      prk += KYBER_N/8*d;
+    }
+  }
+  return 0;
+}
+
+/*************************************************
+* Name:        satopre_renc_packed
+*
+* Description: Re-encryption of c_i to c_j with a re-key in the format of
+*              satopre_rk_pack. Columns are decompressed one at a time and
+*              only for non-zero digits of c_i.
+*
+* Arguments:   - const uint8_t *prk: pointer to input packed re-key
+*              - const uint8_t *c_i: pointer to input ciphertext
+*                                  (of length SATOPRE_BYTES)
+*              - uint8_t *c_j: pointer to output ciphertext
+*                                  (of length SATOPRE_BYTES)
+*
+* Returns 0 on success and -1 if the width byte of prk is out of range
+**************************************************/
+int satopre_renc_packed(const uint8_t *prk,
+                        const uint8_t c_i[SATOPRE_BYTES],
+                        uint8_t c_j[SATOPRE_BYTES])
+{
+  unsigned int d = prk[0];
+  const uint64_t t0 = telemetry_begin();
+
+  if(d < SATOPRE_RKMINBITS || d > SATOPRE_RKMAXBITS)
+    return -1;
+
+  renc(c_j, prk+1, d, c_i);
+  telemetry_end(CDPRE_TELEMETRY_SATOPRE_RENC, t0, SATOPRE_BYTES);
+  return 0;
+}
@@ -2,12 +2,66 @@
 #define SATOPRE_H
 
 #include <stdint.h>
+#include "params.h"
 
-void satopre_keypair(uint8_t pk1[KYBER_INDCPA_PUBLICKEYBYTES],
-	uint8_t sk1[KYBER_INDCPA_SECRETKEYBYTES],
-	uint8_t pk2[KYBER_INDCPA_PUBLICKEYBYTES],
-	uint8_t sk2[KYBER_INDCPA_SECRETKEYBYTES],
-	const uint8_t coins1[KYBER_SYMBYTES],
-	const uint8_t coins2[KYBER_SYMBYTES]);
+#define SATOPRE_L     12  /* gadget length, \lceil\log_2(q)\rceil */
+#define SATOPRE_COLS  (KYBER_K*SATOPRE_L)
+#define SATOPRE_BLOCK 4   /* re-key columns generated per keccakx4 batch */
 
-#endif // SATOPRE_H
\ No newline at end of file
+#define SATOPRE_PUBLICKEYBYTES (2*KYBER_INDCPA_PUBLICKEYBYTES)
+#define SATOPRE_SECRETKEYBYTES (2*KYBER_INDCPA_SECRETKEYBYTES)
+#define SATOPRE_BYTES          (KYBER_INDCPA_BYTES)
+/* one re-key column: k polynomials of U followed by one polynomial of w */
+#define SATOPRE_RKCOLBYTES     ((KYBER_K+1)*KYBER_POLYBYTES)
+#define SATOPRE_RKBYTES        (SATOPRE_COLS*SATOPRE_RKCOLBYTES)
+
+/* packed re-key (satopre_rk_pack): width byte, then d-bit columns */
+#define SATOPRE_RKMINBITS 12 /* narrower columns break re-encryption */
+#define SATOPRE_RKMAXBITS 12
+#define SATOPRE_RKPACKEDCOLBYTES(d) ((KYBER_K+1)*KYBER_N/8*(d))
+#define SATOPRE_RKPACKEDBYTES(d)    (1+SATOPRE_COLS*SATOPRE_RKPACKEDCOLBYTES(d))
+
+void satopre_keypair(uint8_t pk[SATOPRE_PUBLICKEYBYTES],
+                     uint8_t sk[SATOPRE_SECRETKEYBYTES],
+                     const uint8_t coins1[KYBER_SYMBYTES],
+                     const uint8_t coins2[KYBER_SYMBYTES]);
+
+void satopre_enc(uint8_t c[SATOPRE_BYTES],
+                 const uint8_t m[KYBER_INDCPA_MSGBYTES],
+                 const uint8_t pk[SATOPRE_PUBLICKEYBYTES],
+                 const uint8_t coins[KYBER_SYMBYTES]);
+
+void satopre_dec(uint8_t m[KYBER_INDCPA_MSGBYTES],
+                 const uint8_t c[SATOPRE_BYTES],
+                 const uint8_t sk[SATOPRE_SECRETKEYBYTES]);
+
+void satopre_rkg(const uint8_t sk_i[SATOPRE_SECRETKEYBYTES],
+                 const uint8_t pk_j[SATOPRE_PUBLICKEYBYTES],
+                 const uint8_t sk_j[SATOPRE_SECRETKEYBYTES],
+                 uint8_t rk[SATOPRE_RKBYTES],
+                 const uint8_t coins[KYBER_SYMBYTES]);
+
+void satopre_rkg_mt(const uint8_t sk_i[SATOPRE_SECRETKEYBYTES],
+                    const uint8_t pk_j[SATOPRE_PUBLICKEYBYTES],
+                    const uint8_t sk_j[SATOPRE_SECRETKEYBYTES],
+                    uint8_t rk[SATOPRE_RKBYTES],
+                    const uint8_t coins[KYBER_SYMBYTES],
+                    unsigned int nthreads);
+
+void satopre_renc(const uint8_t rk[SATOPRE_RKBYTES],
+                  const uint8_t c_i[SATOPRE_BYTES],
+                  uint8_t c_j[SATOPRE_BYTES]);
+
+int satopre_rk_pack(uint8_t *prk,
+                    const uint8_t rk[SATOPRE_RKBYTES],
+                    unsigned int d);
+
+int satopre_renc_packed(const uint8_t *prk,
+                        const uint8_t c_i[SATOPRE_BYTES],
+                        uint8_t c_j[SATOPRE_BYTES]);
+
+void satopre_dec_re(uint8_t m[KYBER_INDCPA_MSGBYTES],
+                    const uint8_t c[SATOPRE_BYTES],
+                    const uint8_t sk[SATOPRE_SECRETKEYBYTES]);
+
+#endif // SATOPRE_H
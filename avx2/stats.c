@@ -0,0 +1,48 @@
+#include <stdint.h>
+#include <string.h>
+#include "stats.h"
+
+const char *const cdpre_stats_op_names[CDPRE_STATS_NOPS] = {
+  "keypair", "enc", "dec", "rkg", "renc"
+};
+
+const char *const cdpre_stats_stage_names[CDPRE_STATS_NSTAGES] = {
+  "unpack", "gen_matrix", "noise", "ntt", "basemul", "invntt", "reduce", "pack"
+};
+
+#ifdef CDPRE_STATS
+_Thread_local struct cdpre_stats cdpre_stats_tls;
+#endif
+
+/*************************************************
+* Name:        cdpre_stats_snapshot
+*
+* Description: Copy the per-stage counters of the calling thread
+*
+* Arguments:   - struct cdpre_stats *s: pointer to output counters
+*
+* Returns 1 if the library was built with CDPRE_STATS, 0 otherwise
+* (s is then all zero)
+**************************************************/
+int cdpre_stats_snapshot(struct cdpre_stats *s)
+{
+#ifdef CDPRE_STATS
+  *s = cdpre_stats_tls;
+  return 1;
+#else
+  memset(s, 0, sizeof(*s));
+  return 0;
+#endif
+}
+
+/*************************************************
+* Name:        cdpre_stats_reset
+*
+* Description: Clear the per-stage counters of the calling thread
+**************************************************/
+void cdpre_stats_reset(void)
+{
+#ifdef CDPRE_STATS
+  memset(&cdpre_stats_tls, 0, sizeof(cdpre_stats_tls));
+#endif
+}
@@ -0,0 +1,73 @@
+#ifndef STATS_H
+#define STATS_H
+
+#include <stdint.h>
+
+/*
+ * Optional per-stage cycle counters for the IND-CPA scheme and cdPRE,
+ * compiled in with -DCDPRE_STATS. Each thread accumulates the number of
+ * calls of every operation and the cycles (rdtsc ticks) spent in each of
+ * its stages; cdpre_stats_snapshot() returns the counters of the calling
+ * thread. Without CDPRE_STATS the instrumentation expands to nothing and
+ * the snapshot is all zero.
+ */
+
+enum cdpre_stats_op {
+  CDPRE_STATS_KEYPAIR,
+  CDPRE_STATS_ENC,
+  CDPRE_STATS_DEC,
+  CDPRE_STATS_RKG,
+  CDPRE_STATS_RENC,
+  CDPRE_STATS_NOPS
+};
+
+enum cdpre_stats_stage {
+  CDPRE_STAGE_UNPACK,
+  CDPRE_STAGE_GENMATRIX,
+  CDPRE_STAGE_NOISE,
+  CDPRE_STAGE_NTT,
+  CDPRE_STAGE_BASEMUL,
+  CDPRE_STAGE_INVNTT,
+  CDPRE_STAGE_REDUCE,
+  CDPRE_STAGE_PACK,
+  CDPRE_STATS_NSTAGES
+};
+
+struct cdpre_stats {
+  uint64_t calls[CDPRE_STATS_NOPS];
+  uint64_t cycles[CDPRE_STATS_NOPS][CDPRE_STATS_NSTAGES];
+};
+
+extern const char *const cdpre_stats_op_names[CDPRE_STATS_NOPS];
+extern const char *const cdpre_stats_stage_names[CDPRE_STATS_NSTAGES];
+
+int cdpre_stats_snapshot(struct cdpre_stats *s);
+void cdpre_stats_reset(void);
+
+#ifdef CDPRE_STATS
+#include <x86intrin.h>
+
+extern _Thread_local struct cdpre_stats cdpre_stats_tls;
+
+/* Start timing operation op; STATS_STAGE(stage) then charges the cycles
+ * since the previous mark to stage. STATS_BEGIN_N counts n calls of op,
+ * for functions that do the work of n calls at once. */
+#define STATS_BEGIN_N(op, n) \
+  const enum cdpre_stats_op stats_op_ = (op); \
+  uint64_t stats_t_ = __rdtsc(); \
+  cdpre_stats_tls.calls[stats_op_] += (n)
+
+#define STATS_BEGIN(op) STATS_BEGIN_N(op, 1)
+
+#define STATS_STAGE(stage) do { \
+    uint64_t stats_t1_ = __rdtsc(); \
+    cdpre_stats_tls.cycles[stats_op_][stage] += stats_t1_ - stats_t_; \
+    stats_t_ = stats_t1_; \
+  } while(0)
+#else
+#define STATS_BEGIN_N(op, n) do {} while(0)
+#define STATS_BEGIN(op) do {} while(0)
+#define STATS_STAGE(stage) do {} while(0)
+#endif
+
+#endif
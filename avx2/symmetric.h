@@ -7,6 +7,7 @@
 
 #include "fips202.h"
 #include "fips202x4.h"
+#include "fips202x8.h"
 
 typedef keccak_state xof_state;
 
@@ -26,6 +27,10 @@ void kyber_shake256_rkprf(uint8_t out[KYBER_SSBYTES], const uint8_t key[KYBER_SY
 
 #define hash_h(OUT, IN, INBYTES) sha3_256(OUT, IN, INBYTES)
 #define hash_g(OUT, IN, INBYTES) sha3_512(OUT, IN, INBYTES)
+#define hash_h_x4(OUT0, OUT1, OUT2, OUT3, IN0, IN1, IN2, IN3, INBYTES) \
+        sha3_256x4(OUT0, OUT1, OUT2, OUT3, IN0, IN1, IN2, IN3, INBYTES)
+#define hash_g_x4(OUT0, OUT1, OUT2, OUT3, IN0, IN1, IN2, IN3, INBYTES) \
+        sha3_512x4(OUT0, OUT1, OUT2, OUT3, IN0, IN1, IN2, IN3, INBYTES)
 #define xof_absorb(STATE, SEED, X, Y) kyber_shake128_absorb(STATE, SEED, X, Y)
 #define xof_squeezeblocks(OUT, OUTBLOCKS, STATE) shake128_squeezeblocks(OUT, OUTBLOCKS, STATE)
 #define prf(OUT, OUTBYTES, KEY, NONCE) kyber_shake256_prf(OUT, OUTBYTES, KEY, NONCE)
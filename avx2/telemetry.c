@@ -0,0 +1,406 @@
+#include <pthread.h>
+#include <stdarg.h>
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "params.h"
+#include "telemetry.h"
+
+#define EMAX 39  /* largest exponent with its own sub-buckets */
+
+const char *const cdpre_telemetry_op_names[CDPRE_TELEMETRY_NOPS] = {
+  "indcpa_keypair", "indcpa_enc", "indcpa_dec",
+  "cdpre_rkg", "cdpre_renc",
+  "satopre_rkg", "satopre_renc"
+};
+
+struct counters {
+  _Atomic uint64_t calls;
+  _Atomic uint64_t bytes;
+  _Atomic uint64_t ticks;
+  _Atomic uint64_t buckets[CDPRE_TELEMETRY_BUCKETS];
+};
+
+struct slot {
+  struct counters op[CDPRE_TELEMETRY_NOPS];
+  _Atomic uint64_t margin_sum;
+  _Atomic uint64_t margins[CDPRE_TELEMETRY_MARGIN_BUCKETS];
+  struct slot *next;
+  atomic_int used;
+};
+
+atomic_int cdpre_telemetry_on;
+static _Atomic(struct slot *) slots;
+static _Thread_local struct slot *self;
+static pthread_key_t key;
+static pthread_once_t key_once = PTHREAD_ONCE_INIT;
+
+/*************************************************
+* Name:        cdpre_telemetry_enable
+*
+* Description: Switch recording on (on != 0) or off for all threads
+**************************************************/
+void cdpre_telemetry_enable(int on)
+{
+  atomic_store_explicit(&cdpre_telemetry_on, on != 0, memory_order_relaxed);
+}
+
+/*************************************************
+* Name:        cdpre_telemetry_bucket
+*
+* Description: Histogram bucket of a latency
+*
+* Arguments:   - uint64_t ticks: latency
+*
+* Returns the bucket index, less than CDPRE_TELEMETRY_BUCKETS
+**************************************************/
+unsigned int cdpre_telemetry_bucket(uint64_t ticks)
+{
+  unsigned int e;
+
+  if(ticks < 8)
+    return ticks;
+  e = 63 - __builtin_clzll(ticks);
+  if(e > EMAX)
+    return CDPRE_TELEMETRY_BUCKETS-1;
+  return 8*(e-2) + ((ticks >> (e-3)) & 7);
+}
+
+/*************************************************
+* Name:        cdpre_telemetry_bucket_max
+*
+* Description: Largest latency in a histogram bucket
+*
+* Arguments:   - unsigned int b: bucket index
+*
+* Returns the largest value v with cdpre_telemetry_bucket(v) == b
+**************************************************/
+uint64_t cdpre_telemetry_bucket_max(unsigned int b)
+{
+  unsigned int e;
+
+  if(b < 8)
+    return b;
+  if(b >= CDPRE_TELEMETRY_BUCKETS-1)
+    return UINT64_MAX;
+  e = b/8 + 2;
+  return ((uint64_t)(8 + b%8 + 1) << (e-3)) - 1;
+}
+
+static void release(void *arg)
+{
+  struct slot *s = arg;
+
+  atomic_store_explicit(&s->used, 0, memory_order_release);
+}
+
+static void make_key(void)
+{
+  pthread_key_create(&key, release);
+}
+
+/*************************************************
+* Name:        acquire
+*
+* Description: Bind a slot to the calling thread: a slot released by an
+*              exited thread if there is one, otherwise a new slot pushed
+*              to the list. The slot is released by the thread-exit
+*              destructor of key.
+*
+* Returns the slot or NULL if out of memory
+**************************************************/
+static struct slot *acquire(void)
+{
+  int expected;
+  struct slot *s;
+
+  pthread_once(&key_once, make_key);
+  for(s = atomic_load_explicit(&slots, memory_order_acquire); s; s = s->next) {
+    expected = 0;
+    if(atomic_compare_exchange_strong_explicit(&s->used, &expected, 1,
+                                               memory_order_acquire, memory_order_relaxed))
+      break;
+  }
+
+  if(!s) {
+    s = aligned_alloc(64, (sizeof(struct slot) + 63) & ~(size_t)63);
+    if(!s)
+      return NULL;
+    memset(s, 0, sizeof(struct slot));
+    atomic_init(&s->used, 1);
+    s->next = atomic_load_explicit(&slots, memory_order_relaxed);
+    while(!atomic_compare_exchange_weak_explicit(&slots, &s->next, s,
+                                                 memory_order_release, memory_order_relaxed))
+      ;
+  }
+
+  pthread_setspecific(key, s);
+  self = s;
+  return s;
+}
+
+// single writer per slot: a plain load and store suffice
+static void add(_Atomic uint64_t *x, uint64_t y)
+{
+  atomic_store_explicit(x, atomic_load_explicit(x, memory_order_relaxed) + y, memory_order_relaxed);
+}
+
+/*************************************************
+* Name:        telemetry_record
+*
+* Description: Record one call in the slot of the calling thread
+*
+* Arguments:   - enum cdpre_telemetry_op op: operation
+*              - uint64_t ticks: latency of the call
+*              - uint64_t bytes: number of bytes output by the call
+**************************************************/
+void telemetry_record(enum cdpre_telemetry_op op, uint64_t ticks, uint64_t bytes)
+{
+  struct slot *s = self;
+  struct counters *c;
+
+  if(!s && !(s = acquire()))
+    return;
+
+  c = &s->op[op];
+  add(&c->calls, 1);
+  add(&c->bytes, bytes);
+  add(&c->ticks, ticks);
+  add(&c->buckets[cdpre_telemetry_bucket(ticks)], 1);
+}
+
+/*************************************************
+* Name:        telemetry_record_margin
+*
+* Description: Record the noise margin of one decryption in the slot of
+*              the calling thread
+*
+* Arguments:   - unsigned int margin: noise margin from poly_tomsg_margin
+**************************************************/
+void telemetry_record_margin(unsigned int margin)
+{
+  unsigned int b = margin/CDPRE_TELEMETRY_MARGIN_WIDTH;
+  struct slot *s = self;
+
+  if(!s && !(s = acquire()))
+    return;
+
+  if(b >= CDPRE_TELEMETRY_MARGIN_BUCKETS)
+    b = CDPRE_TELEMETRY_MARGIN_BUCKETS-1;
+  add(&s->margin_sum, margin);
+  add(&s->margins[b], 1);
+}
+
+/*************************************************
+* Name:        cdpre_telemetry_snapshot
+*
+* Description: Sum the counters of all threads
+*
+* Arguments:   - struct cdpre_telemetry *t: pointer to output counters
+**************************************************/
+void cdpre_telemetry_snapshot(struct cdpre_telemetry *t)
+{
+  unsigned int i, j;
+  const struct slot *s;
+  const struct counters *c;
+
+  memset(t, 0, sizeof(*t));
+  for(s = atomic_load_explicit(&slots, memory_order_acquire); s; s = s->next) {
+    for(i=0;i<CDPRE_TELEMETRY_NOPS;i++) {
+      c = &s->op[i];
+      t->op[i].calls += atomic_load_explicit(&c->calls, memory_order_relaxed);
+      t->op[i].bytes += atomic_load_explicit(&c->bytes, memory_order_relaxed);
+      t->op[i].ticks += atomic_load_explicit(&c->ticks, memory_order_relaxed);
+      for(j=0;j<CDPRE_TELEMETRY_BUCKETS;j++)
+        t->op[i].buckets[j] += atomic_load_explicit(&c->buckets[j], memory_order_relaxed);
+    }
+    t->margin_sum += atomic_load_explicit(&s->margin_sum, memory_order_relaxed);
+    for(j=0;j<CDPRE_TELEMETRY_MARGIN_BUCKETS;j++)
+      t->margins[j] += atomic_load_explicit(&s->margins[j], memory_order_relaxed);
+  }
+}
+
+/*************************************************
+* Name:        cdpre_telemetry_quantile
+*
+* Description: Upper bound of a latency quantile from a histogram
+*
+* Arguments:   - const struct cdpre_telemetry_op_stats *s: pointer to counters
+*              - double q: quantile, 0 <= q <= 1
+*
+* Returns the largest latency of the bucket holding the q-quantile,
+* or 0 if the histogram is empty
+**************************************************/
+uint64_t cdpre_telemetry_quantile(const struct cdpre_telemetry_op_stats *s, double q)
+{
+  unsigned int b;
+  uint64_t n = 0, rank, acc = 0;
+
+  for(b=0;b<CDPRE_TELEMETRY_BUCKETS;b++)
+    n += s->buckets[b];
+  if(!n)
+    return 0;
+
+  rank = (uint64_t)(q*n + 0.5);
+  if(rank < 1) rank = 1;
+  if(rank > n) rank = n;
+  for(b=0;b<CDPRE_TELEMETRY_BUCKETS;b++) {
+    acc += s->buckets[b];
+    if(acc >= rank)
+      break;
+  }
+  return cdpre_telemetry_bucket_max(b);
+}
+
+/*************************************************
+* Name:        cdpre_telemetry_margin_quantile
+*
+* Description: Lower bound of a noise margin quantile from a histogram
+*
+* Arguments:   - const struct cdpre_telemetry *t: pointer to counters
+*              - double q: quantile, 0 <= q <= 1; small q such as 0.001
+*                          show the worst decryptions
+*
+* Returns the smallest margin of the bucket holding the q-quantile,
+* or 0 if the histogram is empty
+**************************************************/
+unsigned int cdpre_telemetry_margin_quantile(const struct cdpre_telemetry *t, double q)
+{
+  unsigned int b;
+  uint64_t n = 0, rank, acc = 0;
+
+  for(b=0;b<CDPRE_TELEMETRY_MARGIN_BUCKETS;b++)
+    n += t->margins[b];
+  if(!n)
+    return 0;
+
+  rank = (uint64_t)(q*n + 0.5);
+  if(rank < 1) rank = 1;
+  if(rank > n) rank = n;
+  for(b=0;b<CDPRE_TELEMETRY_MARGIN_BUCKETS;b++) {
+    acc += t->margins[b];
+    if(acc >= rank)
+      break;
+  }
+  return b*CDPRE_TELEMETRY_MARGIN_WIDTH;
+}
+
+struct out {
+  char *buf;
+  size_t len;
+  size_t pos;
+};
+
+__attribute__((format(printf, 2, 3)))
+static void put(struct out *o, const char *fmt, ...)
+{
+  int n;
+  va_list ap;
+
+  va_start(ap, fmt);
+  if(o->pos < o->len)
+    n = vsnprintf(o->buf + o->pos, o->len - o->pos, fmt, ap);
+  else
+    n = vsnprintf(NULL, 0, fmt, ap);
+  va_end(ap);
+  if(n > 0)
+    o->pos += n;
+}
+
+/*************************************************
+* Name:        cdpre_telemetry_prometheus
+*
+* Description: Format counters in the Prometheus text exposition format:
+*              cdpre_calls_total and cdpre_bytes_total counters and the
+*              cdpre_latency_ticks histogram, labelled with op and params,
+*              and the cdpre_dec_margin histogram, labelled with params.
+*              Histogram buckets are given from the lowest to the highest
+*              non-empty bucket.
+*
+* Arguments:   - char *buf: pointer to output buffer, may be NULL if buflen is 0
+*              - size_t buflen: size of buf; the output is truncated to
+*                               buflen-1 characters and NUL-terminated
+*              - const struct cdpre_telemetry *t: pointer to input counters
+*
+* Returns the length of the complete output without the terminating NUL,
+* as snprintf does
+**************************************************/
+size_t cdpre_telemetry_prometheus(char *buf, size_t buflen, const struct cdpre_telemetry *t)
+{
+  unsigned int i, b, lo, hi;
+  uint64_t acc;
+  const struct cdpre_telemetry_op_stats *s;
+  struct out o = {buf, buflen, 0};
+
+  if(buflen)
+    buf[0] = 0;
+
+  put(&o, "# HELP cdpre_calls_total Number of calls.\n"
+          "# TYPE cdpre_calls_total counter\n");
+  for(i=0;i<CDPRE_TELEMETRY_NOPS;i++)
+    put(&o, "cdpre_calls_total{op=\"%s\",params=\"%d\"} %llu\n", cdpre_telemetry_op_names[i],
+        KYBER_K*KYBER_N, (unsigned long long)t->op[i].calls);
+
+  put(&o, "# HELP cdpre_bytes_total Number of bytes output.\n"
+          "# TYPE cdpre_bytes_total counter\n");
+  for(i=0;i<CDPRE_TELEMETRY_NOPS;i++)
+    put(&o, "cdpre_bytes_total{op=\"%s\",params=\"%d\"} %llu\n", cdpre_telemetry_op_names[i],
+        KYBER_K*KYBER_N, (unsigned long long)t->op[i].bytes);
+
+  put(&o, "# HELP cdpre_latency_ticks Latency in rdtsc ticks.\n"
+          "# TYPE cdpre_latency_ticks histogram\n");
+  for(i=0;i<CDPRE_TELEMETRY_NOPS;i++) {
+    s = &t->op[i];
+    for(lo=0;lo<CDPRE_TELEMETRY_BUCKETS-1 && !s->buckets[lo];lo++);
+    for(hi=CDPRE_TELEMETRY_BUCKETS-1;hi>lo && !s->buckets[hi];hi--);
+    if(hi == CDPRE_TELEMETRY_BUCKETS-1)
+      hi--;  // the last bucket is only covered by +Inf
+
+    acc = 0;
+    for(b=0;b<lo;b++)
+      acc += s->buckets[b];
+    for(b=lo;b<=hi;b++) {
+      acc += s->buckets[b];
+      put(&o, "cdpre_latency_ticks_bucket{op=\"%s\",params=\"%d\",le=\"%llu\"} %llu\n",
+          cdpre_telemetry_op_names[i], KYBER_K*KYBER_N,
+          (unsigned long long)cdpre_telemetry_bucket_max(b), (unsigned long long)acc);
+    }
+    for(;b<CDPRE_TELEMETRY_BUCKETS;b++)
+      acc += s->buckets[b];
+    put(&o, "cdpre_latency_ticks_bucket{op=\"%s\",params=\"%d\",le=\"+Inf\"} %llu\n"
+            "cdpre_latency_ticks_sum{op=\"%s\",params=\"%d\"} %llu\n"
+            "cdpre_latency_ticks_count{op=\"%s\",params=\"%d\"} %llu\n",
+        cdpre_telemetry_op_names[i], KYBER_K*KYBER_N, (unsigned long long)acc,
+        cdpre_telemetry_op_names[i], KYBER_K*KYBER_N, (unsigned long long)s->ticks,
+        cdpre_telemetry_op_names[i], KYBER_K*KYBER_N, (unsigned long long)acc);
+  }
+
+  put(&o, "# HELP cdpre_dec_margin Noise margin of decryptions.\n"
+          "# TYPE cdpre_dec_margin histogram\n");
+  for(lo=0;lo<CDPRE_TELEMETRY_MARGIN_BUCKETS-1 && !t->margins[lo];lo++);
+  for(hi=CDPRE_TELEMETRY_MARGIN_BUCKETS-1;hi>lo && !t->margins[hi];hi--);
+  if(hi == CDPRE_TELEMETRY_MARGIN_BUCKETS-1)
+    hi--;
+
+  acc = 0;
+  for(b=0;b<lo;b++)
+    acc += t->margins[b];
+  for(b=lo;b<=hi;b++) {
+    acc += t->margins[b];
+    put(&o, "cdpre_dec_margin_bucket{params=\"%d\",le=\"%u\"} %llu\n", KYBER_K*KYBER_N,
+        (b+1)*CDPRE_TELEMETRY_MARGIN_WIDTH - 1, (unsigned long long)acc);
+  }
+  for(;b<CDPRE_TELEMETRY_MARGIN_BUCKETS;b++)
+    acc += t->margins[b];
+  put(&o, "cdpre_dec_margin_bucket{params=\"%d\",le=\"+Inf\"} %llu\n"
+          "cdpre_dec_margin_sum{params=\"%d\"} %llu\n"
+          "cdpre_dec_margin_count{params=\"%d\"} %llu\n",
+      KYBER_K*KYBER_N, (unsigned long long)acc,
+      KYBER_K*KYBER_N, (unsigned long long)t->margin_sum,
+      KYBER_K*KYBER_N, (unsigned long long)acc);
+
+  return o.pos;
+}
@@ -0,0 +1,107 @@
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <x86intrin.h>
+
+/*
+ * Runtime telemetry: per-operation call counts, output byte counts and
+ * latency histograms in rdtsc ticks. Recording is off until
+ * cdpre_telemetry_enable(1); while off, an instrumented call costs one
+ * relaxed load and a branch. Every thread records into its own slot
+ * without atomic read-modify-write operations; cdpre_telemetry_snapshot()
+ * sums the slots of all threads without locking, so a snapshot taken while
+ * other threads record may be off by their calls in flight. Slots of
+ * exited threads are reused with their counts, so all counts only grow.
+ *
+ * Histogram buckets are logarithmic with 8 sub-buckets per power of two
+ * (HDR style, relative bucket width at most 1/8): values below 8 have a
+ * bucket each, the last bucket collects everything from 15*2^36 ticks.
+ *
+ * cdpre_dec and cdpre_dec_batch also record the noise margin of every
+ * decryption (see poly_tomsg_margin) in a histogram with buckets of width
+ * 8: the distance of the worst coefficient from flipping its bit, at most
+ * (q-1)/4 = 832.
+ * The margin is measured from the decoded bit, not the encrypted one, so
+ * a failed decryption is not detectable: its margin looks like any other.
+ * What is observable is margins drifting towards 0, which give warning
+ * before failures become likely. Only the enabled path computes it.
+ * indcpa_dec, and with it crypto_kem_dec, records no margins: on chosen
+ * ciphertexts they would leak information on the secret key.
+ */
+
+#define CDPRE_TELEMETRY_BUCKETS 304
+#define CDPRE_TELEMETRY_MARGIN_WIDTH 8
+#define CDPRE_TELEMETRY_MARGIN_BUCKETS 105
+
+enum cdpre_telemetry_op {
+  CDPRE_TELEMETRY_INDCPA_KEYPAIR,
+  CDPRE_TELEMETRY_INDCPA_ENC,
+  CDPRE_TELEMETRY_INDCPA_DEC,
+  CDPRE_TELEMETRY_CDPRE_RKG,
+  CDPRE_TELEMETRY_CDPRE_RENC,
+  CDPRE_TELEMETRY_SATOPRE_RKG,
+  CDPRE_TELEMETRY_SATOPRE_RENC,
+  CDPRE_TELEMETRY_NOPS
+};
+
+struct cdpre_telemetry_op_stats {
+  uint64_t calls;
+  uint64_t bytes;
+  uint64_t ticks;
+  uint64_t buckets[CDPRE_TELEMETRY_BUCKETS];
+};
+
+struct cdpre_telemetry {
+  struct cdpre_telemetry_op_stats op[CDPRE_TELEMETRY_NOPS];
+  uint64_t margin_sum;
+  uint64_t margins[CDPRE_TELEMETRY_MARGIN_BUCKETS];
+};
+
+extern const char *const cdpre_telemetry_op_names[CDPRE_TELEMETRY_NOPS];
+
+void cdpre_telemetry_enable(int on);
+void cdpre_telemetry_snapshot(struct cdpre_telemetry *t);
+unsigned int cdpre_telemetry_bucket(uint64_t ticks);
+uint64_t cdpre_telemetry_bucket_max(unsigned int b);
+uint64_t cdpre_telemetry_quantile(const struct cdpre_telemetry_op_stats *s, double q);
+unsigned int cdpre_telemetry_margin_quantile(const struct cdpre_telemetry *t, double q);
+size_t cdpre_telemetry_prometheus(char *buf, size_t buflen, const struct cdpre_telemetry *t);
+
+/* Instrumentation of the library functions */
+extern atomic_int cdpre_telemetry_on;
+
+void telemetry_record(enum cdpre_telemetry_op op, uint64_t ticks, uint64_t bytes);
+void telemetry_record_margin(unsigned int margin);
+
+static inline uint64_t telemetry_begin(void)
+{
+  if(!atomic_load_explicit(&cdpre_telemetry_on, memory_order_relaxed))
+    return 0;
+  return __rdtsc();
+}
+
+static inline void telemetry_end(enum cdpre_telemetry_op op, uint64_t t0, uint64_t bytes)
+{
+  if(t0)
+    telemetry_record(op, __rdtsc() - t0, bytes);
+}
+
+/* Record n calls of op done at once, each with an equal share of the
+ * latency and the given bytes. */
+static inline void telemetry_end_n(enum cdpre_telemetry_op op, uint64_t t0, unsigned int n,
+                                   uint64_t bytes)
+{
+  unsigned int i;
+  uint64_t ticks;
+
+  if(t0) {
+    ticks = (__rdtsc() - t0)/n;
+    for(i=0;i<n;i++)
+      telemetry_record(op, ticks, bytes);
+  }
+}
+
+#endif
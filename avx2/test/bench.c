@@ -0,0 +1,265 @@
+#define _GNU_SOURCE
+#include <sched.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include "../kem.h"
+#include "../params.h"
+#include "../indcpa.h"
+#include "../cdpre.h"
+#include "../satopre.h"
+#include "../randombytes.h"
+#include "../stats.h"
+#include "../telemetry.h"
+#include "cpucycles.h"
+#include "speed_print.h"
+#include "perfcounters.h"
+
+/*
+ * Benchmark driver for the Kyber KEM, the IND-CPA scheme, cdPRE and satoPRE
+ * on valid keys and ciphertexts. Every operation is warmed up and then
+ * timed ntests times on a pinned CPU. One line per operation is written to
+ * stdout, either as CSV or as JSON (one object per line):
+ *
+ *   scheme,params,op,samples,median,mean,p90,p99,stddev,
+ *   backend,core_cycles,instructions,ipc,l1d_misses,llc_misses,branch_misses
+ *
+ * median to stddev are in cycles/ticks as returned by cpucycles(). The
+ * remaining columns are per-operation averages over the ntests timed calls
+ * from the hardware performance counters (see perfcounters.c). backend is
+ * "rdtsc" if no counters are available; core_cycles then holds rdtsc ticks
+ * and the other counters are left empty in CSV and null in JSON, as are
+ * counters the PMU does not support.
+ *
+ * Built with -DCDPRE_STATS (test/bench_stats$ALG), one more column per stage
+ * of the instrumented functions (see stats.h) gives the ticks spent in that
+ * stage per timed call, summed over all instrumented functions the
+ * operation calls; the instrumentation itself adds to median and mean.
+ */
+
+#define NTESTS  1000
+#define NWARMUP 100
+
+enum format { CSV, JSON };
+
+static uint64_t *t;
+static unsigned int ntests = NTESTS;
+static unsigned int nwarmup = NWARMUP;
+static enum format fmt = CSV;
+
+static const struct {
+  const char *name;
+  enum counter c;
+} columns[] = {
+  {"core_cycles", CNT_CYCLES},
+  {"instructions", CNT_INSTRUCTIONS},
+  {"ipc", NCOUNTERS},
+  {"l1d_misses", CNT_L1D_MISSES},
+  {"llc_misses", CNT_LLC_MISSES},
+  {"branch_misses", CNT_BRANCH_MISSES},
+};
+
+static void print_counters(const struct counters *pc)
+{
+  unsigned int i;
+  int avail;
+  double x;
+
+  for(i=0;i<sizeof(columns)/sizeof(columns[0]);i++) {
+    if(columns[i].c == NCOUNTERS) {
+      avail = perf_available(CNT_CYCLES) && perf_available(CNT_INSTRUCTIONS)
+              && pc->value[CNT_CYCLES];
+      x = avail ? (double)pc->value[CNT_INSTRUCTIONS]/pc->value[CNT_CYCLES] : 0;
+    }
+    else {
+      avail = perf_available(columns[i].c);
+      x = (double)pc->value[columns[i].c]/ntests;
+    }
+
+    if(fmt == JSON) {
+      printf(", \"%s\": ", columns[i].name);
+      if(avail) printf(columns[i].c == NCOUNTERS ? "%.3f" : "%.1f", x);
+      else printf("null");
+    }
+    else {
+      printf(",");
+      if(avail) printf(columns[i].c == NCOUNTERS ? "%.3f" : "%.1f", x);
+    }
+  }
+}
+
+#ifdef CDPRE_STATS
+static void print_stages(void)
+{
+  unsigned int i, j;
+  uint64_t sum;
+  struct cdpre_stats st;
+
+  cdpre_stats_snapshot(&st);
+  for(j=0;j<CDPRE_STATS_NSTAGES;j++) {
+    sum = 0;
+    for(i=0;i<CDPRE_STATS_NOPS;i++)
+      sum += st.cycles[i][j];
+    if(fmt == JSON)
+      printf(", \"stage_%s\": %.1f", cdpre_stats_stage_names[j], (double)sum/ntests);
+    else
+      printf(",%.1f", (double)sum/ntests);
+  }
+}
+#endif
+
+static void report(const char *scheme, const char *op, const struct counters *pc)
+{
+  struct speed_stats s;
+
+  get_stats(&s, t, ntests+1);
+  if(fmt == JSON)
+    printf("{\"scheme\": \"%s\", \"params\": %d, \"op\": \"%s\", \"samples\": %zu, "
+           "\"median\": %llu, \"mean\": %.1f, \"p90\": %llu, \"p99\": %llu, \"stddev\": %.1f, "
+           "\"backend\": \"%s\"",
+           scheme, KYBER_K*KYBER_N, op, s.samples, (unsigned long long)s.median, s.mean,
+           (unsigned long long)s.p90, (unsigned long long)s.p99, s.stddev, perf_backend());
+  else
+    printf("%s,%d,%s,%zu,%llu,%.1f,%llu,%llu,%.1f,%s",
+           scheme, KYBER_K*KYBER_N, op, s.samples, (unsigned long long)s.median, s.mean,
+           (unsigned long long)s.p90, (unsigned long long)s.p99, s.stddev, perf_backend());
+  print_counters(pc);
+#ifdef CDPRE_STATS
+  print_stages();
+#endif
+  printf(fmt == JSON ? "}\n" : "\n");
+  fflush(stdout);
+}
+
+#define BENCH(scheme, op, call) do {  \
+    for(i=0;i<nwarmup;i++) {          \
+      call;                           \
+    }                                 \
+    cdpre_stats_reset();              \
+    perf_start();                     \
+    for(i=0;i<ntests;i++) {           \
+      t[i] = cpucycles();             \
+      call;                           \
+    }                                 \
+    t[ntests] = cpucycles();          \
+    perf_stop(&pc);                   \
+    report(scheme, op, &pc);          \
+  } while(0)
+
+static void pin_cpu(int cpu)
+{
+  cpu_set_t set;
+
+  CPU_ZERO(&set);
+  CPU_SET(cpu, &set);
+  if(sched_setaffinity(0, sizeof(set), &set))
+    fprintf(stderr, "WARNING: could not pin to CPU %d\n", cpu);
+}
+
+static void usage(const char *name)
+{
+  fprintf(stderr, "usage: %s [-f csv|json] [-H] [-n ntests] [-w warmup] [-c cpu] [-R] [-T]\n"
+                  "  -H  print the CSV header line\n"
+                  "  -R  do not use hardware performance counters\n"
+                  "  -T  enable the runtime telemetry of the library\n"
+                  "  -c  CPU to pin to (default: the current one, -1: do not pin)\n", name);
+  exit(1);
+}
+
+static uint8_t rk_sato[SATOPRE_RKBYTES];
+
+int main(int argc, char *argv[])
+{
+  unsigned int i;
+  int opt, cpu = sched_getcpu(), header = 0, counters = 1;
+  struct counters pc;
+  uint8_t coins[KYBER_SYMBYTES];
+  uint8_t m[KYBER_INDCPA_MSGBYTES];
+  uint8_t pk[CRYPTO_PUBLICKEYBYTES];
+  uint8_t sk[CRYPTO_SECRETKEYBYTES];
+  uint8_t ct[CRYPTO_CIPHERTEXTBYTES];
+  uint8_t key[CRYPTO_BYTES];
+  uint8_t pk_i[KYBER_INDCPA_PUBLICKEYBYTES];
+  uint8_t sk_i[KYBER_INDCPA_SECRETKEYBYTES];
+  uint8_t pk_j[KYBER_INDCPA_PUBLICKEYBYTES];
+  uint8_t sk_j[KYBER_INDCPA_SECRETKEYBYTES];
+  uint8_t ct_i[KYBER_INDCPA_BYTES];
+  uint8_t ct_j[KYBER_INDCPA_BYTES];
+  uint8_t rk[KYBER_INDCPA_BYTES];
+  uint8_t spk_i[SATOPRE_PUBLICKEYBYTES];
+  uint8_t ssk_i[SATOPRE_SECRETKEYBYTES];
+  uint8_t spk_j[SATOPRE_PUBLICKEYBYTES];
+  uint8_t ssk_j[SATOPRE_SECRETKEYBYTES];
+
+  while((opt = getopt(argc, argv, "f:Hn:w:c:RT")) != -1) {
+    switch(opt) {
+      case 'f':
+        if(!strcmp(optarg, "csv")) fmt = CSV;
+        else if(!strcmp(optarg, "json")) fmt = JSON;
+        else usage(argv[0]);
+        break;
+      case 'H': header = 1; break;
+      case 'n': ntests = strtoul(optarg, NULL, 10); break;
+      case 'w': nwarmup = strtoul(optarg, NULL, 10); break;
+      case 'c': cpu = atoi(optarg); break;
+      case 'R': counters = 0; break;
+      case 'T': cdpre_telemetry_enable(1); break;
+      default: usage(argv[0]);
+    }
+  }
+  if(ntests < 2)
+    usage(argv[0]);
+  if(cpu >= 0)
+    pin_cpu(cpu);
+  t = malloc((ntests+1)*sizeof(uint64_t));
+  if(!t)
+    return 1;
+  if(counters && !perf_init())
+    fprintf(stderr, "WARNING: hardware performance counters unavailable, using rdtsc\n");
+  if(header && fmt == CSV) {
+    printf("scheme,params,op,samples,median,mean,p90,p99,stddev,backend");
+    for(i=0;i<sizeof(columns)/sizeof(columns[0]);i++)
+      printf(",%s", columns[i].name);
+#ifdef CDPRE_STATS
+    for(i=0;i<CDPRE_STATS_NSTAGES;i++)
+      printf(",stage_%s", cdpre_stats_stage_names[i]);
+#endif
+    printf("\n");
+  }
+
+  randombytes(coins, KYBER_SYMBYTES);
+  randombytes(m, KYBER_INDCPA_MSGBYTES);
+
+  // Kyber KEM
+  BENCH("kyber", "keypair", crypto_kem_keypair(pk, sk));
+  BENCH("kyber", "enc", crypto_kem_enc(ct, key, pk));
+  BENCH("kyber", "dec", crypto_kem_dec(key, ct, sk));
+
+  // IND-CPA scheme, also the key generation, encryption and decryption of cdPRE
+  BENCH("indcpa", "keypair", indcpa_keypair_derand(pk_i, sk_i, coins));
+  BENCH("indcpa", "enc", indcpa_enc(ct_i, m, pk_i, coins));
+  BENCH("indcpa", "dec", indcpa_dec(m, ct_i, sk_i));
+
+  // cdPRE from i to j
+  randombytes(coins, KYBER_SYMBYTES);
+  indcpa_keypair_derand(pk_j, sk_j, coins);
+  BENCH("cdpre", "rkg", cdpre_rkg(sk_i, pk_j, ct_i, rk, coins));
+  BENCH("cdpre", "renc", cdpre_renc(rk, ct_i, ct_j));
+  BENCH("cdpre", "dec_re", indcpa_dec(m, ct_j, sk_j));
+
+  // satoPRE from i to j
+  BENCH("satopre", "keypair", satopre_keypair(spk_i, ssk_i, coins, m));
+  satopre_keypair(spk_j, ssk_j, m, coins);
+  BENCH("satopre", "enc", satopre_enc(ct_i, m, spk_i, coins));
+  BENCH("satopre", "dec", satopre_dec(m, ct_i, ssk_i));
+  BENCH("satopre", "rkg", satopre_rkg(ssk_i, spk_j, ssk_j, rk_sato, coins));
+  BENCH("satopre", "renc", satopre_renc(rk_sato, ct_i, ct_j));
+  BENCH("satopre", "dec_re", satopre_dec_re(m, ct_j, ssk_j));
+
+  perf_close();
+  free(t);
+  return 0;
+}
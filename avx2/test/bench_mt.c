@@ -0,0 +1,242 @@
+#define _GNU_SOURCE
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "../params.h"
+#include "../indcpa.h"
+#include "../cdpre.h"
+#include "../randombytes.h"
+
+/*
+ * Throughput benchmark: for n = 1..maxthreads, n threads pinned to
+ * distinct CPUs of the affinity mask of the process run one operation on
+ * independent keys and ciphertexts for a fixed duration. One line per
+ * (operation, n) is written to stdout as CSV or as one JSON object per line:
+ *
+ *   scheme,params,op,threads,ops,seconds,ops_per_sec,efficiency,bytes_per_op,api_mb_per_sec
+ *
+ * efficiency is ops_per_sec / (n * ops_per_sec with one thread).
+ * bytes_per_op counts the inputs and outputs of the API call, and
+ * api_mb_per_sec is ops_per_sec times bytes_per_op. It is a rate of API
+ * data, not a measured memory bandwidth: the buffers of each thread stay
+ * in its caches, and internal state such as the expanded matrix A is not
+ * counted.
+ */
+
+enum op { CDPRE_RENC, CDPRE_RKG, INDCPA_ENC, INDCPA_DEC, NOPS };
+
+static const struct {
+  const char *scheme;
+  const char *name;
+  size_t bytes;
+} ops[NOPS] = {
+  {"cdpre", "renc", 3*KYBER_INDCPA_BYTES},
+  {"cdpre", "rkg", KYBER_INDCPA_SECRETKEYBYTES + KYBER_INDCPA_PUBLICKEYBYTES + 2*KYBER_INDCPA_BYTES},
+  {"indcpa", "enc", KYBER_INDCPA_PUBLICKEYBYTES + KYBER_INDCPA_MSGBYTES + KYBER_SYMBYTES + KYBER_INDCPA_BYTES},
+  {"indcpa", "dec", KYBER_INDCPA_BYTES + KYBER_INDCPA_SECRETKEYBYTES + KYBER_INDCPA_MSGBYTES},
+};
+
+struct worker {
+  pthread_t tid;
+  int cpu;
+  enum op op;
+  uint64_t count;
+};
+
+static pthread_barrier_t start;
+static atomic_int stop;
+static int cpus[CPU_SETSIZE];
+
+static void *run(void *arg)
+{
+  struct worker *w = arg;
+  uint64_t n = 0;
+  int r;
+  cpu_set_t set;
+  uint8_t coins[KYBER_SYMBYTES];
+  uint8_t m[KYBER_INDCPA_MSGBYTES];
+  uint8_t pk_i[KYBER_INDCPA_PUBLICKEYBYTES];
+  uint8_t sk_i[KYBER_INDCPA_SECRETKEYBYTES];
+  uint8_t pk_j[KYBER_INDCPA_PUBLICKEYBYTES];
+  uint8_t sk_j[KYBER_INDCPA_SECRETKEYBYTES];
+  uint8_t ct_i[KYBER_INDCPA_BYTES];
+  uint8_t ct_j[KYBER_INDCPA_BYTES];
+  uint8_t rk[KYBER_INDCPA_BYTES];
+
+  CPU_ZERO(&set);
+  CPU_SET(w->cpu, &set);
+  r = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+  if(r) {
+    fprintf(stderr, "ERROR: pinning to CPU %d: %s\n", w->cpu, strerror(r));
+    exit(1);
+  }
+
+  // independent data per thread, first touched on its own CPU
+  randombytes(coins, KYBER_SYMBYTES);
+  randombytes(m, KYBER_INDCPA_MSGBYTES);
+  indcpa_keypair_derand(pk_i, sk_i, coins);
+  randombytes(coins, KYBER_SYMBYTES);
+  indcpa_keypair_derand(pk_j, sk_j, coins);
+  indcpa_enc(ct_i, m, pk_i, coins);
+  cdpre_rkg(sk_i, pk_j, ct_i, rk, coins);
+
+  pthread_barrier_wait(&start);
+  switch(w->op) {
+    case CDPRE_RENC:
+      for(;!atomic_load_explicit(&stop, memory_order_relaxed);n++)
+        cdpre_renc(rk, ct_i, ct_j);
+      break;
+    case CDPRE_RKG:
+      for(;!atomic_load_explicit(&stop, memory_order_relaxed);n++)
+        cdpre_rkg(sk_i, pk_j, ct_i, rk, coins);
+      break;
+    case INDCPA_ENC:
+      for(;!atomic_load_explicit(&stop, memory_order_relaxed);n++)
+        indcpa_enc(ct_j, m, pk_i, coins);
+      break;
+    case INDCPA_DEC:
+      for(;!atomic_load_explicit(&stop, memory_order_relaxed);n++)
+        indcpa_dec(m, ct_i, sk_i);
+      break;
+    default:
+      break;
+  }
+  w->count = n;
+  return NULL;
+}
+
+static double now(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + 1e-9*ts.tv_nsec;
+}
+
+/*************************************************
+* Name:        measure
+*
+* Description: Run op on nthreads threads for the given duration
+*
+* Arguments:   - enum op op: operation to run
+*              - unsigned int nthreads: number of threads
+*              - int ncpus: number of CPUs in cpus, threads are pinned to
+*                           them round-robin
+*              - double duration: duration in seconds
+*              - double *seconds: pointer to output measured duration
+*
+* Returns the number of operations completed by all threads
+**************************************************/
+static uint64_t measure(enum op op, unsigned int nthreads, int ncpus,
+                        double duration, double *seconds)
+{
+  unsigned int i;
+  uint64_t total = 0;
+  double t0;
+  struct timespec ts;
+  struct worker *w = calloc(nthreads, sizeof(struct worker));
+
+  if(!w)
+    exit(1);
+  atomic_store(&stop, 0);
+  pthread_barrier_init(&start, NULL, nthreads+1);
+  for(i=0;i<nthreads;i++) {
+    w[i].cpu = cpus[i % ncpus];
+    w[i].op = op;
+    if(pthread_create(&w[i].tid, NULL, run, &w[i])) {
+      fprintf(stderr, "ERROR: pthread_create\n");
+      exit(1);
+    }
+  }
+
+  pthread_barrier_wait(&start);
+  t0 = now();
+  ts.tv_sec = (time_t)duration;
+  ts.tv_nsec = (long)((duration - ts.tv_sec)*1e9);
+  nanosleep(&ts, NULL);
+  atomic_store(&stop, 1);
+  for(i=0;i<nthreads;i++) {
+    pthread_join(w[i].tid, NULL);
+    total += w[i].count;
+  }
+  *seconds = now() - t0;
+
+  pthread_barrier_destroy(&start);
+  free(w);
+  return total;
+}
+
+static void usage(const char *name)
+{
+  fprintf(stderr, "usage: %s [-f csv|json] [-H] [-t maxthreads] [-d seconds]\n"
+                  "  -H  print the CSV header line\n"
+                  "  -t  largest number of threads (default: number of CPUs the process may run on)\n"
+                  "  -d  duration of each measurement (default: 1.0)\n", name);
+  exit(1);
+}
+
+int main(int argc, char *argv[])
+{
+  unsigned int i, n, maxthreads;
+  int c, opt, json = 0, header = 0, ncpus = 0;
+  double duration = 1.0, seconds, rate, rate1 = 0;
+  uint64_t count;
+  cpu_set_t set;
+
+  // the CPUs we may run on, which need not be 0..n-1 under taskset or cgroups
+  if(sched_getaffinity(0, sizeof(set), &set)) {
+    perror("ERROR: sched_getaffinity");
+    return 1;
+  }
+  for(c=0;c<CPU_SETSIZE;c++)
+    if(CPU_ISSET(c, &set))
+      cpus[ncpus++] = c;
+  maxthreads = ncpus;
+
+  while((opt = getopt(argc, argv, "f:Ht:d:")) != -1) {
+    switch(opt) {
+      case 'f':
+        if(!strcmp(optarg, "csv")) json = 0;
+        else if(!strcmp(optarg, "json")) json = 1;
+        else usage(argv[0]);
+        break;
+      case 'H': header = 1; break;
+      case 't': maxthreads = strtoul(optarg, NULL, 10); break;
+      case 'd': duration = strtod(optarg, NULL); break;
+      default: usage(argv[0]);
+    }
+  }
+  if(maxthreads < 1 || duration <= 0)
+    usage(argv[0]);
+  if(header && !json)
+    printf("scheme,params,op,threads,ops,seconds,ops_per_sec,efficiency,bytes_per_op,api_mb_per_sec\n");
+
+  for(i=0;i<NOPS;i++) {
+    for(n=1;n<=maxthreads;n++) {
+      count = measure(i, n, ncpus, duration, &seconds);
+      rate = count/seconds;
+      if(n == 1)
+        rate1 = rate;
+      if(json)
+        printf("{\"scheme\": \"%s\", \"params\": %d, \"op\": \"%s\", \"threads\": %u, "
+               "\"ops\": %llu, \"seconds\": %.3f, \"ops_per_sec\": %.1f, \"efficiency\": %.3f, "
+               "\"bytes_per_op\": %zu, \"api_mb_per_sec\": %.1f}\n",
+               ops[i].scheme, KYBER_K*KYBER_N, ops[i].name, n, (unsigned long long)count,
+               seconds, rate, rate/(n*rate1), ops[i].bytes, rate*ops[i].bytes/1e6);
+      else
+        printf("%s,%d,%s,%u,%llu,%.3f,%.1f,%.3f,%zu,%.1f\n",
+               ops[i].scheme, KYBER_K*KYBER_N, ops[i].name, n, (unsigned long long)count,
+               seconds, rate, rate/(n*rate1), ops[i].bytes, rate*ops[i].bytes/1e6);
+      fflush(stdout);
+    }
+  }
+
+  return 0;
+}
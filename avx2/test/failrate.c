@@ -0,0 +1,647 @@
+#include <pthread.h>
+#include <immintrin.h>
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include "../params.h"
+#include "../indcpa.h"
+#include "../cdpre.h"
+#include "../poly.h"
+#include "../polyvec.h"
+#include "../cbd.h"
+#include "../fips202.h"
+#include "../randombytes.h"
+
+/*
+ * Monte-Carlo estimate of the decryption failure rate of cdPRE ciphertexts
+ * re-encrypted over h hops. For every message it records the noise
+ * n = v - s^T u - m*(q+1)/2 (centered mod q) of all KYBER_N coefficients in
+ * a histogram of |n|, and counts the coefficients and messages that
+ * poly_tomsg decodes wrongly.
+ *
+ *   full:  the real pipeline: indcpa_enc, h calls of cdpre_rkg,
+ *          cdpre_renc_chain (or h calls of cdpre_renc with -c) and
+ *          indcpa_dec, with the keys of the h+1 parties from
+ *          indcpa_keypair_derand. All coins come from the generator below.
+ *   noise: the noise terms only, e^T r + e2 - s^T (e1 + du) + dv for the
+ *          fresh ciphertext and e_j^T r_j - s_j^T (e_j' + du') + dv' per hop,
+ *          with CBD samples from a vectorized xoshiro256++ instead of SHAKE
+ *          and the compression errors du, dv of uniform values mod q, and
+ *          the error of compressing the sum of the decompressed v again in
+ *          re-encryption. The re-key compression (-u, -v) can differ from
+ *          the ciphertext's.
+ *
+ * The keys of all parties are new for every message, or for every k-th
+ * message with -k k, which saves their generation (full) or sampling and
+ * NTTs (noise).
+ *
+ * One line with the totals is written as CSV or JSON:
+ *
+ *   params,mode,hops,chained,du_rk,dv_rk,reuse,messages,coefficients,
+ *   coeff_failures,msg_failures,sigma,log2_pfail,log2_pfail_gauss
+ *
+ * log2_pfail_gauss is log2 of the failure probability per coefficient of a
+ * normal distribution with the measured sigma, for rates too small to be
+ * counted. With -x the histogram follows as "margin,count" lines (CSV) or
+ * as an array of pairs (JSON).
+ */
+
+#define DU (KYBER_POLYVECCOMPRESSEDBYTES/(KYBER_K*KYBER_N/8))
+#define DV (KYBER_POLYCOMPRESSEDBYTES/(KYBER_N/8))
+#define MAXHOPS 64
+#define NBINS (KYBER_Q/2+1)
+
+enum mode { MODE_NOISE, MODE_FULL };
+
+struct config {
+  enum mode mode;
+  unsigned int hops;
+  int chained;
+  unsigned int du_rk;
+  unsigned int dv_rk;
+  uint64_t reuse;
+  uint8_t seed[8];
+};
+
+struct worker {
+  pthread_t tid;
+  unsigned int id;
+  uint64_t messages;
+  uint64_t coeff_failures;
+  uint64_t msg_failures;
+  uint64_t hist[NBINS];
+};
+
+static struct config cfg;
+
+/* compression of x in [0,q) to d bits: decompressed value and error */
+static struct {
+  uint16_t y;
+  int16_t e;
+} rounding[13][KYBER_Q];
+
+/* four xoshiro256++ generators, one per 64-bit lane */
+typedef struct {
+  __m256i s[4];
+} prng;
+
+static __m256i rotl(__m256i x, int k)
+{
+  return _mm256_or_si256(_mm256_slli_epi64(x, k), _mm256_srli_epi64(x, 64-k));
+}
+
+static void prng_init(prng *g, unsigned int id)
+{
+  uint8_t in[12];
+  uint64_t s[16];
+
+  memcpy(in, cfg.seed, 8);
+  in[8] = id;
+  in[9] = id >> 8;
+  in[10] = id >> 16;
+  in[11] = id >> 24;
+  shake256((uint8_t *)s, sizeof(s), in, sizeof(in));
+  g->s[0] = _mm256_loadu_si256((__m256i *)&s[0]);
+  g->s[1] = _mm256_loadu_si256((__m256i *)&s[4]);
+  g->s[2] = _mm256_loadu_si256((__m256i *)&s[8]);
+  g->s[3] = _mm256_loadu_si256((__m256i *)&s[12]);
+}
+
+static void prng_fill(__m256i *r, size_t n, prng *g)
+{
+  size_t i;
+  __m256i t;
+
+  for(i=0;i<n;i++) {
+    r[i] = _mm256_add_epi64(rotl(_mm256_add_epi64(g->s[0], g->s[3]), 23), g->s[0]);
+    t = _mm256_slli_epi64(g->s[1], 17);
+    g->s[2] = _mm256_xor_si256(g->s[2], g->s[0]);
+    g->s[3] = _mm256_xor_si256(g->s[3], g->s[1]);
+    g->s[1] = _mm256_xor_si256(g->s[1], g->s[2]);
+    g->s[0] = _mm256_xor_si256(g->s[0], g->s[3]);
+    g->s[2] = _mm256_xor_si256(g->s[2], t);
+    g->s[3] = rotl(g->s[3], 45);
+  }
+}
+
+/* at most 32 bytes */
+static void prng_bytes(uint8_t *r, size_t len, prng *g)
+{
+  __m256i t;
+
+  prng_fill(&t, 1, g);
+  memcpy(r, &t, len);
+}
+
+/* compression of x in [0,q] to d bits and decompression, as in poly_compress_bits
+   and poly_decompress_bits */
+static unsigned int compress(unsigned int x, unsigned int d)
+{
+  return (((x << d) + KYBER_Q/2)/KYBER_Q) & ((1U << d) - 1);
+}
+
+static unsigned int decompress(unsigned int a, unsigned int d)
+{
+  return (a*KYBER_Q + (1U << (d-1))) >> d;
+}
+
+/*************************************************
+* Name:        init_rounding
+*
+* Description: Tabulate for every bit width d and x in [0,q) the value
+*              y = decompress(compress(x)) mod q and the centered error y - x
+**************************************************/
+static void init_rounding(void)
+{
+  unsigned int d, x, y;
+  int e;
+
+  for(d=1;d<=12;d++) {
+    for(x=0;x<KYBER_Q;x++) {
+      y = decompress(compress(x, d), d) % KYBER_Q;
+      e = (int)y - (int)x;
+      if(e > KYBER_Q/2)
+        e -= KYBER_Q;
+      if(e < -KYBER_Q/2)
+        e += KYBER_Q;
+      rounding[d][x].y = y;
+      rounding[d][x].e = e;
+    }
+  }
+}
+
+static void sample_eta1(polyvec *r, prng *g)
+{
+  unsigned int i;
+  __m256i buf[KYBER_ETA1*KYBER_N/128+1];
+
+  for(i=0;i<KYBER_K;i++) {
+    prng_fill(buf, KYBER_ETA1*KYBER_N/128+1, g);
+    poly_cbd_eta1(&r->vec[i], buf);
+  }
+}
+
+static void sample_eta2(poly *r, prng *g)
+{
+  __m256i buf[KYBER_ETA2*KYBER_N/128];
+
+  prng_fill(buf, KYBER_ETA2*KYBER_N/128, g);
+  poly_cbd_eta2(r, buf);
+}
+
+/*************************************************
+* Name:        lookup
+*
+* Description: Look up the decompressed values y and errors e of 16 values
+*              in rounding[d]; the table entries read as 32-bit integers
+*              have y in the low and e in the high 16 bits
+*
+* Arguments:   - __m256i *y: pointer to output y, 16-bit lanes
+*              - __m256i *e: pointer to output e, 16-bit lanes
+*              - __m256i x0: input values 0..7, 32-bit lanes
+*              - __m256i x1: input values 8..15, 32-bit lanes
+*              - unsigned int d: bit width
+**************************************************/
+static void lookup(__m256i *y, __m256i *e, __m256i x0, __m256i x1, unsigned int d)
+{
+  const __m256i mask = _mm256_set1_epi32(0xFFFF);
+  const int *t = (const int *)rounding[d];
+
+  x0 = _mm256_i32gather_epi32(t, x0, 4);
+  x1 = _mm256_i32gather_epi32(t, x1, 4);
+  *y = _mm256_packus_epi32(_mm256_and_si256(x0, mask), _mm256_and_si256(x1, mask));
+  *e = _mm256_packs_epi32(_mm256_srai_epi32(x0, 16), _mm256_srai_epi32(x1, 16));
+  *y = _mm256_permute4x64_epi64(*y, 0xD8);
+  *e = _mm256_permute4x64_epi64(*e, 0xD8);
+}
+
+/* floor(w*q/2^32) of eight 32-bit words, uniform in [0,q) */
+static __m256i uniform(__m256i w)
+{
+  const __m256i q = _mm256_set1_epi32(KYBER_Q);
+  __m256i lo, hi;
+
+  lo = _mm256_srli_epi64(_mm256_mul_epu32(w, q), 32);
+  hi = _mm256_mul_epu32(_mm256_srli_epi64(w, 32), q);
+  return _mm256_blend_epi32(lo, hi, 0xAA);
+}
+
+/*************************************************
+* Name:        add_compressed
+*
+* Description: Compress uniform values mod q to d bits; add the compression
+*              errors to r and, if s is not NULL, the decompressed values
+*              to s (mod q)
+**************************************************/
+static void add_compressed(poly *r, poly *s, unsigned int d, prng *g)
+{
+  unsigned int i;
+  __m256i buf[KYBER_N/8], y, e, f;
+  const __m256i q = _mm256_set1_epi16(KYBER_Q);
+  const __m256i qm1 = _mm256_set1_epi16(KYBER_Q-1);
+
+  prng_fill(buf, KYBER_N/8, g);
+  for(i=0;i<KYBER_N/16;i++) {
+    lookup(&y, &e, uniform(buf[2*i]), uniform(buf[2*i+1]), d);
+    r->vec[i] = _mm256_add_epi16(r->vec[i], e);
+    if(s) {
+      f = _mm256_add_epi16(s->vec[i], y);
+      s->vec[i] = _mm256_sub_epi16(f, _mm256_and_si256(_mm256_cmpgt_epi16(f, qm1), q));
+    }
+  }
+}
+
+/* compress the sum s of decompressed v as cdpre_renc does, add the error to r */
+static void recompress(poly *r, poly *s)
+{
+  unsigned int i;
+  __m256i y, e;
+
+  for(i=0;i<KYBER_N/16;i++) {
+    lookup(&y, &e, _mm256_cvtepu16_epi32(_mm256_castsi256_si128(s->vec[i])),
+           _mm256_cvtepu16_epi32(_mm256_extracti128_si256(s->vec[i], 1)), DV);
+    r->vec[i] = _mm256_add_epi16(r->vec[i], e);
+    s->vec[i] = y;
+  }
+}
+
+/* |w - mq| mod q, centered, for w in [0,q] and mq in {0,(q+1)/2} */
+static void margins(uint16_t n[KYBER_N], const poly *w, const poly *mq)
+{
+  unsigned int i;
+  __m256i f;
+  const __m256i q = _mm256_set1_epi16(KYBER_Q);
+  const __m256i qm1 = _mm256_set1_epi16(KYBER_Q-1);
+
+  for(i=0;i<KYBER_N/16;i++) {
+    f = _mm256_sub_epi16(w->vec[i], mq->vec[i]);
+    f = _mm256_add_epi16(f, _mm256_and_si256(_mm256_srai_epi16(f, 15), q));
+    f = _mm256_sub_epi16(f, _mm256_and_si256(_mm256_cmpgt_epi16(f, qm1), q));
+    f = _mm256_min_epi16(f, _mm256_sub_epi16(q, f));
+    _mm256_storeu_si256((__m256i *)&n[16*i], f);
+  }
+}
+
+/* keys of one party in the noise mode, in NTT domain */
+typedef struct {
+  polyvec s;
+  polyvec e;
+} party;
+
+/* keys of the parties 0..cfg.hops, party j+1 is the recipient of hop j */
+struct keys {
+  party *noise;
+  uint8_t (*pk)[KYBER_INDCPA_PUBLICKEYBYTES];
+  uint8_t (*sk)[KYBER_INDCPA_SECRETKEYBYTES];
+  uint8_t *rk;
+};
+
+static void new_keys(struct keys *k, prng *g)
+{
+  unsigned int j;
+  uint8_t coins[KYBER_SYMBYTES];
+
+  for(j=0;j<=cfg.hops;j++) {
+    if(cfg.mode == MODE_FULL) {
+      prng_bytes(coins, KYBER_SYMBYTES, g);
+      indcpa_keypair_derand(k->pk[j], k->sk[j], coins);
+    }
+    else {
+      sample_eta1(&k->noise[j].s, g);
+      sample_eta1(&k->noise[j].e, g);
+      polyvec_ntt(&k->noise[j].s);
+      polyvec_ntt(&k->noise[j].e);
+    }
+  }
+}
+
+/*************************************************
+* Name:        ciphertext_noise
+*
+* Description: Sample e^T x - s^T (y + du) for the keys s, e of a party,
+*              x with KYBER_ETA1, y with KYBER_ETA2 and the compression
+*              error du of d bits
+*
+* Arguments:   - poly *r: pointer to output polynomial
+*              - const party *p: pointer to keys in NTT domain
+*              - unsigned int d: bits of the compressed u
+*              - prng *g: pointer to generator
+**************************************************/
+static void ciphertext_noise(poly *r, const party *p, unsigned int d, prng *g)
+{
+  unsigned int i;
+  polyvec x, y;
+  poly t;
+
+  sample_eta1(&x, g);
+  for(i=0;i<KYBER_K;i++) {
+    sample_eta2(&y.vec[i], g);
+    add_compressed(&y.vec[i], NULL, d, g);
+  }
+  polyvec_ntt(&x);
+  polyvec_ntt(&y);
+  polyvec_basemul_acc_montgomery(r, &p->e, &x);
+  polyvec_basemul_acc_montgomery(&t, &p->s, &y);
+  poly_sub(r, r, &t);
+  poly_reduce(r);
+  poly_invntt_tomont(r);
+  poly_reduce(r);
+}
+
+/*************************************************
+* Name:        noise_trial
+*
+* Description: Sample the decryption noise of a ciphertext after cfg.hops
+*              re-encryptions, plus m*(q+1)/2, as the decryptor computes it
+*
+* Arguments:   - poly *w: pointer to output polynomial, v - s^T u
+*              - const struct keys *k: pointer to keys of the parties
+*              - const uint8_t *m: pointer to input message
+*              - prng *g: pointer to generator
+**************************************************/
+static void noise_trial(poly *w,
+                        const struct keys *k,
+                        const uint8_t m[KYBER_INDCPA_MSGBYTES],
+                        prng *g)
+{
+  unsigned int h;
+  poly v, t;
+
+  // fresh ciphertext: e^T r - s^T (e1 + du) + e2 + dv
+  memset(&v, 0, sizeof(v));
+  ciphertext_noise(w, &k->noise[0], DU, g);
+  sample_eta2(&t, g);
+  poly_add(w, w, &t);
+  add_compressed(w, &v, DV, g);
+  poly_reduce(w);
+
+  // re-key j: e_j^T r_j - s_j^T (e_j' + du') + dv', the s_i^T u_i of the
+  // re-key cancels with the previous ciphertext; v tracks the decompressed
+  // v parts that cdpre_renc adds and compresses again
+  for(h=0;h<cfg.hops;h++) {
+    ciphertext_noise(&t, &k->noise[h+1], cfg.du_rk, g);
+    add_compressed(&t, &v, cfg.dv_rk, g);
+    poly_add(w, w, &t);
+    if(cfg.chained || h == cfg.hops-1)
+      recompress(w, &v);
+    poly_reduce(w);
+  }
+
+  poly_frommsg(&t, m);
+  poly_add(w, w, &t);
+  poly_reduce(w);
+}
+
+/*************************************************
+* Name:        full_trial
+*
+* Description: Encrypt m to party 0, re-encrypt it cfg.hops times to the
+*              parties 1..cfg.hops and compute v - s^T u of the result
+*
+* Arguments:   - poly *w: pointer to output polynomial, v - s^T u
+*              - uint8_t *dec: pointer to output message from indcpa_dec
+*              - const struct keys *k: pointer to keys of the parties
+*              - const uint8_t *m: pointer to input message
+*              - prng *g: pointer to generator of all coins
+**************************************************/
+static void full_trial(poly *w,
+                       uint8_t dec[KYBER_INDCPA_MSGBYTES],
+                       const struct keys *k,
+                       const uint8_t m[KYBER_INDCPA_MSGBYTES],
+                       prng *g)
+{
+  unsigned int h;
+  uint8_t coins[KYBER_SYMBYTES];
+  uint8_t c[KYBER_INDCPA_BYTES];
+  uint8_t *rk = k->rk;
+  polyvec u, s;
+  poly t;
+
+  prng_bytes(coins, KYBER_SYMBYTES, g);
+  indcpa_enc(c, m, k->pk[0], coins);
+
+  // the re-key of hop h is made for the ciphertext after h hops; cdpre_rkg
+  // only uses its u, which is that of the previous re-key
+  for(h=0;h<cfg.hops;h++) {
+    prng_bytes(coins, KYBER_SYMBYTES, g);
+    cdpre_rkg(k->sk[h], k->pk[h+1], h ? rk+(h-1)*KYBER_INDCPA_BYTES : c,
+              rk+h*KYBER_INDCPA_BYTES, coins);
+    if(cfg.chained)
+      cdpre_renc(rk+h*KYBER_INDCPA_BYTES, c, c);
+  }
+  if(!cfg.chained)
+    cdpre_renc_chain(rk, cfg.hops, c, c);
+
+  indcpa_dec(dec, c, k->sk[cfg.hops]);
+
+  polyvec_decompress(&u, c);
+  poly_decompress(w, c+KYBER_POLYVECCOMPRESSEDBYTES);
+  polyvec_frombytes(&s, k->sk[cfg.hops]);
+  polyvec_ntt(&u);
+  polyvec_basemul_acc_montgomery(&t, &s, &u);
+  poly_invntt_tomont(&t);
+  poly_sub(w, w, &t);
+  poly_reduce(w);
+}
+
+static void *run(void *arg)
+{
+  struct worker *wk = arg;
+  uint64_t i;
+  unsigned int j, bad;
+  uint16_t n[KYBER_N];
+  uint8_t m[KYBER_INDCPA_MSGBYTES];
+  uint8_t dec[KYBER_INDCPA_MSGBYTES];
+  poly w, mq;
+  prng g;
+  struct keys k;
+
+  // polynomials are loaded with aligned loads
+  k.noise = aligned_alloc(64, (cfg.hops+1)*sizeof(party));
+  k.pk = malloc((cfg.hops+1)*sizeof(*k.pk));
+  k.sk = malloc((cfg.hops+1)*sizeof(*k.sk));
+  k.rk = malloc((cfg.hops+1)*KYBER_INDCPA_BYTES);
+  if(!k.noise || !k.pk || !k.sk || !k.rk) {
+    fprintf(stderr, "ERROR: malloc\n");
+    exit(1);
+  }
+
+  prng_init(&g, wk->id);
+  for(i=0;i<wk->messages;i++) {
+    if(i % cfg.reuse == 0)
+      new_keys(&k, &g);
+    prng_bytes(m, KYBER_INDCPA_MSGBYTES, &g);
+    if(cfg.mode == MODE_FULL)
+      full_trial(&w, dec, &k, m, &g);
+    else {
+      noise_trial(&w, &k, m, &g);
+      poly_tomsg(dec, &w);
+    }
+
+    poly_frommsg(&mq, m);
+    margins(n, &w, &mq);
+    for(j=0;j<KYBER_N;j++)
+      wk->hist[n[j]]++;
+    bad = 0;
+    for(j=0;j<KYBER_INDCPA_MSGBYTES;j++)
+      bad += __builtin_popcount(dec[j] ^ m[j]);
+    wk->coeff_failures += bad;
+    wk->msg_failures += bad > 0;
+  }
+
+  free(k.noise);
+  free(k.pk);
+  free(k.sk);
+  free(k.rk);
+  return NULL;
+}
+
+static void usage(const char *name)
+{
+  fprintf(stderr, "usage: %s [-m noise|full] [-n messages] [-h hops] [-c] [-u bits] [-v bits]\n"
+                  "          [-k messages] [-t threads] [-s seed] [-f csv|json] [-H] [-x]\n"
+                  "  -m  noise terms only (default) or the real pipeline\n"
+                  "  -n  number of messages (default 100000)\n"
+                  "  -h  number of re-encryptions, at most %d (default 1)\n"
+                  "  -c  re-encrypt hop by hop with cdpre_renc instead of cdpre_renc_chain\n"
+                  "  -u  bits of the compressed u of re-keys, noise mode (default %d)\n"
+                  "  -v  bits of the compressed v of re-keys, noise mode (default %d)\n"
+                  "  -k  messages per set of keys (default 1)\n"
+                  "  -t  number of threads (default: number of online CPUs)\n"
+                  "  -s  seed of the generators (default: random)\n"
+                  "  -H  print the CSV header line\n"
+                  "  -x  print the histogram of |v - s^T u - m*(q+1)/2|\n",
+          name, MAXHOPS, DU, DV);
+  exit(1);
+}
+
+int main(int argc, char *argv[])
+{
+  unsigned int i, j, nthreads;
+  int opt, json = 0, header = 0, hist = 0;
+  long ncpus;
+  uint64_t messages = 100000, seed = 0, coeffs, cf = 0, mf = 0;
+  uint64_t total[NBINS] = {0};
+  double var = 0, sigma, pf, pg;
+  char lpf[32], lpg[32];
+  struct worker *w;
+
+  ncpus = sysconf(_SC_NPROCESSORS_ONLN);
+  nthreads = ncpus < 1 ? 1 : ncpus;
+  cfg.mode = MODE_NOISE;
+  cfg.hops = 1;
+  cfg.du_rk = DU;
+  cfg.dv_rk = DV;
+  cfg.reuse = 1;
+  randombytes(cfg.seed, 8);
+
+  while((opt = getopt(argc, argv, "m:n:h:cu:v:k:t:s:f:Hx")) != -1) {
+    switch(opt) {
+      case 'm':
+        if(!strcmp(optarg, "noise")) cfg.mode = MODE_NOISE;
+        else if(!strcmp(optarg, "full")) cfg.mode = MODE_FULL;
+        else usage(argv[0]);
+        break;
+      case 'n': messages = strtoull(optarg, NULL, 10); break;
+      case 'h': cfg.hops = strtoul(optarg, NULL, 10); break;
+      case 'c': cfg.chained = 1; break;
+      case 'u': cfg.du_rk = strtoul(optarg, NULL, 10); break;
+      case 'v': cfg.dv_rk = strtoul(optarg, NULL, 10); break;
+      case 'k': cfg.reuse = strtoull(optarg, NULL, 10); break;
+      case 't': nthreads = strtoul(optarg, NULL, 10); break;
+      case 's':
+        seed = strtoull(optarg, NULL, 0);
+        for(i=0;i<8;i++)
+          cfg.seed[i] = seed >> 8*i;
+        break;
+      case 'f':
+        if(!strcmp(optarg, "csv")) json = 0;
+        else if(!strcmp(optarg, "json")) json = 1;
+        else usage(argv[0]);
+        break;
+      case 'H': header = 1; break;
+      case 'x': hist = 1; break;
+      default: usage(argv[0]);
+    }
+  }
+  if(nthreads < 1 || cfg.hops > MAXHOPS || messages < 1 || cfg.reuse < 1
+     || cfg.du_rk < 1 || cfg.du_rk > 12 || cfg.dv_rk < 1 || cfg.dv_rk > 12)
+    usage(argv[0]);
+  if(cfg.mode == MODE_FULL && (cfg.du_rk != DU || cfg.dv_rk != DV)) {
+    fprintf(stderr, "ERROR: cdpre_rkg compresses re-keys to %d and %d bits\n", DU, DV);
+    return 1;
+  }
+  if(nthreads > messages)
+    nthreads = messages;
+
+  init_rounding();
+  w = calloc(nthreads, sizeof(struct worker));
+  if(!w)
+    return 1;
+  for(i=0;i<nthreads;i++) {
+    w[i].id = i;
+    w[i].messages = messages/nthreads + (i < messages % nthreads);
+    if(pthread_create(&w[i].tid, NULL, run, &w[i])) {
+      fprintf(stderr, "ERROR: pthread_create\n");
+      return 1;
+    }
+  }
+  for(i=0;i<nthreads;i++) {
+    pthread_join(w[i].tid, NULL);
+    cf += w[i].coeff_failures;
+    mf += w[i].msg_failures;
+    for(j=0;j<NBINS;j++)
+      total[j] += w[i].hist[j];
+  }
+  free(w);
+
+  coeffs = messages*KYBER_N;
+  for(j=0;j<NBINS;j++)
+    var += (double)j*j*total[j];
+  sigma = sqrt(var/coeffs);
+  pf = (double)cf/coeffs;
+  pg = erfc((KYBER_Q/4 + 0.5)/(sigma*sqrt(2)));
+  strcpy(lpf, json ? "null" : "");
+  strcpy(lpg, json ? "null" : "");
+  if(cf)
+    snprintf(lpf, sizeof(lpf), "%.2f", log2(pf));
+  if(pg > 0)
+    snprintf(lpg, sizeof(lpg), "%.2f", log2(pg));
+
+  if(json) {
+    printf("{\"params\": %d, \"mode\": \"%s\", \"hops\": %u, \"chained\": %d, "
+           "\"du_rk\": %u, \"dv_rk\": %u, \"reuse\": %llu, \"messages\": %llu, \"coefficients\": %llu, "
+           "\"coeff_failures\": %llu, \"msg_failures\": %llu, \"sigma\": %.2f, "
+           "\"log2_pfail\": %s, \"log2_pfail_gauss\": %s",
+           KYBER_K*KYBER_N, cfg.mode == MODE_FULL ? "full" : "noise", cfg.hops, cfg.chained,
+           cfg.du_rk, cfg.dv_rk, (unsigned long long)cfg.reuse, (unsigned long long)messages, (unsigned long long)coeffs,
+           (unsigned long long)cf, (unsigned long long)mf, sigma, lpf, lpg);
+    if(hist) {
+      printf(", \"histogram\": [");
+      for(i=0,j=0;j<NBINS;j++)
+        if(total[j])
+          printf("%s[%u, %llu]", i++ ? ", " : "", j, (unsigned long long)total[j]);
+      printf("]");
+    }
+    printf("}\n");
+  }
+  else {
+    if(header)
+      printf("params,mode,hops,chained,du_rk,dv_rk,reuse,messages,coefficients,coeff_failures,"
+             "msg_failures,sigma,log2_pfail,log2_pfail_gauss\n");
+    printf("%d,%s,%u,%d,%u,%u,%llu,%llu,%llu,%llu,%llu,%.2f,%s,%s\n",
+           KYBER_K*KYBER_N, cfg.mode == MODE_FULL ? "full" : "noise", cfg.hops, cfg.chained,
+           cfg.du_rk, cfg.dv_rk, (unsigned long long)cfg.reuse, (unsigned long long)messages, (unsigned long long)coeffs,
+           (unsigned long long)cf, (unsigned long long)mf, sigma, lpf, lpg);
+    if(hist)
+      for(j=0;j<NBINS;j++)
+        if(total[j])
+          printf("%u,%llu\n", j, (unsigned long long)total[j]);
+  }
+
+  return 0;
+}
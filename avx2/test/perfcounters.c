@@ -0,0 +1,150 @@
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include "cpucycles.h"
+#include "perfcounters.h"
+
+/*
+ * Hardware performance counters through perf_event_open(2). All counters
+ * form one group led by the cycle counter, so they are started, stopped
+ * and scheduled together and only count in user space. If the cycle
+ * counter cannot be opened (no PMU, e.g. in many VMs, or a too restrictive
+ * kernel.perf_event_paranoid), the backend falls back to cpucycles(),
+ * i.e. rdtsc, for CNT_CYCLES and reports the other counters as
+ * unavailable; counters that the PMU does not support are reported as
+ * unavailable individually.
+ */
+
+static const struct {
+  uint32_t type;
+  uint64_t config;
+} events[NCOUNTERS] = {
+  {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+  {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+  {PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1D
+                       | (PERF_COUNT_HW_CACHE_OP_READ << 8)
+                       | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16)},
+  {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+  {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+};
+
+static int fd[NCOUNTERS] = {-1, -1, -1, -1, -1};
+static uint64_t tsc;
+
+static int open_event(unsigned int i, int group)
+{
+  struct perf_event_attr attr;
+
+  memset(&attr, 0, sizeof(attr));
+  attr.size = sizeof(attr);
+  attr.type = events[i].type;
+  attr.config = events[i].config;
+  attr.disabled = (group == -1);
+  attr.exclude_kernel = 1;
+  attr.exclude_hv = 1;
+  attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+  return syscall(SYS_perf_event_open, &attr, 0, -1, group, 0);
+}
+
+/*************************************************
+* Name:        perf_init
+*
+* Description: Open the counter group for the calling thread
+*
+* Returns the number of available hardware counters (0 if the
+* rdtsc fallback is used)
+**************************************************/
+int perf_init(void)
+{
+  unsigned int i;
+  int n = 0;
+
+  perf_close();
+  fd[CNT_CYCLES] = open_event(CNT_CYCLES, -1);
+  if(fd[CNT_CYCLES] < 0)
+    return 0;
+
+  for(i=0;i<NCOUNTERS;i++) {
+    if(i != CNT_CYCLES)
+      fd[i] = open_event(i, fd[CNT_CYCLES]);
+    n += fd[i] >= 0;
+  }
+  return n;
+}
+
+/*************************************************
+* Name:        perf_available
+*
+* Description: Whether perf_stop reports a count for a counter. CNT_CYCLES
+*              always has one: with the rdtsc backend it is the number of
+*              rdtsc ticks, not of core cycles.
+*
+* Arguments:   - enum counter c: counter
+*
+* Returns 1 if the counter is available, 0 otherwise
+**************************************************/
+int perf_available(enum counter c)
+{
+  return fd[c] >= 0 || c == CNT_CYCLES;
+}
+
+const char *perf_backend(void)
+{
+  return fd[CNT_CYCLES] >= 0 ? "perf_event" : "rdtsc";
+}
+
+void perf_start(void)
+{
+  if(fd[CNT_CYCLES] >= 0) {
+    ioctl(fd[CNT_CYCLES], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl(fd[CNT_CYCLES], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+  }
+  else
+    tsc = cpucycles();
+}
+
+/*************************************************
+* Name:        perf_stop
+*
+* Description: Stop counting and return the counts since perf_start; counts
+*              are scaled if the group was multiplexed with other events.
+*              Unavailable counters are returned as 0.
+*
+* Arguments:   - struct counters *c: pointer to output counts
+**************************************************/
+void perf_stop(struct counters *c)
+{
+  unsigned int i;
+  uint64_t r[3];
+
+  memset(c, 0, sizeof(*c));
+  if(fd[CNT_CYCLES] < 0) {
+    c->value[CNT_CYCLES] = cpucycles() - tsc;
+    return;
+  }
+
+  ioctl(fd[CNT_CYCLES], PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+  for(i=0;i<NCOUNTERS;i++) {
+    if(fd[i] < 0 || read(fd[i], r, sizeof(r)) != sizeof(r))
+      continue;
+    // r = {value, time enabled, time running}
+    if(r[2] && r[2] < r[1])
+      r[0] = (uint64_t)((double)r[0]*r[1]/r[2]);
+    c->value[i] = r[0];
+  }
+}
+
+void perf_close(void)
+{
+  unsigned int i;
+
+  for(i=0;i<NCOUNTERS;i++) {
+    if(fd[i] >= 0)
+      close(fd[i]);
+    fd[i] = -1;
+  }
+}
@@ -0,0 +1,26 @@
+#ifndef PERFCOUNTERS_H
+#define PERFCOUNTERS_H
+
+#include <stdint.h>
+
+enum counter {
+  CNT_CYCLES,
+  CNT_INSTRUCTIONS,
+  CNT_L1D_MISSES,
+  CNT_LLC_MISSES,
+  CNT_BRANCH_MISSES,
+  NCOUNTERS
+};
+
+struct counters {
+  uint64_t value[NCOUNTERS];
+};
+
+int perf_init(void);
+int perf_available(enum counter c);
+const char *perf_backend(void);
+void perf_start(void);
+void perf_stop(struct counters *c);
+void perf_close(void);
+
+#endif
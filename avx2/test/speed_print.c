@@ -0,0 +1,90 @@
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <math.h>
+#include "cpucycles.h"
+#include "speed_print.h"
+
+static int cmp_uint64(const void *a, const void *b) {
+  if(*(uint64_t *)a < *(uint64_t *)b) return -1;
+  if(*(uint64_t *)a > *(uint64_t *)b) return 1;
+  return 0;
+}
+
+static uint64_t median(uint64_t *l, size_t llen) {
+  qsort(l,llen,sizeof(uint64_t),cmp_uint64);
+
+  if(llen%2) return l[llen/2];
+  else return (l[llen/2-1]+l[llen/2])/2;
+}
+
+static uint64_t average(uint64_t *t, size_t tlen) {
+  size_t i;
+  uint64_t acc=0;
+
+  for(i=0;i<tlen;i++)
+    acc += t[i];
+
+  return acc/tlen;
+}
+
+static uint64_t percentile(const uint64_t *l, size_t llen, unsigned int p) {
+  size_t i = (llen*p + 99)/100;
+
+  return l[i ? i-1 : 0];
+}
+
+static size_t to_cycles(uint64_t *t, size_t tlen) {
+  size_t i;
+  static uint64_t overhead = -1;
+
+  if(overhead  == (uint64_t)-1)
+    overhead = cpucycles_overhead();
+
+  tlen--;
+  for(i=0;i<tlen;++i)
+    t[i] = t[i+1] - t[i] - overhead;
+
+  return tlen;
+}
+
+void get_stats(struct speed_stats *s, uint64_t *t, size_t tlen) {
+  size_t i;
+  double d, var = 0;
+
+  if(tlen < 3) {
+    fprintf(stderr, "ERROR: Need a least three cycle counts!\n");
+    return;
+  }
+
+  tlen = to_cycles(t, tlen);
+  s->samples = tlen;
+  s->median = median(t, tlen); // sorts t
+  s->p90 = percentile(t, tlen, 90);
+  s->p99 = percentile(t, tlen, 99);
+
+  s->mean = 0;
+  for(i=0;i<tlen;i++)
+    s->mean += t[i];
+  s->mean /= tlen;
+  for(i=0;i<tlen;i++) {
+    d = t[i] - s->mean;
+    var += d*d;
+  }
+  s->stddev = sqrt(var/(tlen-1));
+}
+
+void print_results(const char *s, uint64_t *t, size_t tlen) {
+  if(tlen < 2) {
+    fprintf(stderr, "ERROR: Need a least two cycle counts!\n");
+    return;
+  }
+
+  tlen = to_cycles(t, tlen);
+
+  printf("%s\n", s);
+  printf("median: %llu cycles/ticks\n", (unsigned long long)median(t, tlen));
+  printf("average: %llu cycles/ticks\n", (unsigned long long)average(t, tlen));
+  printf("\n");
+}
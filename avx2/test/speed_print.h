@@ -1 +0,0 @@
-../../ref/test/speed_print.h
\ No newline at end of file
@@ -0,0 +1,19 @@
+#ifndef PRINT_SPEED_H
+#define PRINT_SPEED_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+struct speed_stats {
+  size_t samples;
+  uint64_t median;
+  uint64_t p90;
+  uint64_t p99;
+  double mean;
+  double stddev;
+};
+
+void print_results(const char *s, uint64_t *t, size_t tlen);
+void get_stats(struct speed_stats *s, uint64_t *t, size_t tlen);
+
+#endif
@@ -0,0 +1,83 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "../kem.h"
+#include "../params.h"
+#include "../indcpa.h"
+#include "../randombytes.h"
+
+#define NTESTS 250
+
+/*
+ * The four-way batched functions must give, lane by lane, the same output
+ * as four calls of the single functions.
+ */
+
+static int check(const char *name, unsigned int lane, const uint8_t *a, const uint8_t *b, size_t len)
+{
+  if(memcmp(a, b, len)) {
+    fprintf(stderr, "ERROR %s lane %u\n", name, lane);
+    return -1;
+  }
+  return 0;
+}
+
+static uint8_t pk[4][CRYPTO_PUBLICKEYBYTES], pk1[CRYPTO_PUBLICKEYBYTES];
+static uint8_t sk[4][CRYPTO_SECRETKEYBYTES], sk1[CRYPTO_SECRETKEYBYTES];
+static uint8_t coins[4][2*KYBER_SYMBYTES];
+
+#define MAXMSGS 11
+static uint8_t m[MAXMSGS][KYBER_INDCPA_MSGBYTES], m1[KYBER_INDCPA_MSGBYTES];
+static uint8_t c[MAXMSGS][KYBER_INDCPA_BYTES], c1[KYBER_INDCPA_BYTES];
+static uint8_t ecoins[MAXMSGS][KYBER_SYMBYTES];
+
+int main(void)
+{
+  unsigned int i, l, n;
+  uint8_t *ppk[4] = {pk[0], pk[1], pk[2], pk[3]};
+  uint8_t *psk[4] = {sk[0], sk[1], sk[2], sk[3]};
+  const uint8_t *pcoins[4] = {coins[0], coins[1], coins[2], coins[3]};
+
+  for(i=0;i<NTESTS;i++) {
+    randombytes(coins[0], sizeof(coins));
+
+    indcpa_keypair_derand_x4(ppk, psk, pcoins);
+    for(l=0;l<4;l++) {
+      indcpa_keypair_derand(pk1, sk1, coins[l]);
+      if(check("indcpa_keypair_derand_x4 pk", l, pk[l], pk1, KYBER_INDCPA_PUBLICKEYBYTES)
+      || check("indcpa_keypair_derand_x4 sk", l, sk[l], sk1, KYBER_INDCPA_SECRETKEYBYTES))
+        return -1;
+    }
+
+    crypto_kem_keypair_derand_x4(ppk, psk, pcoins);
+    for(l=0;l<4;l++) {
+      crypto_kem_keypair_derand(pk1, sk1, coins[l]);
+      if(check("crypto_kem_keypair_derand_x4 pk", l, pk[l], pk1, CRYPTO_PUBLICKEYBYTES)
+      || check("crypto_kem_keypair_derand_x4 sk", l, sk[l], sk1, CRYPTO_SECRETKEYBYTES))
+        return -1;
+    }
+
+    // batches of 1 to MAXMSGS messages, full and partial runs of four
+    n = 1 + i % MAXMSGS;
+    randombytes(m[0], sizeof(m));
+    randombytes(ecoins[0], sizeof(ecoins));
+    indcpa_enc_batch(c[0], m[0], n, pk[0], ecoins[0]);
+    for(l=0;l<n;l++) {
+      indcpa_enc(c1, m[l], pk[0], ecoins[l]);
+      if(check("indcpa_enc_batch", l, c[l], c1, KYBER_INDCPA_BYTES))
+        return -1;
+    }
+
+    // also garbage ciphertexts, whose messages are not those encrypted
+    if(i % 2)
+      randombytes(c[0], sizeof(c));
+    indcpa_dec_batch(m[0], c[0], n, sk[0]);
+    for(l=0;l<n;l++) {
+      indcpa_dec(m1, c[l], sk[0]);
+      if(check("indcpa_dec_batch", l, m[l], m1, KYBER_INDCPA_MSGBYTES))
+        return -1;
+    }
+  }
+
+  return 0;
+}
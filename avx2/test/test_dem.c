@@ -0,0 +1,214 @@
+#include <fcntl.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "../dem.h"
+#include "../fips202.h"
+#include "../randombytes.h"
+
+/*
+ * The ciphertexts of payloads of several lengths under the key 0, ..., 15
+ * and the nonce 16, ..., 31, hashed together with SHAKE256, must match a
+ * Python model of the duplex on its own Keccak-f[1600]. For random payloads
+ * of lengths around the block and chunk sizes, encrypting in a buffer and
+ * from a file must give the same ciphertext, which must decrypt to the
+ * payload both ways. Flipped bits, truncated ciphertexts, swapped and
+ * dropped chunks and wrong keys must be rejected, with the output erased.
+ */
+
+#define MAXCHUNKS 9
+#define MAXBYTES (MAXCHUNKS*DEM_CHUNKBYTES + 300)
+#define STRIDE (DEM_CHUNKBYTES + DEM_TAGBYTES)
+
+static const uint8_t expected[32] = {
+  0xba, 0xe5, 0xb9, 0x33, 0x95, 0xb1, 0x15, 0xfa, 0xa6, 0x25, 0xb1, 0x86, 0xfc, 0x02, 0x9c, 0xea,
+  0xb5, 0xb8, 0x55, 0x68, 0xf4, 0x62, 0x25, 0x3a, 0x71, 0x9c, 0x97, 0xcf, 0xd0, 0x8b, 0x0f, 0x63
+};
+
+static const size_t katlengths[] = {0, 1, 127, 128, 129, DEM_CHUNKBYTES, 4*DEM_CHUNKBYTES + 200};
+
+static const size_t lengths[] = {
+  0, 1, 127, 128, 129, DEM_CHUNKBYTES-1, DEM_CHUNKBYTES, DEM_CHUNKBYTES+1,
+  3*DEM_CHUNKBYTES, 4*DEM_CHUNKBYTES, 5*DEM_CHUNKBYTES+7, MAXBYTES
+};
+
+static uint8_t m[MAXBYTES], m2[MAXBYTES];
+static uint8_t c[DEM_CIPHERTEXTBYTES(MAXBYTES)], c2[DEM_CIPHERTEXTBYTES(MAXBYTES)+1];
+
+static int write_file(const char *path, const uint8_t *buf, size_t len)
+{
+  FILE *f;
+  int r;
+
+  f = fopen(path, "wb");
+  if(!f)
+    return -1;
+  r = fwrite(buf, 1, len, f) != len;
+  return fclose(f) || r ? -1 : 0;
+}
+
+static size_t read_file(uint8_t *buf, size_t maxlen, const char *path)
+{
+  FILE *f;
+  size_t len;
+
+  f = fopen(path, "rb");
+  if(!f)
+    return 0;
+  len = fread(buf, 1, maxlen, f);
+  fclose(f);
+  return len;
+}
+
+// stream from the file at pin to the file at pout
+static int run_fd(const char *pout, const char *pin, const uint8_t key[DEM_KEYBYTES],
+                  const uint8_t *nonce)
+{
+  int in, out, r;
+
+  in = open(pin, O_RDONLY);
+  out = open(pout, O_WRONLY | O_TRUNC);
+  if(in < 0 || out < 0)
+    return -2;
+  r = nonce ? dem_encrypt_fd(out, in, key, nonce) : dem_decrypt_fd(out, in, key);
+  close(in);
+  close(out);
+  return r;
+}
+
+// a corrupted ciphertext c2 of clen bytes must be rejected both ways
+static int check_reject(size_t clen, const uint8_t key[DEM_KEYBYTES],
+                        const char *pin, const char *pout, const char *what)
+{
+  size_t i, mlen;
+
+  memset(m2, 0, sizeof(m2));
+  if(dem_decrypt(m2, &mlen, c2, clen, key) == 0 || mlen != 0) {
+    fprintf(stderr, "ERROR dem_decrypt accepts %s\n", what);
+    return -1;
+  }
+  for(i=0;i<MAXBYTES;i++) {
+    if(m2[i] != 0) {
+      fprintf(stderr, "ERROR dem_decrypt output of %s not erased\n", what);
+      return -1;
+    }
+  }
+  if(write_file(pin, c2, clen) || run_fd(pout, pin, key, NULL) != -1) {
+    fprintf(stderr, "ERROR dem_decrypt_fd accepts %s\n", what);
+    return -1;
+  }
+  return 0;
+}
+
+static int check_length(size_t len, const char *pin, const char *pout)
+{
+  unsigned int i;
+  size_t clen = DEM_CIPHERTEXTBYTES(len), mlen, nfull = len/DEM_CHUNKBYTES, pos;
+  uint8_t key[DEM_KEYBYTES], nonce[DEM_NONCEBYTES], bit;
+
+  randombytes(key, DEM_KEYBYTES);
+  randombytes(nonce, DEM_NONCEBYTES);
+  randombytes(m, len);
+
+  dem_encrypt(c, m, len, key, nonce);
+  if(dem_decrypt(m2, &mlen, c, clen, key) || mlen != len || memcmp(m, m2, len)) {
+    fprintf(stderr, "ERROR dem_decrypt of %zu bytes\n", len);
+    return -1;
+  }
+
+  if(write_file(pin, m, len) || run_fd(pout, pin, key, nonce)
+     || read_file(c2, sizeof(c2), pout) != clen || memcmp(c, c2, clen)) {
+    fprintf(stderr, "ERROR dem_encrypt_fd of %zu bytes\n", len);
+    return -1;
+  }
+  if(write_file(pin, c, clen) || run_fd(pout, pin, key, NULL)
+     || read_file(m2, sizeof(m2), pout) != len || memcmp(m, m2, len)) {
+    fprintf(stderr, "ERROR dem_decrypt_fd of %zu bytes\n", len);
+    return -1;
+  }
+
+  // flipped bits in the header, the first and the last chunk, a random place
+  for(i=0;i<4;i++) {
+    randombytes(&bit, 1);
+    randombytes((uint8_t *)&pos, sizeof(pos));
+    pos = (i == 0) ? pos % DEM_HEADERBYTES : (i == 1) ? DEM_HEADERBYTES : (i == 2) ? clen-1 : pos % clen;
+    memcpy(c2, c, clen);
+    c2[pos] ^= 1 << (bit & 7);
+    if(check_reject(clen, key, pin, pout, "a flipped bit"))
+      return -1;
+  }
+
+  memcpy(c2, c, clen);
+  if(check_reject(clen-1, key, pin, pout, "a truncated chunk"))
+    return -1;
+  c2[clen] = 0;
+  if(check_reject(clen+1, key, pin, pout, "an extended chunk"))
+    return -1;
+  if(nfull && check_reject(DEM_HEADERBYTES + nfull*STRIDE, key, pin, pout, "a dropped last chunk"))
+    return -1;
+  if(nfull && check_reject(DEM_HEADERBYTES + (nfull-1)*STRIDE + DEM_TAGBYTES, key, pin, pout,
+                           "a truncation at a chunk boundary"))
+    return -1;
+  if(nfull >= 2) {
+    memcpy(c2 + DEM_HEADERBYTES, c + DEM_HEADERBYTES + STRIDE, STRIDE);
+    memcpy(c2 + DEM_HEADERBYTES + STRIDE, c + DEM_HEADERBYTES, STRIDE);
+    if(check_reject(clen, key, pin, pout, "swapped chunks"))
+      return -1;
+  }
+
+  memcpy(c2, c, clen);
+  key[0] ^= 1;
+  if(check_reject(clen, key, pin, pout, "a wrong key"))
+    return -1;
+  return 0;
+}
+
+int main(void)
+{
+  int fd, r = 0;
+  unsigned int i;
+  size_t k;
+  uint8_t key[DEM_KEYBYTES], nonce[DEM_NONCEBYTES], h[32];
+  char pin[] = "/tmp/test_dem.XXXXXX", pout[] = "/tmp/test_dem.XXXXXX";
+  keccak_state acc;
+
+  for(i=0;i<DEM_KEYBYTES;i++)
+    key[i] = i;
+  for(i=0;i<DEM_NONCEBYTES;i++)
+    nonce[i] = DEM_KEYBYTES + i;
+  for(k=0;k<MAXBYTES;k++)
+    m[k] = 7*k + 3;
+
+  shake256_init(&acc);
+  for(i=0;i<sizeof(katlengths)/sizeof(katlengths[0]);i++) {
+    dem_encrypt(c, m, katlengths[i], key, nonce);
+    shake256_absorb(&acc, c, DEM_CIPHERTEXTBYTES(katlengths[i]));
+  }
+  shake256_finalize(&acc);
+  shake256_squeeze(h, 32, &acc);
+  if(memcmp(h, expected, 32)) {
+    fprintf(stderr, "ERROR dem_encrypt\n");
+    return 1;
+  }
+
+  fd = mkstemp(pin);
+  if(fd < 0)
+    return 1;
+  close(fd);
+  fd = mkstemp(pout);
+  if(fd < 0) {
+    unlink(pin);
+    return 1;
+  }
+  close(fd);
+
+  for(i=0;i<sizeof(lengths)/sizeof(lengths[0]) && !r;i++)
+    r = check_length(lengths[i], pin, pout);
+
+  unlink(pin);
+  unlink(pout);
+  return r ? 1 : 0;
+}
@@ -0,0 +1,117 @@
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "../fips202.h"
+
+/*
+ * SHA3-256, SHA3-512, SHAKE128 and SHAKE256 of every input length up to
+ * MAXIN bytes, with output lengths around the rates for SHAKE, must match
+ * Python's hashlib; the outputs are hashed together and compared against
+ * the digests below. The incremental SHAKE API must give the same output
+ * as the one-shot functions when absorbing and squeezing in pieces.
+ */
+
+#define MAXIN  (2*SHAKE128_RATE + 9)
+#define MAXOUT (2*SHAKE128_RATE + 9)
+
+static const uint8_t expected[4][32] = {
+  /* sha3_256 */
+  {0x35, 0xcc, 0x27, 0xb5, 0xc8, 0xfc, 0x63, 0x64, 0x1b, 0x1b, 0x41, 0xb4, 0xde, 0xe3, 0x6d, 0x21,
+   0x4c, 0xa0, 0x58, 0x3f, 0x04, 0x63, 0x0b, 0xc9, 0xff, 0x99, 0x79, 0x8e, 0x68, 0xb4, 0xba, 0xf7},
+  /* sha3_512 */
+  {0xce, 0x76, 0xdb, 0xfa, 0x37, 0x71, 0x53, 0xac, 0x28, 0xa0, 0x5e, 0xab, 0x24, 0xcf, 0xd7, 0x90,
+   0x7b, 0x8d, 0x8c, 0x96, 0x6a, 0x0d, 0xef, 0x09, 0x33, 0xe6, 0xed, 0x48, 0x6c, 0x48, 0xbb, 0xa8},
+  /* shake128 */
+  {0x44, 0x57, 0x19, 0xc6, 0xef, 0xd7, 0x8e, 0xe5, 0x25, 0x21, 0x65, 0x1a, 0x0e, 0x8e, 0xcf, 0x8c,
+   0xff, 0x30, 0xed, 0x63, 0x5b, 0x71, 0x99, 0x57, 0xe3, 0x6a, 0x3a, 0x7c, 0xd3, 0x15, 0x9d, 0x30},
+  /* shake256 */
+  {0x96, 0x8d, 0x0d, 0x55, 0x9d, 0xd0, 0x32, 0xae, 0xf2, 0x4d, 0x5a, 0x31, 0x44, 0x1a, 0x76, 0x5f,
+   0x74, 0x50, 0xfd, 0xcc, 0x2c, 0x51, 0xd2, 0x49, 0x96, 0x65, 0x38, 0x9e, 0x1f, 0x2f, 0x48, 0x1b}
+};
+
+static const char *names[4] = {"sha3_256", "sha3_512", "shake128", "shake256"};
+
+static uint8_t in[MAXIN];
+static uint8_t out[MAXOUT];
+static uint8_t ref[MAXOUT];
+
+static int check_incremental(const char *name,
+                             void (*init)(keccak_state *),
+                             void (*absorb)(keccak_state *, const uint8_t *, size_t),
+                             void (*finalize)(keccak_state *),
+                             void (*squeeze)(uint8_t *, size_t, keccak_state *),
+                             void (*oneshot)(uint8_t *, size_t, const uint8_t *, size_t),
+                             size_t inlen,
+                             size_t step)
+{
+  size_t i, n;
+  keccak_state state;
+
+  oneshot(ref, MAXOUT, in, inlen);
+
+  init(&state);
+  for(i = 0; i < inlen; i += n) {
+    n = (inlen - i < step) ? inlen - i : step;
+    absorb(&state, in + i, n);
+  }
+  finalize(&state);
+  for(i = 0; i < MAXOUT; i += n) {
+    n = (MAXOUT - i < step) ? MAXOUT - i : step;
+    squeeze(out + i, n, &state);
+  }
+
+  if(memcmp(out, ref, MAXOUT)) {
+    fprintf(stderr, "ERROR %s incremental inlen %zu step %zu\n", name, inlen, step);
+    return -1;
+  }
+  return 0;
+}
+
+int main(void)
+{
+  size_t i, n, outlen;
+  uint8_t h[32];
+  keccak_state acc[4];
+
+  for(i = 0; i < MAXIN; i++)
+    in[i] = 7*i + 3;
+
+  for(i = 0; i < 4; i++)
+    shake256_init(&acc[i]);
+
+  for(n = 0; n <= MAXIN; n++) {
+    outlen = 1 + n % MAXOUT;
+
+    sha3_256(out, in, n);
+    shake256_absorb(&acc[0], out, 32);
+    sha3_512(out, in, n);
+    shake256_absorb(&acc[1], out, 64);
+    shake128(out, outlen, in, n);
+    shake256_absorb(&acc[2], out, outlen);
+    shake256(out, outlen, in, n);
+    shake256_absorb(&acc[3], out, outlen);
+  }
+
+  for(i = 0; i < 4; i++) {
+    shake256_finalize(&acc[i]);
+    shake256_squeeze(h, 32, &acc[i]);
+    if(memcmp(h, expected[i], 32)) {
+      fprintf(stderr, "ERROR %s\n", names[i]);
+      return -1;
+    }
+  }
+
+  for(n = 0; n <= MAXIN; n += 13) {
+    for(i = 1; i < 20; i += 6) {
+      if(check_incremental("shake128", shake128_init, shake128_absorb, shake128_finalize,
+                           shake128_squeeze, shake128, n, i))
+        return -1;
+      if(check_incremental("shake256", shake256_init, shake256_absorb, shake256_finalize,
+                           shake256_squeeze, shake256, n, i))
+        return -1;
+    }
+  }
+
+  return 0;
+}
@@ -0,0 +1,91 @@
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "../fips202.h"
+#include "../fips202x8.h"
+
+/*
+ * Every lane of shake128x8 and shake256x8 must agree with shake128 and
+ * shake256 on inputs and outputs of lengths around the rates, also when the
+ * output is squeezed block by block.
+ */
+
+#ifdef KECCAK_X8
+#define MAXIN  (2*SHAKE128_RATE + 1)
+#define MAXOUT (3*SHAKE128_RATE + 1)
+
+static const size_t inlens[] = {0, 1, 7, 8, 33, 34, 135, 136, 137, 167, 168, 169, MAXIN};
+static const size_t outlens[] = {1, 32, 135, 136, 168, 500, MAXOUT};
+
+static uint8_t in[8][MAXIN];
+static uint8_t out[8][MAXOUT];
+static uint8_t ref[MAXOUT];
+
+static int check(const char *name,
+                 void (*shake)(uint8_t *, size_t, const uint8_t *, size_t),
+                 size_t outlen,
+                 size_t inlen)
+{
+  unsigned int j;
+
+  for(j=0;j<8;j++) {
+    shake(ref, outlen, in[j], inlen);
+    if(memcmp(ref, out[j], outlen)) {
+      fprintf(stderr, "ERROR %s lane %u inlen %zu outlen %zu\n", name, j, inlen, outlen);
+      return -1;
+    }
+  }
+  return 0;
+}
+
+int main(void)
+{
+  unsigned int a, b, j;
+  const uint8_t *pin[8];
+  uint8_t *pout[8];
+  keccakx8_state state;
+
+  for(j=0;j<8;j++) {
+    for(a=0;a<MAXIN;a++)
+      in[j][a] = 31*j + 7*a;
+    pin[j] = in[j];
+    pout[j] = out[j];
+  }
+
+  for(a=0;a<sizeof(inlens)/sizeof(inlens[0]);a++) {
+    for(b=0;b<sizeof(outlens)/sizeof(outlens[0]);b++) {
+      shake128x8(pout, outlens[b], pin, inlens[a]);
+      if(check("shake128x8", shake128, outlens[b], inlens[a]))
+        return -1;
+      shake256x8(pout, outlens[b], pin, inlens[a]);
+      if(check("shake256x8", shake256, outlens[b], inlens[a]))
+        return -1;
+    }
+
+    shake128x8_absorb_once(&state, pin, inlens[a]);
+    for(b=0;b<3;b++) {
+      shake128x8_squeezeblocks(pout, 1, &state);
+      for(j=0;j<8;j++)
+        pout[j] += SHAKE128_RATE;
+    }
+    for(j=0;j<8;j++)
+      pout[j] = out[j];
+    if(check("shake128x8_squeezeblocks", shake128, 3*SHAKE128_RATE, inlens[a]))
+      return -1;
+
+    shake256x8_absorb_once(&state, pin, inlens[a]);
+    shake256x8_squeezeblocks(pout, 3, &state);
+    if(check("shake256x8_squeezeblocks", shake256, 3*SHAKE256_RATE, inlens[a]))
+      return -1;
+  }
+
+  return 0;
+}
+#else
+int main(void)
+{
+  fprintf(stderr, "test_fips202x8: built without AVX-512, nothing to test\n");
+  return 0;
+}
+#endif
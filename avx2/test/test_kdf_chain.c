@@ -0,0 +1,204 @@
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "../fips202.h"
+#include "../kdfchain.h"
+
+/*
+ * The symmetric keys of the first NKAT epochs from the root 0, 1, ..., 15,
+ * hashed together with SHAKE256, must match Python's hashlib. For chains of
+ * several lengths, kdf_chain_key and iterators started anywhere must give
+ * the keys of walking the chain from the root, also after a round trip
+ * through a checkpoint file, which only its owner may read; truncated or
+ * corrupted files must be rejected, and so must files with a correct tag
+ * but a different interval or a header promising more checkpoints than the
+ * file holds.
+ */
+
+#define NKAT 1000
+
+static const uint8_t expected[32] = {
+  0x92, 0x52, 0x34, 0x20, 0xbd, 0xf6, 0xea, 0x7f, 0xd2, 0xf5, 0xd6, 0xcf, 0x43, 0xf7, 0x69, 0xa4,
+  0x60, 0x41, 0x78, 0x53, 0x8c, 0x85, 0x62, 0xc2, 0x72, 0x1b, 0x2b, 0x22, 0xf7, 0xbe, 0xee, 0xac
+};
+
+static const uint64_t lengths[] = {1, 2, 3, 4, 5, 15, 16, 17, 99, 100, 101, NKAT};
+
+static uint8_t sek[NKAT][KDF_CHAIN_KEYBYTES];
+static uint8_t dk[NKAT][KDF_CHAIN_KEYBYTES];
+
+static int check_chain(const struct kdf_chain *c, uint64_t n)
+{
+  uint64_t e, f;
+  uint8_t s[KDF_CHAIN_KEYBYTES], d[KDF_CHAIN_KEYBYTES];
+  struct kdf_chain_iter it;
+
+  if(c->nepochs != n || c->interval*c->interval < n || (c->interval-1)*(c->interval-1) >= n) {
+    fprintf(stderr, "ERROR kdf_chain interval %llu for %llu epochs\n",
+            (unsigned long long)c->interval, (unsigned long long)n);
+    return -1;
+  }
+
+  for(e=0;e<n;e++) {
+    if(kdf_chain_key(s, d, c, e) || memcmp(s, sek[e], KDF_CHAIN_KEYBYTES)
+       || memcmp(d, dk[e], KDF_CHAIN_KEYBYTES)) {
+      fprintf(stderr, "ERROR kdf_chain_key epoch %llu of %llu\n", (unsigned long long)e, (unsigned long long)n);
+      return -1;
+    }
+  }
+  if(kdf_chain_key(s, d, c, n) == 0) {
+    fprintf(stderr, "ERROR kdf_chain_key beyond %llu epochs\n", (unsigned long long)n);
+    return -1;
+  }
+
+  for(e=0;e<n;e+=7) {
+    if(kdf_chain_iter_seek(&it, c, e))
+      return -1;
+    for(f=e;f<NKAT;f++) {
+      if(kdf_chain_next(s, &it) != f || memcmp(s, sek[f], KDF_CHAIN_KEYBYTES)) {
+        fprintf(stderr, "ERROR kdf_chain_next epoch %llu from %llu\n", (unsigned long long)f, (unsigned long long)e);
+        return -1;
+      }
+    }
+  }
+  return 0;
+}
+
+static void store64(uint8_t x[8], uint64_t u)
+{
+  unsigned int i;
+
+  for(i=0;i<8;i++)
+    x[i] = u >> 8*i;
+}
+
+// write the header and ncp checkpoints of buf with their tag to path
+static void write_tagged(const char *path, const uint8_t *buf, uint64_t ncp)
+{
+  FILE *f;
+  uint8_t t[32];
+
+  shake256(t, 32, buf, 24 + 16*ncp);
+  f = fopen(path, "wb");
+  fwrite(buf, 1, 24 + 16*ncp, f);
+  fwrite(t, 1, 32, f);
+  fclose(f);
+}
+
+static int check_file(const struct kdf_chain *c, uint64_t n, const char *path)
+{
+  FILE *f;
+  long len;
+  uint8_t *buf;
+  struct kdf_chain c1;
+  struct stat st;
+
+  if(chmod(path, 0644) || kdf_chain_save(c, path) || kdf_chain_load(&c1, path)) {
+    fprintf(stderr, "ERROR kdf_chain_save/load\n");
+    return -1;
+  }
+  if(stat(path, &st) || (st.st_mode & 0777) != 0600) {
+    fprintf(stderr, "ERROR kdf_chain_save mode %o\n", (unsigned int)(st.st_mode & 0777));
+    return -1;
+  }
+  if(check_chain(&c1, n))
+    return -1;
+  kdf_chain_free(&c1);
+
+  f = fopen(path, "rb");
+  if(!f || fseek(f, 0, SEEK_END) || (len = ftell(f)) < 0)
+    return -1;
+  rewind(f);
+  buf = malloc(len);
+  if(!buf || fread(buf, 1, len, f) != (size_t)len) {
+    fclose(f);
+    free(buf);
+    return -1;
+  }
+  fclose(f);
+  if(len != (long)(56 + 16*((n + c->interval - 1)/c->interval))) {
+    fprintf(stderr, "ERROR kdf_chain_save size %ld\n", len);
+    free(buf);
+    return -1;
+  }
+
+  // truncated, and with one bit flipped
+  f = fopen(path, "wb");
+  fwrite(buf, 1, len-1, f);
+  fclose(f);
+  if(kdf_chain_load(&c1, path) == 0)
+    goto err;
+  buf[n % len] ^= 1;
+  f = fopen(path, "wb");
+  fwrite(buf, 1, len, f);
+  fclose(f);
+  if(kdf_chain_load(&c1, path) == 0)
+    goto err;
+  buf[n % len] ^= 1;
+
+  // one more epoch between checkpoints
+  store64(buf+16, c->interval + 1);
+  write_tagged(path, buf, (n + c->interval)/(c->interval + 1));
+  if(kdf_chain_load(&c1, path) == 0)
+    goto err;
+
+  // 2^48 epochs in a file of n
+  store64(buf+8, UINT64_C(1) << 48);
+  store64(buf+16, UINT64_C(1) << 24);
+  write_tagged(path, buf, (n + c->interval - 1)/c->interval);
+  if(kdf_chain_load(&c1, path) == 0)
+    goto err;
+  free(buf);
+  return 0;
+
+err:
+  fprintf(stderr, "ERROR kdf_chain_load accepted a damaged file\n");
+  kdf_chain_free(&c1);
+  free(buf);
+  return -1;
+}
+
+int main(void)
+{
+  int fd, r = 0;
+  unsigned int i;
+  uint8_t root[KDF_CHAIN_KEYBYTES], h[32];
+  char path[] = "/tmp/test_kdf_chain.XXXXXX";
+  keccak_state acc;
+  struct kdf_chain c;
+
+  for(i=0;i<KDF_CHAIN_KEYBYTES;i++)
+    root[i] = i;
+
+  shake256_init(&acc);
+  memcpy(dk[0], root, KDF_CHAIN_KEYBYTES);
+  for(i=0;i<NKAT;i++) {
+    kdf_chain_step(sek[i], i+1 < NKAT ? dk[i+1] : h, dk[i], i);
+    shake256_absorb(&acc, sek[i], KDF_CHAIN_KEYBYTES);
+  }
+  shake256_finalize(&acc);
+  shake256_squeeze(h, 32, &acc);
+  if(memcmp(h, expected, 32)) {
+    fprintf(stderr, "ERROR kdf_chain_step\n");
+    return 1;
+  }
+
+  fd = mkstemp(path);
+  if(fd < 0)
+    return 1;
+  close(fd);
+
+  for(i=0;i<sizeof(lengths)/sizeof(lengths[0]) && !r;i++) {
+    if(kdf_chain_init(&c, root, lengths[i]))
+      return 1;
+    r = check_chain(&c, lengths[i]) || check_file(&c, lengths[i], path);
+    kdf_chain_free(&c);
+  }
+
+  unlink(path);
+  return r;
+}
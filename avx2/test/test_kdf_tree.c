@@ -0,0 +1,230 @@
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "../fips202.h"
+#include "../kdftree.h"
+#include "../randombytes.h"
+
+/*
+ * The epoch keys of a tree of NKAT epochs from the root 0, 1, ..., 15,
+ * hashed together with SHAKE256, must match Python's hashlib. For random
+ * sets of epoch ranges on trees of several sizes, the cover must be the
+ * ordered, disjoint set of nodes with exactly the epochs of the set and no
+ * two siblings, and iterating over the keys of its nodes must give the
+ * epoch keys derived from the root, as must expanding them breadth-first
+ * into an array. A range over a tree of 2^40 epochs must be covered by at
+ * most 80 nodes.
+ */
+
+#define NKAT 1000
+#define NTESTS 200
+#define MAXEPOCHS 1024
+#define MAXRANGES 8
+#define MAXCOVER (2*MAXRANGES*11)
+
+static const uint8_t expected[32] = {
+  0xd6, 0xf7, 0x1f, 0x59, 0xdf, 0x44, 0xa7, 0x08, 0xe7, 0x73, 0x8e, 0xad, 0xec, 0x26, 0x50, 0x28,
+  0xaa, 0x7c, 0x2f, 0x1f, 0x35, 0x87, 0x73, 0x93, 0x0b, 0x95, 0xe7, 0xad, 0x9d, 0x33, 0x6f, 0x8d
+};
+
+static const uint64_t sizes[] = {1, 2, 3, 7, 8, 9, 100, 1000, MAXEPOCHS};
+
+static uint8_t sek[MAXEPOCHS][KDF_TREE_KEYBYTES];
+static uint8_t leaves[MAXEPOCHS+1][KDF_TREE_KEYBYTES];
+
+// expand each node into leaves, which must not be written past its epochs
+static int check_expand(uint8_t (*keys)[KDF_TREE_KEYBYTES],
+                        const struct kdf_tree_node *cover,
+                        size_t ncover,
+                        const struct kdf_tree *t)
+{
+  size_t k, n;
+  uint64_t first;
+
+  for(k=0;k<ncover;k++) {
+    first = cover[k].index << (t->depth - cover[k].depth);
+    memset(leaves, 0xAA, sizeof(leaves));
+    n = kdf_tree_expand(leaves, MAXEPOCHS, keys[k], cover[k], t->nepochs);
+    if(n == 0 || first + n > t->nepochs
+       || (first + n < t->nepochs && ((first + n) >> (t->depth - cover[k].depth)) == cover[k].index)
+       || memcmp(leaves, sek[first], n*KDF_TREE_KEYBYTES) || leaves[n][0] != 0xAA
+       || (n > 1 && kdf_tree_expand(leaves, n-1, keys[k], cover[k], t->nepochs) != n)
+       || leaves[n-1][0] != sek[first+n-1][0]) {
+      fprintf(stderr, "ERROR kdf_tree_expand node %u/%llu\n", cover[k].depth, (unsigned long long)cover[k].index);
+      return -1;
+    }
+  }
+  return 0;
+}
+
+// iterate over the epochs below each node and mark them in covered
+static int check_iter(uint8_t covered[MAXEPOCHS],
+                      uint8_t (*keys)[KDF_TREE_KEYBYTES],
+                      const struct kdf_tree_node *cover,
+                      size_t ncover,
+                      uint64_t nepochs)
+{
+  size_t k;
+  uint64_t e, prev;
+  uint8_t s[KDF_TREE_KEYBYTES];
+  struct kdf_tree_iter it;
+
+  prev = 0;
+  for(k=0;k<ncover;k++) {
+    if(kdf_tree_iter_init(&it, keys[k], cover[k], nepochs)) {
+      fprintf(stderr, "ERROR kdf_tree_iter_init\n");
+      return -1;
+    }
+    while(kdf_tree_next(s, &e, &it) == 0) {
+      if(e >= nepochs || covered[e] || (e < prev) || memcmp(s, sek[e], KDF_TREE_KEYBYTES)) {
+        fprintf(stderr, "ERROR kdf_tree_next epoch %llu\n", (unsigned long long)e);
+        return -1;
+      }
+      covered[e] = 1;
+      prev = e;
+    }
+  }
+  return 0;
+}
+
+static int check_cover(const struct kdf_tree *t)
+{
+  unsigned int i, nranges;
+  size_t k, ncover;
+  uint64_t e, r[2];
+  uint8_t in[MAXEPOCHS], covered[MAXEPOCHS], key[KDF_TREE_KEYBYTES];
+  uint8_t keys[MAXCOVER][KDF_TREE_KEYBYTES];
+  struct kdf_tree_range ranges[MAXRANGES];
+  struct kdf_tree_node cover[MAXCOVER];
+
+  randombytes((uint8_t *)&nranges, sizeof(nranges));
+  nranges = nranges % MAXRANGES + 1;
+  memset(in, 0, sizeof(in));
+  for(i=0;i<nranges;i++) {
+    randombytes((uint8_t *)r, sizeof(r));
+    ranges[i].first = r[0] % (t->nepochs + 2);
+    ranges[i].end = ranges[i].first + r[1] % (t->nepochs/2 + 2);
+    for(e=ranges[i].first;e<ranges[i].end && e<t->nepochs;e++)
+      in[e] = 1;
+  }
+
+  ncover = kdf_tree_cover(cover, MAXCOVER, ranges, nranges, t->nepochs);
+  if(ncover > MAXCOVER || (ncover && kdf_tree_cover(cover, 1, ranges, nranges, t->nepochs) != ncover)) {
+    fprintf(stderr, "ERROR kdf_tree_cover size %zu\n", ncover);
+    return -1;
+  }
+  for(k=1;k<ncover;k++) {
+    if(cover[k].depth == cover[k-1].depth && (cover[k].index ^ cover[k-1].index) == 1
+       && (cover[k].index & 1)) {
+      fprintf(stderr, "ERROR kdf_tree_cover not minimal\n");
+      return -1;
+    }
+  }
+
+  if(kdf_tree_cover_keys(keys, t, cover, ncover))
+    return -1;
+  for(k=0;k<ncover;k++) {
+    if(kdf_tree_node_key(key, t, cover[k]) || memcmp(key, keys[k], KDF_TREE_KEYBYTES)) {
+      fprintf(stderr, "ERROR kdf_tree_cover_keys\n");
+      return -1;
+    }
+  }
+
+  memset(covered, 0, sizeof(covered));
+  if(check_iter(covered, keys, cover, ncover, t->nepochs) || check_expand(keys, cover, ncover, t))
+    return -1;
+  if(memcmp(in, covered, sizeof(in))) {
+    fprintf(stderr, "ERROR kdf_tree_cover epochs\n");
+    return -1;
+  }
+  return 0;
+}
+
+static int check_large(const uint8_t root[KDF_TREE_KEYBYTES])
+{
+  unsigned int i;
+  size_t k, ncover;
+  uint64_t e, n = UINT64_C(1) << 40;
+  uint8_t s[KDF_TREE_KEYBYTES], key[KDF_TREE_KEYBYTES];
+  uint8_t keys[80][KDF_TREE_KEYBYTES];
+  struct kdf_tree t;
+  struct kdf_tree_range range = {3, (UINT64_C(1) << 40) - 5};
+  struct kdf_tree_node cover[80];
+  struct kdf_tree_iter it;
+
+  if(kdf_tree_init(&t, root, n))
+    return -1;
+  ncover = kdf_tree_cover(cover, 80, &range, 1, n);
+  if(ncover > 80 || kdf_tree_cover_keys(keys, &t, cover, ncover)) {
+    fprintf(stderr, "ERROR kdf_tree_cover of 2^40 epochs: %zu nodes\n", ncover);
+    return -1;
+  }
+
+  // the first 100 epochs of the first and the last node
+  for(k=0;k<ncover;k++) {
+    if(k > 0 && k < ncover-1)
+      continue;
+    if(kdf_tree_iter_init(&it, keys[k], cover[k], n))
+      return -1;
+    for(i=0;i<100 && kdf_tree_next(s, &e, &it) == 0;i++) {
+      if(kdf_tree_epoch_key(key, &t, e) || memcmp(s, key, KDF_TREE_KEYBYTES)) {
+        fprintf(stderr, "ERROR kdf_tree_next epoch %llu of 2^40\n", (unsigned long long)e);
+        return -1;
+      }
+    }
+  }
+  if(e != range.end-1) {
+    fprintf(stderr, "ERROR kdf_tree_next last epoch %llu of 2^40\n", (unsigned long long)e);
+    return -1;
+  }
+  return 0;
+}
+
+int main(void)
+{
+  unsigned int i, j;
+  uint64_t e;
+  uint8_t root[KDF_TREE_KEYBYTES], h[32];
+  keccak_state acc;
+  struct kdf_tree t;
+  const struct kdf_tree_node a = {2, 1}, b = {4, 9};
+
+  for(i=0;i<KDF_TREE_KEYBYTES;i++)
+    root[i] = i;
+
+  if(kdf_tree_init(&t, root, NKAT))
+    return 1;
+  shake256_init(&acc);
+  for(e=0;e<NKAT;e++) {
+    if(kdf_tree_epoch_key(h, &t, e))
+      return 1;
+    shake256_absorb(&acc, h, KDF_TREE_KEYBYTES);
+  }
+  shake256_finalize(&acc);
+  shake256_squeeze(h, 32, &acc);
+  if(memcmp(h, expected, 32) || kdf_tree_epoch_key(h, &t, NKAT) == 0) {
+    fprintf(stderr, "ERROR kdf_tree_epoch_key\n");
+    return 1;
+  }
+  if(kdf_tree_derive(h, root, a, b) == 0) {
+    fprintf(stderr, "ERROR kdf_tree_derive from a node that is not an ancestor\n");
+    return 1;
+  }
+
+  for(i=0;i<sizeof(sizes)/sizeof(sizes[0]);i++) {
+    randombytes(root, KDF_TREE_KEYBYTES);
+    if(kdf_tree_init(&t, root, sizes[i]))
+      return 1;
+    for(e=0;e<sizes[i];e++)
+      kdf_tree_epoch_key(sek[e], &t, e);
+    for(j=0;j<NTESTS;j++)
+      if(check_cover(&t))
+        return 1;
+  }
+
+  if(check_large(root))
+    return 1;
+
+  return 0;
+}
@@ -0,0 +1,98 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "../params.h"
+#include "../poly.h"
+#include "../polyvec.h"
+#include "../ntt.h"
+#include "../cbd.h"
+#include "../rejsample.h"
+#include "../randombytes.h"
+
+#define NTESTS 1000
+
+/*
+ * The AVX-512 rejection sampler, CBD samplers and ciphertext compression
+ * must agree bit for bit with the AVX2 versions on random inputs.
+ */
+
+#ifdef KYBER_AVX512_VBMI
+static int check(const char *name, const void *a, const void *b, size_t len)
+{
+  if(memcmp(a, b, len)) {
+    fprintf(stderr, "ERROR %s\n", name);
+    return -1;
+  }
+  return 0;
+}
+
+int main(void)
+{
+  unsigned int i, j, ctr0, ctr1;
+  uint8_t buf[REJ_UNIFORM_AVX_BUFLEN];
+  ALIGNED_UINT8(KYBER_ETA1*KYBER_N/4+32) noise;
+  uint8_t c0[KYBER_POLYVECCOMPRESSEDBYTES/KYBER_K+2];
+  uint8_t c1[KYBER_POLYVECCOMPRESSEDBYTES/KYBER_K+2];
+  poly r0, r1;
+
+  for(i=0;i<NTESTS;i++) {
+    // uniform bytes, or with the top two bits of one or both candidates
+    // in every three bytes set, so that the buffer runs out before KYBER_N
+    randombytes(buf, sizeof(buf));
+    for(j=0;j<sizeof(buf);j++) {
+      if(i % 3 > 0 && j % 3 == 1)
+        buf[j] |= 0x0C;
+      if(i % 3 > 1 && j % 3 == 2)
+        buf[j] |= 0xC0;
+    }
+    memset(&r0, 0, sizeof(r0));
+    memset(&r1, 0, sizeof(r1));
+    ctr0 = rej_uniform_avx2(r0.coeffs, buf);
+    ctr1 = rej_uniform_avx512(r1.coeffs, buf);
+    if(ctr0 != ctr1) {
+      fprintf(stderr, "ERROR rej_uniform_avx512 count %u != %u\n", ctr1, ctr0);
+      return -1;
+    }
+    if(check("rej_uniform_avx512", r0.coeffs, r1.coeffs, ctr0*sizeof(int16_t)))
+      return -1;
+
+    randombytes(noise.coeffs, sizeof(noise));
+    cbd2_avx2(&r0, noise.vec);
+    cbd2_avx512(&r1, noise.vec);
+    if(check("cbd2_avx512", &r0, &r1, sizeof(poly)))
+      return -1;
+#if KYBER_ETA1 == 3
+    cbd3_avx2(&r0, noise.coeffs);
+    cbd3_avx512(&r1, noise.coeffs);
+    if(check("cbd3_avx512", &r0, &r1, sizeof(poly)))
+      return -1;
+#endif
+
+    // coefficients in [0, q), the input range of polyvec_compress
+    randombytes((uint8_t *)r0.coeffs, sizeof(r0.coeffs));
+    for(j=0;j<KYBER_N;j++)
+      r0.coeffs[j] = (uint16_t)r0.coeffs[j] % KYBER_Q;
+    memset(c0, 0, sizeof(c0));
+    memset(c1, 0, sizeof(c1));
+#if (KYBER_POLYVECCOMPRESSEDBYTES == (KYBER_K * 320))
+    poly_compress10_avx2(c0, &r0);
+    poly_compress10_avx512(c1, &r0);
+    if(check("poly_compress10_avx512", c0, c1, 320))
+      return -1;
+#elif (KYBER_POLYVECCOMPRESSEDBYTES == (KYBER_K * 352))
+    poly_compress11_avx2(c0, &r0);
+    poly_compress11_avx512(c1, &r0);
+    if(check("poly_compress11_avx512", c0, c1, 352))
+      return -1;
+#endif
+  }
+
+  return 0;
+}
+#else
+int main(void)
+{
+  fprintf(stderr, "test_kernels: built without AVX-512 VBMI, nothing to test\n");
+  return 0;
+}
+#endif
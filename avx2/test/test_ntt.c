@@ -0,0 +1,93 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "../params.h"
+#include "../poly.h"
+#include "../polyvec.h"
+#include "../ntt.h"
+#include "../consts.h"
+#include "../randombytes.h"
+
+#define NTESTS 1000
+
+/*
+ * The AVX-512 NTT, inverse NTT and basemul must agree bit for bit with the
+ * AVX2 assembly on random inputs within the input bounds of poly_ntt(),
+ * poly_invntt_tomont() and poly_basemul_montgomery().
+ */
+
+#ifdef KYBER_AVX512
+// random coefficients in (-bound, bound), or arbitrary for bound = 0
+static void poly_random(poly *r, int32_t bound)
+{
+  unsigned int i;
+  uint16_t buf[KYBER_N];
+
+  randombytes((uint8_t *)buf, sizeof(buf));
+  for(i=0;i<KYBER_N;i++)
+    if(bound)
+      r->coeffs[i] = (int16_t)((int32_t)(buf[i] % (2*bound - 1)) - (bound - 1));
+    else
+      r->coeffs[i] = (int16_t)buf[i];
+}
+
+static int check(const char *name, const poly *a, const poly *b)
+{
+  if(memcmp(a->coeffs, b->coeffs, sizeof(a->coeffs))) {
+    fprintf(stderr, "ERROR %s\n", name);
+    return -1;
+  }
+  return 0;
+}
+
+int main(void)
+{
+  unsigned int i, j;
+  poly a, b, r0, r1, tmp;
+  polyvec u, v;
+
+  for(i=0;i<NTESTS;i++) {
+    poly_random(&a, KYBER_Q);
+    r0 = r1 = a;
+    ntt_avx(r0.vec, qdata.vec);
+    ntt_avx512(r1.vec, qdata.vec);
+    if(check("ntt_avx512", &r0, &r1))
+      return -1;
+
+    poly_random(&a, 0);
+    r0 = r1 = a;
+    invntt_avx(r0.vec, qdata.vec);
+    invntt_avx512(r1.vec, qdata.vec);
+    if(check("invntt_avx512", &r0, &r1))
+      return -1;
+
+    poly_random(&a, KYBER_Q);
+    poly_random(&b, 0);
+    basemul_avx(r0.vec, a.vec, b.vec, qdata.vec);
+    basemul_avx512(r1.vec, a.vec, b.vec, qdata.vec);
+    if(check("basemul_avx512", &r0, &r1))
+      return -1;
+
+    for(j=0;j<KYBER_K;j++) {
+      poly_random(&u.vec[j], KYBER_Q);
+      poly_random(&v.vec[j], 0);
+    }
+    basemul_avx(r0.vec, u.vec[0].vec, v.vec[0].vec, qdata.vec);
+    for(j=1;j<KYBER_K;j++) {
+      basemul_avx(tmp.vec, u.vec[j].vec, v.vec[j].vec, qdata.vec);
+      poly_add(&r0, &r0, &tmp);
+    }
+    basemul_acc_avx512(r1.vec, u.vec[0].vec, v.vec[0].vec, KYBER_K, qdata.vec);
+    if(check("basemul_acc_avx512", &r0, &r1))
+      return -1;
+  }
+
+  return 0;
+}
+#else
+int main(void)
+{
+  fprintf(stderr, "test_ntt: built without AVX-512, nothing to test\n");
+  return 0;
+}
+#endif
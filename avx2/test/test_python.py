@@ -0,0 +1,182 @@
+# Checks the CPython extension modules cdpre512, cdpre768 and cdpre1024
+# (built with `make python`): re-encrypted ciphertexts decrypt to the
+# message, the batch functions give the outputs of the single ones, inputs
+# of any buffer type are accepted, out= is written in place, wrong lengths
+# are rejected and the GIL is released during the calls. cdpre512 is also
+# compared with libcdpre.so (built with `make shared`) through ctypes.
+
+import array
+import ctypes
+import importlib
+import os
+import sys
+import threading
+import time
+
+here = os.path.dirname(os.path.abspath(__file__))
+sys.path.insert(0, os.path.dirname(here))
+
+
+def check(cond, what):
+    if not cond:
+        raise SystemExit("ERROR " + what)
+
+
+def check_raises(exc, f, *args, **kwargs):
+    try:
+        f(*args, **kwargs)
+    except exc:
+        return
+    raise SystemExit("ERROR %s accepts %r" % (f.__name__, [type(a).__name__ for a in args]))
+
+
+def check_roundtrip(mod):
+    """One hop from key pair i to key pair j decrypts to the message."""
+    pk_i, sk_i = mod.keygen()
+    pk_j, sk_j = mod.keygen()
+    m = os.urandom(mod.MSGBYTES)
+    c_i = mod.enc(m, pk_i)
+    check(mod.dec(c_i, sk_i) == m, "dec")
+    rk = mod.rkg(sk_i, pk_j, c_i)
+    check(mod.dec(mod.renc(rk, c_i), sk_j) == m, "renc")
+
+
+def check_batch(mod, n):
+    """The batch functions give the outputs of n single calls."""
+    coins = os.urandom(n * mod.SYMBYTES)
+    pks, sks = mod.keygen_batch(n, coins)
+    check(len(pks) == n * mod.PUBLICKEYBYTES and len(sks) == n * mod.SECRETKEYBYTES, "keygen_batch size")
+    for k in range(n):
+        pk, sk = mod.keygen(coins[k * mod.SYMBYTES:(k + 1) * mod.SYMBYTES])
+        check(pks[k * mod.PUBLICKEYBYTES:(k + 1) * mod.PUBLICKEYBYTES] == pk
+              and sks[k * mod.SECRETKEYBYTES:(k + 1) * mod.SECRETKEYBYTES] == sk, "keygen_batch")
+
+    pk_i, sk_i = mod.keygen()
+    pk_j, sk_j = mod.keygen()
+    m = os.urandom(n * mod.MSGBYTES)
+    c = mod.enc_batch(m, pk_i, coins)
+    rk = mod.rkg_batch(sk_i, pk_j, c, coins)
+    cj = mod.renc_batch(rk, c)
+    check(mod.dec_batch(c, sk_i) == m and mod.dec_batch(cj, sk_j) == m, "dec_batch")
+    ct = mod.CIPHERTEXTBYTES
+    for k in range(n):
+        s = slice(k * ct, (k + 1) * ct)
+        mk = m[k * mod.MSGBYTES:(k + 1) * mod.MSGBYTES]
+        ck = coins[k * mod.SYMBYTES:(k + 1) * mod.SYMBYTES]
+        check(mod.enc(mk, pk_i, ck) == c[s], "enc_batch")
+        check(mod.rkg(sk_i, pk_j, c[s], ck) == rk[s], "rkg_batch")
+        check(mod.renc(rk[s], c[s]) == cj[s], "renc_batch")
+        check(mod.dec(c[s], sk_i) == mk, "dec_batch")
+
+
+def check_buffers(mod):
+    """Any contiguous buffer is read in place, out= is written in place."""
+    pk_i, sk_i = mod.keygen()
+    pk_j, sk_j = mod.keygen()
+    m = os.urandom(3 * mod.MSGBYTES)
+    c = mod.enc_batch(m, pk_i)
+    rk = mod.rkg_batch(sk_i, pk_j, c)
+    cj = mod.renc_batch(rk, c)
+
+    big = bytearray(10) + bytearray(rk) + bytearray(10)
+    for b in (bytearray(rk), memoryview(rk), memoryview(big)[10:-10], array.array('B', rk),
+              array.array('I', rk)):
+        check(mod.renc_batch(b, c) == cj, "renc_batch on " + type(b).__name__)
+
+    out = bytearray(len(c))
+    check(mod.renc_batch(rk, c, out=out) is out and out == cj, "renc_batch out=")
+    out = bytearray(c)
+    mod.renc_batch(rk, out, out=out)
+    check(out == cj, "renc_batch in place")
+    out = memoryview(bytearray(len(m)))
+    check(mod.dec_batch(cj, sk_j, out=out) is out and out == m, "dec_batch out=")
+
+    check_raises(ValueError, mod.renc, rk, c)
+    check_raises(ValueError, mod.renc_batch, rk[1:], c[1:])
+    check_raises(ValueError, mod.enc, m, pk_i)
+    check_raises(ValueError, mod.dec, c[:mod.CIPHERTEXTBYTES], sk_i[1:])
+    check_raises(ValueError, mod.keygen, b"short")
+    check_raises(ValueError, mod.keygen_batch, -1)
+    check_raises(ValueError, mod.dec_batch, c, sk_i, out=bytearray(1))
+    check_raises(TypeError, mod.dec_batch, c, sk_i, out=bytes(len(m)))
+    check_raises(TypeError, mod.renc, "a string", c)
+    check_raises((TypeError, BufferError), mod.renc_batch, memoryview(big)[::2], c)
+
+
+def check_threads(mod):
+    """Python code runs while a call is in C, and threads get equal results."""
+    pk_i, sk_i = mod.keygen()
+    pk_j, _ = mod.keygen()
+    c = mod.enc_batch(os.urandom(10000 * mod.MSGBYTES), pk_i)
+    t0 = time.perf_counter()
+    mod.rkg_batch(sk_i, pk_j, c)
+    duration = time.perf_counter() - t0
+
+    # with the GIL held, the main thread would stall for the whole call
+    t = threading.Thread(target=mod.rkg_batch, args=(sk_i, pk_j, c))
+    ticks = [time.perf_counter()]
+    t.start()
+    while t.is_alive():
+        ticks.append(time.perf_counter())
+    t.join()
+    gap = max(b - a for a, b in zip(ticks, ticks[1:] + [time.perf_counter()]))
+    check(gap < duration / 2, "GIL held during rkg_batch (%.1f ms stall)" % (1000 * gap))
+
+    rk = mod.rkg_batch(sk_i, pk_j, c)
+    expected = mod.renc_batch(rk, c)
+    results = [None] * 4
+
+    def renc(i):
+        results[i] = mod.renc_batch(rk, c)
+
+    threads = [threading.Thread(target=renc, args=(i,)) for i in range(4)]
+    for t in threads:
+        t.start()
+    for t in threads:
+        t.join()
+    check(all(r == expected for r in results), "renc_batch in threads")
+
+
+def check_libcdpre(mod):
+    """cdpre512 gives the outputs of libcdpre.so for the same coins."""
+    path = os.path.join(os.path.dirname(here), "libcdpre.so")
+    if not os.path.exists(path):
+        print("libcdpre.so not built, comparison skipped")
+        return
+    lib = ctypes.CDLL(path)
+    buf = ctypes.create_string_buffer
+    coins = os.urandom(mod.SYMBYTES)
+    m = os.urandom(mod.MSGBYTES)
+
+    pk_i, sk_i = buf(mod.PUBLICKEYBYTES), buf(mod.SECRETKEYBYTES)
+    lib.pqcrystals_kyber512_avx2_indcpa_keypair_derand(pk_i, sk_i, coins)
+    check((pk_i.raw, sk_i.raw) == mod.keygen(coins), "keygen against libcdpre.so")
+    pk_j, sk_j = mod.keygen()
+    c = buf(mod.CIPHERTEXTBYTES)
+    lib.pqcrystals_kyber512_avx2_indcpa_enc(c, m, pk_i, coins)
+    check(c.raw == mod.enc(m, pk_i.raw, coins), "enc against libcdpre.so")
+    rk = buf(mod.CIPHERTEXTBYTES)
+    lib.cdpre_rkg(sk_i, pk_j, c, rk, coins)
+    check(rk.raw == mod.rkg(sk_i.raw, pk_j, c.raw, coins), "rkg against libcdpre.so")
+    cj = buf(mod.CIPHERTEXTBYTES)
+    lib.cdpre_renc(rk, c, cj)
+    check(cj.raw == mod.renc(rk.raw, c.raw), "renc against libcdpre.so")
+    out = buf(mod.MSGBYTES)
+    lib.pqcrystals_kyber512_avx2_indcpa_dec(out, cj, sk_j)
+    check(out.raw == mod.dec(cj.raw, sk_j) == m, "dec against libcdpre.so")
+
+
+def main():
+    for name in ("cdpre512", "cdpre768", "cdpre1024"):
+        mod = importlib.import_module(name)
+        for _ in range(20):
+            check_roundtrip(mod)
+        for n in (0, 1, 3, 4, 5, 9):
+            check_batch(mod, n)
+        check_buffers(mod)
+        check_threads(mod)
+    check_libcdpre(importlib.import_module("cdpre512"))
+
+
+if __name__ == "__main__":
+    main()
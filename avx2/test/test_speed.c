@@ -1 +0,0 @@
-../../ref/test/test_speed.c
\ No newline at end of file
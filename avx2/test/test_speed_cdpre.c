@@ -2,7 +2,9 @@
 #include <stdint.h>
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
 #include "../params.h"
+#include "../indcpa.h"
 #include "../polyvec.h"
 #include "../poly.h"
 #include "../randombytes.h"
@@ -12,20 +14,31 @@
 #include "../cdpre.h"
 
 #define NTESTS 1000
+#define NHOPS 4
 
 uint64_t t[NTESTS];
 
 int main(void)
 {
-	unsigned int i;
-	uint8_t coins32[KYBER_SYMBYTES];
-	uint8_t sk_i[KYBER_SECRETKEYBYTES];
-	uint8_t pk_j[KYBER_PUBLICKEYBYTES];
-	uint8_t ct_i[KYBER_CIPHERTEXTBYTES];
-	uint8_t rk[KYBER_CIPHERTEXTBYTES];
-	uint8_t ct_j[KYBER_CIPHERTEXTBYTES];
+  unsigned int i;
+  uint8_t coins32[KYBER_SYMBYTES];
+  uint8_t m[KYBER_INDCPA_MSGBYTES];
+  uint8_t pk_i[KYBER_INDCPA_PUBLICKEYBYTES];
+  uint8_t sk_i[KYBER_INDCPA_SECRETKEYBYTES];
+  uint8_t pk_j[KYBER_INDCPA_PUBLICKEYBYTES];
+  uint8_t sk_j[KYBER_INDCPA_SECRETKEYBYTES];
+  uint8_t ct_i[KYBER_INDCPA_BYTES];
+  uint8_t rk[KYBER_INDCPA_BYTES];
+  uint8_t ct_j[KYBER_INDCPA_BYTES];
+  uint8_t rks[NHOPS*KYBER_INDCPA_BYTES];
 
   randombytes(coins32, KYBER_SYMBYTES);
+  randombytes(m, KYBER_INDCPA_MSGBYTES);
+  indcpa_keypair_derand(pk_i, sk_i, coins32);
+  randombytes(coins32, KYBER_SYMBYTES);
+  indcpa_keypair_derand(pk_j, sk_j, coins32);
+  randombytes(coins32, KYBER_SYMBYTES);
+  indcpa_enc(ct_i, m, pk_i, coins32);
 
   for(i=0;i<NTESTS;i++) {
     t[i] = cpucycles();
@@ -39,5 +52,19 @@ int main(void)
   }
   print_results("cdpre_renc: ", t, NTESTS);
 
+  for(i=0;i<NHOPS;i++)
+    memcpy(rks+i*KYBER_INDCPA_BYTES, rk, KYBER_INDCPA_BYTES);
+  for(i=0;i<NTESTS;i++) {
+    t[i] = cpucycles();
+    cdpre_renc_chain(rks, NHOPS, ct_i, ct_j);
+  }
+  print_results("cdpre_renc_chain (4 hops): ", t, NTESTS);
+
+  for(i=0;i<NTESTS;i++) {
+    t[i] = cpucycles();
+    indcpa_dec(m, ct_j, sk_j);
+  }
+  print_results("cdpre_dec_re: ", t, NTESTS);
+
   return 0;
 }
@@ -0,0 +1,289 @@
+#include <pthread.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../indcpa.h"
+#include "../cdpre.h"
+#include "../poly.h"
+#include "../randombytes.h"
+#include "../telemetry.h"
+
+#define NTHREADS 4
+#define NCALLS   50
+#define NBATCH   5
+
+static uint8_t rk[KYBER_INDCPA_BYTES];
+static uint8_t ct_i[KYBER_INDCPA_BYTES];
+static uint8_t ct_b[NBATCH*KYBER_INDCPA_BYTES];
+static uint8_t ct_d[NBATCH*KYBER_INDCPA_BYTES];
+static uint8_t m_b[NBATCH*KYBER_INDCPA_MSGBYTES], coins_b[NBATCH*KYBER_SYMBYTES];
+static uint8_t m_d[NBATCH*KYBER_INDCPA_MSGBYTES];
+static struct cdpre_telemetry t;
+
+static void *run(void *arg)
+{
+  unsigned int i;
+  uint8_t ct_j[KYBER_INDCPA_BYTES];
+
+  (void)arg;
+  for(i=0;i<NCALLS;i++)
+    cdpre_renc(rk, ct_i, ct_j);
+  return NULL;
+}
+
+// NCALLS re-encryptions on each of NTHREADS threads and the calling thread
+static int run_threads(void)
+{
+  unsigned int i;
+  pthread_t tid[NTHREADS];
+
+  for(i=0;i<NTHREADS;i++)
+    if(pthread_create(&tid[i], NULL, run, NULL))
+      return -1;
+  run(NULL);
+  for(i=0;i<NTHREADS;i++)
+    pthread_join(tid[i], NULL);
+  return 0;
+}
+
+static int check_counts(uint64_t n)
+{
+  unsigned int b;
+  uint64_t sum = 0;
+  const struct cdpre_telemetry_op_stats *s = &t.op[CDPRE_TELEMETRY_CDPRE_RENC];
+
+  for(b=0;b<CDPRE_TELEMETRY_BUCKETS;b++)
+    sum += s->buckets[b];
+  if(s->calls != n || sum != n || s->bytes != n*KYBER_INDCPA_BYTES) {
+    fprintf(stderr, "ERROR telemetry counts: %llu calls, %llu in buckets, expected %llu\n",
+            (unsigned long long)s->calls, (unsigned long long)sum, (unsigned long long)n);
+    return -1;
+  }
+  if(cdpre_telemetry_quantile(s, 0.5) > cdpre_telemetry_quantile(s, 0.99)
+     || cdpre_telemetry_quantile(s, 0.99) > cdpre_telemetry_quantile(s, 1.0)
+     || cdpre_telemetry_quantile(s, 1.0)*n < s->ticks) {
+    fprintf(stderr, "ERROR cdpre_telemetry_quantile\n");
+    return -1;
+  }
+  return 0;
+}
+
+static int check_buckets(void)
+{
+  unsigned int i, b;
+  uint64_t v;
+
+  for(b=0;b+1<CDPRE_TELEMETRY_BUCKETS;b++) {
+    v = cdpre_telemetry_bucket_max(b);
+    if(cdpre_telemetry_bucket(v) != b || cdpre_telemetry_bucket(v+1) != b+1) {
+      fprintf(stderr, "ERROR cdpre_telemetry_bucket %u\n", b);
+      return -1;
+    }
+  }
+  for(i=0;i<1000;i++) {
+    randombytes((uint8_t *)&v, sizeof(v));
+    v >>= v & 63;
+    b = cdpre_telemetry_bucket(v);
+    if(v > cdpre_telemetry_bucket_max(b) || (b && v <= cdpre_telemetry_bucket_max(b-1))
+       || (b+1 < CDPRE_TELEMETRY_BUCKETS && 8*(cdpre_telemetry_bucket_max(b)-v) > v)) {
+      fprintf(stderr, "ERROR cdpre_telemetry_bucket %llu\n", (unsigned long long)v);
+      return -1;
+    }
+  }
+  return 0;
+}
+
+// message bit of a coefficient as in the reference poly_tomsg
+static unsigned int bit(int a)
+{
+  a = (a + KYBER_Q) % KYBER_Q;
+  return (((a << 1) + KYBER_Q/2)/KYBER_Q) & 1;
+}
+
+// poly_tomsg_margin must decode like poly_tomsg and return the number of
+// steps the worst coefficient can move either way without flipping its bit
+static int check_margin(void)
+{
+  unsigned int i, j, k, min, margin;
+  uint8_t m0[KYBER_INDCPA_MSGBYTES], m1[KYBER_INDCPA_MSGBYTES];
+  poly a;
+
+  for(i=0;i<100;i++) {
+    randombytes((uint8_t *)a.coeffs, sizeof(a.coeffs));
+    for(j=0;j<KYBER_N;j++)
+      a.coeffs[j] = (uint16_t)a.coeffs[j] % (KYBER_Q+1);
+    if(i == 0)  // the extremes of [0,q]
+      for(j=0;j<KYBER_N;j++)
+        a.coeffs[j] = (j & 1)*KYBER_Q;
+
+    min = KYBER_Q;
+    for(j=0;j<KYBER_N;j++) {
+      for(k=1;bit(a.coeffs[j]+k) == bit(a.coeffs[j]) && bit(a.coeffs[j]-k) == bit(a.coeffs[j]);k++);
+      min = (k-1 < min) ? k-1 : min;
+    }
+
+    poly_tomsg(m0, &a);
+    margin = poly_tomsg_margin(m1, &a);
+    if(memcmp(m0, m1, sizeof(m0)) || margin != min) {
+      fprintf(stderr, "ERROR poly_tomsg_margin %u, expected %u\n", margin, min);
+      return -1;
+    }
+  }
+  return 0;
+}
+
+static int check_prometheus(uint64_t n)
+{
+  size_t len;
+  char *buf, line[128], small[64];
+
+  len = cdpre_telemetry_prometheus(NULL, 0, &t);
+  buf = malloc(len+1);
+  if(!buf)
+    return -1;
+  if(cdpre_telemetry_prometheus(buf, len+1, &t) != len || strlen(buf) != len
+     || cdpre_telemetry_prometheus(small, sizeof(small), &t) != len
+     || strlen(small) != sizeof(small)-1 || memcmp(small, buf, sizeof(small)-1)) {
+    fprintf(stderr, "ERROR cdpre_telemetry_prometheus length\n");
+    free(buf);
+    return -1;
+  }
+
+  snprintf(line, sizeof(line), "\ncdpre_calls_total{op=\"cdpre_renc\",params=\"%d\"} %llu\n",
+           KYBER_K*KYBER_N, (unsigned long long)n);
+  if(!strstr(buf, line))
+    goto err;
+  snprintf(line, sizeof(line), "\ncdpre_latency_ticks_bucket{op=\"cdpre_renc\",params=\"%d\",le=\"+Inf\"} %llu\n",
+           KYBER_K*KYBER_N, (unsigned long long)n);
+  if(!strstr(buf, line))
+    goto err;
+  snprintf(line, sizeof(line), "\ncdpre_latency_ticks_count{op=\"cdpre_rkg\",params=\"%d\"} 0\n",
+           KYBER_K*KYBER_N);
+  if(!strstr(buf, line))
+    goto err;
+  snprintf(line, sizeof(line), "\ncdpre_dec_margin_count{params=\"%d\"} %d\n",
+           KYBER_K*KYBER_N, NCALLS+NBATCH);
+  if(!strstr(buf, line))
+    goto err;
+  free(buf);
+  return 0;
+
+err:
+  fprintf(stderr, "ERROR cdpre_telemetry_prometheus: missing%s", line);
+  free(buf);
+  return -1;
+}
+
+int main(void)
+{
+  uint8_t coins[KYBER_SYMBYTES];
+  uint8_t m[KYBER_INDCPA_MSGBYTES];
+  uint8_t pk_i[KYBER_INDCPA_PUBLICKEYBYTES];
+  uint8_t sk_i[KYBER_INDCPA_SECRETKEYBYTES];
+  uint8_t pk_j[KYBER_INDCPA_PUBLICKEYBYTES];
+  uint8_t sk_j[KYBER_INDCPA_SECRETKEYBYTES];
+  uint8_t m1[KYBER_INDCPA_MSGBYTES];
+  unsigned int i, lo;
+  uint8_t pk4[4][KYBER_INDCPA_PUBLICKEYBYTES], sk4[4][KYBER_INDCPA_SECRETKEYBYTES];
+  uint8_t *ppk[4] = {pk4[0], pk4[1], pk4[2], pk4[3]};
+  uint8_t *psk[4] = {sk4[0], sk4[1], sk4[2], sk4[3]};
+  const uint8_t *pcoins[4] = {coins_b, coins_b + KYBER_SYMBYTES, coins_b + 2*KYBER_SYMBYTES,
+                              coins_b + 3*KYBER_SYMBYTES};
+
+  randombytes(coins, KYBER_SYMBYTES);
+  randombytes(m, KYBER_INDCPA_MSGBYTES);
+  randombytes(m_b, sizeof(m_b));
+  randombytes(coins_b, sizeof(coins_b));
+  indcpa_keypair_derand(pk_i, sk_i, coins);
+  indcpa_keypair_derand(pk_j, sk_j, m);
+  indcpa_enc(ct_i, m, pk_i, coins);
+  cdpre_rkg(sk_i, pk_j, ct_i, rk, coins);
+
+  // Nothing is recorded before telemetry is enabled
+  run(NULL);
+  cdpre_telemetry_snapshot(&t);
+  if(check_counts(0))
+    return 1;
+
+  // Calls of all threads are merged
+  cdpre_telemetry_enable(1);
+  if(run_threads())
+    return 1;
+  cdpre_telemetry_snapshot(&t);
+  if(check_counts((NTHREADS+1)*NCALLS))
+    return 1;
+
+  // and survive the exit of the threads whose slots are reused
+  if(run_threads())
+    return 1;
+  cdpre_telemetry_snapshot(&t);
+  if(check_counts(2*(NTHREADS+1)*NCALLS))
+    return 1;
+
+  // indcpa_dec, which the KEM uses, records no margins
+  for(i=0;i<NBATCH;i++)
+    memcpy(ct_d + i*KYBER_INDCPA_BYTES, ct_i, KYBER_INDCPA_BYTES);
+  indcpa_dec(m1, ct_i, sk_i);
+  indcpa_dec_batch(m_d, ct_d, NBATCH, sk_i);
+  cdpre_telemetry_snapshot(&t);
+  for(i=0;i<CDPRE_TELEMETRY_MARGIN_BUCKETS;i++)
+    if(t.margins[i])
+      break;
+  if(i < CDPRE_TELEMETRY_MARGIN_BUCKETS || t.margin_sum) {
+    fprintf(stderr, "ERROR indcpa_dec records noise margins\n");
+    return 1;
+  }
+
+  // cdPRE decryptions record their noise margin, which for a correctly
+  // decrypted fresh ciphertext is far from 0
+  for(i=0;i<NCALLS;i++) {
+    cdpre_dec(m1, ct_i, sk_i);
+    if(memcmp(m, m1, KYBER_INDCPA_MSGBYTES))
+      return 1;
+  }
+
+  // A batch is one call with the bytes of all its outputs, and a batched
+  // decryption records the margin of every ciphertext
+  indcpa_enc_batch(ct_b, m_b, NBATCH, pk_i, coins_b);
+  cdpre_dec_batch(m_d, ct_d, NBATCH, sk_i);
+  for(i=0;i<NBATCH;i++)
+    if(memcmp(m, m_d + i*KYBER_INDCPA_MSGBYTES, KYBER_INDCPA_MSGBYTES))
+      return 1;
+
+  // but four key pairs at once count as four
+  indcpa_keypair_derand_x4(ppk, psk, pcoins);
+
+  cdpre_telemetry_enable(0);
+  run(NULL);
+  indcpa_dec(m1, ct_i, sk_i);
+  cdpre_telemetry_snapshot(&t);
+  if(check_counts(2*(NTHREADS+1)*NCALLS))
+    return 1;
+
+  lo = cdpre_telemetry_margin_quantile(&t, 0);
+  if(t.op[CDPRE_TELEMETRY_INDCPA_DEC].calls != NCALLS+3 || lo < KYBER_Q/8
+     || lo != cdpre_telemetry_margin_quantile(&t, 1)
+     || t.margin_sum < (uint64_t)lo*(NCALLS+NBATCH)
+     || t.margin_sum >= (uint64_t)(lo+8)*(NCALLS+NBATCH)) {
+    fprintf(stderr, "ERROR telemetry noise margin %u\n", lo);
+    return 1;
+  }
+  if(t.op[CDPRE_TELEMETRY_INDCPA_ENC].calls != 1
+     || t.op[CDPRE_TELEMETRY_INDCPA_ENC].bytes != NBATCH*KYBER_INDCPA_BYTES
+     || t.op[CDPRE_TELEMETRY_INDCPA_DEC].bytes != (NCALLS+2*NBATCH+1)*KYBER_INDCPA_MSGBYTES) {
+    fprintf(stderr, "ERROR telemetry of indcpa_enc_batch and cdpre_dec_batch\n");
+    return 1;
+  }
+  if(t.op[CDPRE_TELEMETRY_INDCPA_KEYPAIR].calls != 4
+     || t.op[CDPRE_TELEMETRY_INDCPA_KEYPAIR].bytes != 4*(KYBER_INDCPA_PUBLICKEYBYTES + KYBER_INDCPA_SECRETKEYBYTES)) {
+    fprintf(stderr, "ERROR telemetry of indcpa_keypair_derand_x4\n");
+    return 1;
+  }
+
+  if(check_buckets() || check_margin() || check_prometheus(2*(NTHREADS+1)*NCALLS))
+    return 1;
+
+  return 0;
+}
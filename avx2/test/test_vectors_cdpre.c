@@ -4,6 +4,7 @@
 #include <stddef.h>
 #include <stdint.h>
 #include <stdio.h>
+#include <string.h>
 #include "../indcpa.h"
 #include "../randombytes.h"
 #include "../fips202.h"
@@ -22,6 +23,11 @@ int main(void)
   uint8_t ct_i[KYBER_CIPHERTEXTBYTES];
   uint8_t rk[KYBER_CIPHERTEXTBYTES];
   uint8_t ct_j[KYBER_CIPHERTEXTBYTES];
+  uint8_t pk_k[KYBER_PUBLICKEYBYTES];
+  uint8_t sk_k[KYBER_SECRETKEYBYTES];
+  uint8_t rks[2*KYBER_CIPHERTEXTBYTES];
+  uint8_t ct_k[KYBER_CIPHERTEXTBYTES];
+  uint8_t ct_jk[KYBER_CIPHERTEXTBYTES];
   uint8_t key_i[KYBER_INDCPA_MSGBYTES];
   uint8_t key_j[KYBER_INDCPA_MSGBYTES];
 
@@ -99,6 +105,42 @@ int main(void)
 			return -1;
 		}
 	}
+
+    // Fused re-encryption with one hop is cdpre_renc
+    cdpre_renc_chain(rk, 1, ct_i, ct_k);
+    for(j=0;j<KYBER_CIPHERTEXTBYTES;j++) {
+      if(ct_k[j] != ct_j[j]) {
+        fprintf(stderr, "ERROR cdpre_renc_chain\n");
+        return -1;
+      }
+    }
+
+    // Second hop from j to k with a re-key for ct_j, fused with the first
+    randombytes(coins32, KYBER_SYMBYTES);
+    indcpa_keypair_derand(pk_k, sk_k, coins32);
+    randombytes(coins32, KYBER_SYMBYTES);
+    memcpy(rks, rk, KYBER_CIPHERTEXTBYTES);
+    cdpre_rkg(sk_j, pk_k, ct_j, rks+KYBER_CIPHERTEXTBYTES, coins32);
+    cdpre_renc_chain(rks, 2, ct_i, ct_k);
+    cdpre_renc(rks+KYBER_CIPHERTEXTBYTES, ct_j, ct_jk);
+    for(j=0;j<KYBER_CIPHERTEXTBYTES;j++) {
+      if(ct_k[j] != ct_jk[j]) {
+        fprintf(stderr, "ERROR cdpre_renc_chain two hops\n");
+        return -1;
+      }
+    }
+    printf("Ciphertext ct_k: ");
+    for (j = 0; j < KYBER_CIPHERTEXTBYTES; j++)
+      printf("%02x", ct_k[j]);
+    printf("\n");
+
+    indcpa_dec(key_j, ct_k, sk_k);
+    for(j=0;j<KYBER_INDCPA_MSGBYTES;j++) {
+      if(key_i[j] != key_j[j]) {
+        fprintf(stderr, "ERROR two hops\n");
+        return -1;
+      }
+    }
   }
   return 0;
 }
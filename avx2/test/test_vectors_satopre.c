@@ -0,0 +1,107 @@
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "../indcpa.h"
+#include "../polyvec.h"
+#include "../poly.h"
+#include "../randombytes.h"
+#include "../fips202.h"
+#include "../satopre.h"
+
+#define NTESTS 100
+
+static uint8_t rk[SATOPRE_RKBYTES];
+static uint8_t rk2[SATOPRE_RKBYTES];
+static uint8_t prk[SATOPRE_RKPACKEDBYTES(SATOPRE_RKMAXBITS)];
+
+static void print_hex(const char *label, const uint8_t *x, size_t xlen)
+{
+  size_t j;
+
+  printf("%s", label);
+  for(j = 0; j < xlen; j++)
+    printf("%02x", x[j]);
+  printf("\n");
+}
+
+int main(void)
+{
+  unsigned int i;
+  uint8_t coins1[KYBER_SYMBYTES];
+  uint8_t coins2[KYBER_SYMBYTES];
+  uint8_t pk_i[SATOPRE_PUBLICKEYBYTES];
+  uint8_t sk_i[SATOPRE_SECRETKEYBYTES];
+  uint8_t pk_j[SATOPRE_PUBLICKEYBYTES];
+  uint8_t sk_j[SATOPRE_SECRETKEYBYTES];
+  uint8_t ct_i[SATOPRE_BYTES];
+  uint8_t ct_j[SATOPRE_BYTES];
+  uint8_t ct_p[SATOPRE_BYTES];
+  uint8_t key_i[KYBER_INDCPA_MSGBYTES];
+  uint8_t key_j[KYBER_INDCPA_MSGBYTES];
+  uint8_t hrk[32];
+
+  for (i = 0; i < NTESTS; i++) {
+    // Key-pair generation for i and j
+    randombytes(coins1, KYBER_SYMBYTES);
+    randombytes(coins2, KYBER_SYMBYTES);
+    satopre_keypair(pk_i, sk_i, coins1, coins2);
+    print_hex("i's Public Key: ", pk_i, SATOPRE_PUBLICKEYBYTES);
+    print_hex("i's Secret Key: ", sk_i, SATOPRE_SECRETKEYBYTES);
+
+    randombytes(coins1, KYBER_SYMBYTES);
+    randombytes(coins2, KYBER_SYMBYTES);
+    satopre_keypair(pk_j, sk_j, coins1, coins2);
+    print_hex("j's Public Key: ", pk_j, SATOPRE_PUBLICKEYBYTES);
+    print_hex("j's Secret Key: ", sk_j, SATOPRE_SECRETKEYBYTES);
+
+    // Encryption and decryption by i
+    randombytes(coins1, KYBER_SYMBYTES);
+    randombytes(key_i, KYBER_INDCPA_MSGBYTES);
+    satopre_enc(ct_i, key_i, pk_i, coins1);
+    print_hex("Ciphertext ct_i: ", ct_i, SATOPRE_BYTES);
+
+    satopre_dec(key_j, ct_i, sk_i);
+    if(memcmp(key_i, key_j, KYBER_INDCPA_MSGBYTES)) {
+      fprintf(stderr, "ERROR satopre_dec\n");
+      return -1;
+    }
+
+    // Re-key generation for i and j, which must be deterministic in the coins
+    randombytes(coins1, KYBER_SYMBYTES);
+    satopre_rkg(sk_i, pk_j, sk_j, rk, coins1);
+    satopre_rkg(sk_i, pk_j, sk_j, rk2, coins1);
+    if(memcmp(rk, rk2, SATOPRE_RKBYTES)) {
+      fprintf(stderr, "ERROR satopre_rkg\n");
+      return -1;
+    }
+    // and independent of the number of threads
+    satopre_rkg_mt(sk_i, pk_j, sk_j, rk2, coins1, 1 + i % 7);
+    if(memcmp(rk, rk2, SATOPRE_RKBYTES)) {
+      fprintf(stderr, "ERROR satopre_rkg_mt\n");
+      return -1;
+    }
+    sha3_256(hrk, rk, SATOPRE_RKBYTES);
+    print_hex("Re-key rk (SHA3-256): ", hrk, 32);
+
+    // Re-encryption by the proxy and decryption by j
+    satopre_renc(rk, ct_i, ct_j);
+    print_hex("Ciphertext ct_j: ", ct_j, SATOPRE_BYTES);
+    satopre_dec_re(key_j, ct_j, sk_j);
+    print_hex("Shared Secret key_j: ", key_j, KYBER_INDCPA_MSGBYTES);
+    print_hex("Shared Secret key_i: ", key_i, KYBER_INDCPA_MSGBYTES);
+    if(memcmp(key_i, key_j, KYBER_INDCPA_MSGBYTES)) {
+      fprintf(stderr, "ERROR satopre_renc\n");
+      return -1;
+    }
+
+    // The 12-bit packed re-key is lossless
+    if(satopre_rk_pack(prk, rk, 12) || satopre_renc_packed(prk, ct_i, ct_p)
+       || memcmp(ct_j, ct_p, SATOPRE_BYTES)) {
+      fprintf(stderr, "ERROR satopre_rk_pack\n");
+      return -1;
+    }
+  }
+
+  return 0;
+}
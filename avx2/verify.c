@@ -81,3 +81,22 @@ void cmov(uint8_t * restrict r, const uint8_t *x, size_t len, uint8_t b)
   for(i=0;i<len;i++)
     r[i] ^= -b & (x[i] ^ r[i]);
 }
+
+/*************************************************
+* Name:        wipe
+*
+* Description: Overwrite len bytes of secret data with zeros. The stores go
+*              through a volatile pointer, so the compiler cannot drop them
+*              as dead even right before the memory is freed or goes out
+*              of scope.
+*
+* Arguments:   void *p: pointer to the bytes to erase
+*              size_t len: number of bytes
+**************************************************/
+void wipe(void *p, size_t len)
+{
+  volatile uint8_t *q = p;
+
+  while(len--)
+    *q++ = 0;
+}
@@ -1 +0,0 @@
-../ref/verify.h
\ No newline at end of file
@@ -30,7 +30,11 @@ void pqcrystals_kyber512_avx2_indcpa_keypair_derand(uint8_t pk[800], uint8_t sk[
 
 void pqcrystals_kyber512_avx2_indcpa_enc(uint8_t c[768], const uint8_t m[32], const uint8_t pk[800], const uint8_t coins[32]);
 
+void pqcrystals_kyber512_avx2_indcpa_enc_batch(uint8_t *c, const uint8_t *m, size_t n, const uint8_t pk[800], const uint8_t *coins);
+
 void pqcrystals_kyber512_avx2_indcpa_dec(uint8_t m[32], const uint8_t c[768], const uint8_t sk[1632]);
+
+void pqcrystals_kyber512_avx2_indcpa_dec_batch(uint8_t *m, const uint8_t *c, size_t n, const uint8_t sk[1632]);
 """)
 ffi.cdef("""
 void cdpre_rkg(uint8_t sk_i[1632],
@@ -168,12 +172,15 @@ def test_kdf_tree(n, e, pka, ska, pkb, skb):
         if i == e[0]:
             # Only need re-encryption in the first epoch
             # Proxy server
-            # Encrypt the dk
+            # Encrypt the dk, all under pka in one batch
+            nodes = list(epoch_keys.keys())
+            ms = ffi.new("uint8_t[]", b''.join(epoch_keys[k].ljust(KYBER_INDCPA_MSGBYTES, b'\0') for k in nodes))
+            cks = ffi.new("uint8_t[]", len(nodes) * KYBER_INDCPA_BYTES)
+            coinse = ffi.new("uint8_t[]", os.urandom(len(nodes) * KYBER_SYMBYTES))
+            libindcpa.pqcrystals_kyber512_avx2_indcpa_enc_batch(cks, ms, len(nodes), pka, coinse)
             edk = {}
-            for k, v in epoch_keys.items():
-                coinse = ffi.new("uint8_t[]", os.urandom(KYBER_SYMBYTES))
-                libindcpa.pqcrystals_kyber512_avx2_indcpa_enc(ck, v, pka, coinse)
-                edk[k] = bytes(ck)
+            for j, k in enumerate(nodes):
+                edk[k] = ffi.buffer(cks)[j * KYBER_INDCPA_BYTES:(j + 1) * KYBER_INDCPA_BYTES]
             
             # Re-encrypt the dk ciphertext
             rks = {}
@@ -191,11 +198,13 @@ def test_kdf_tree(n, e, pka, ska, pkb, skb):
             # Data buyer
             epoch_keysp = {}
             stack = []
-            for k, v in ckps.items():
-                # Decrypt the re-encrypted key ciphertext
-                dkpp = ffi.new("uint8_t[]", KYBER_INDCPA_MSGBYTES)
-                libindcpa.pqcrystals_kyber512_avx2_indcpa_dec(dkpp, v, skb)
-                epoch_keysp[k] = bytes(dkpp)[:16]
+            # Decrypt the re-encrypted key ciphertexts in one batch
+            nodes = list(ckps.keys())
+            cps = ffi.new("uint8_t[]", b''.join(ckps[k] for k in nodes))
+            dkpps = ffi.new("uint8_t[]", len(nodes) * KYBER_INDCPA_MSGBYTES)
+            libindcpa.pqcrystals_kyber512_avx2_indcpa_dec_batch(dkpps, cps, len(nodes), skb)
+            for j, k in enumerate(nodes):
+                epoch_keysp[k] = ffi.buffer(dkpps)[j * KYBER_INDCPA_MSGBYTES:j * KYBER_INDCPA_MSGBYTES + 16]
                 stack.append((k, len(k)))
             # Retrieve the sek
             while stack:
@@ -1,75 +1,78 @@
-import matplotlib.pyplot as plt
-import numpy as np
-
-# 数据
-schemes = ['512']
-cdPRE = {
-    'KG': [8948],
-    'Enc': [9572],
-    'Dec': [802],
-    'RKG': [11858],
-    'REnc': [406]
-}
-CPA_PRE = {
-    'KG': [17898],
-    'Enc': [9514],
-    'Dec': [798],
-    'RKG': [128470],
-    'REnc': [4486]
-}
-
-# 创建子图
-fig, axs = plt.subplots(3, 2, figsize=(5, 8))
-
-# 定义颜色
-color_cdPRE = '#1f77b4'
-color_CPA_PRE = '#ff7f0e'
-
-# 绘制每个参数的对比图
-for i, (param, cdPRE_values) in enumerate(cdPRE.items()):
-    CPA_PRE_values = CPA_PRE[param]
-    ax = axs[i // 2, i % 2]
-    x = np.arange(len(schemes))
-    width = 4  # 调整柱状图的宽度
-
-    ax.bar(x - width/2, CPA_PRE_values, 1, label='CPA PRE', color=color_CPA_PRE)
-    ax.bar(x + width/2, cdPRE_values, 1, label='cdPRE', color=color_cdPRE)
-
-    # 添加数值标签
-    for container in ax.containers:
-        ax.bar_label(container, fontsize=8, rotation=0, padding=3)
-
-    ax.set_ylabel('Alder Lake Cycles')
-    ax.set_title(f'{param} Comparison')
-    ax.set_xticks([])
-    ax.legend()
-
-    ax.set_ylim(0, max(max(cdPRE_values), max(CPA_PRE_values)) * 1.6)
-
-# 绘制整体数据的对比图
-overall_cdPRE = [sum(values) for values in zip(*cdPRE.values())]
-overall_CPA_PRE = [sum(values) for values in zip(*CPA_PRE.values())]
-ax = axs[2, 1]
-x = np.arange(len(schemes))
-width = 4
-
-ax.bar(x - width/2, overall_CPA_PRE, 1, label='CPA PRE', color=color_CPA_PRE)
-ax.bar(x + width/2, overall_cdPRE, 1, label='cdPRE', color=color_cdPRE)
-
-# 添加数值标签
-for container in ax.containers:
-    ax.bar_label(container, fontsize=8, rotation=0, padding=5)
-
-ax.set_ylabel('Alder Lake Cycles')
-ax.set_title('Overall Comparison')
-ax.set_xticks([])
-ax.legend()
-
-ax.set_ylim(0, max(max(overall_cdPRE), max(overall_CPA_PRE)) * 1.6)
-
-# 调整子图间距
-plt.subplots_adjust(wspace=0.3, hspace=0.5)
-
-# 调整布局
-plt.tight_layout(rect=[0, 0.03, 1, 0.95])
-plt.show()
\ No newline at end of file
+import argparse
+import csv
+import json
+
+import matplotlib.pyplot as plt
+import numpy as np
+
+# 读取 runbench.sh / avx2/test/bench 的输出 (CSV 或每行一个 JSON 对象)
+parser = argparse.ArgumentParser(description='Plot cdPRE vs. CPA PRE (satoPRE) cycle counts')
+parser.add_argument('results', nargs='?', default='bench.json',
+                    help='output of runbench.sh (.csv or .json)')
+parser.add_argument('--stat', default='median',
+                    choices=['median', 'mean', 'p90', 'p99'])
+parser.add_argument('--cpu', default='', help='CPU name for the axis label')
+args = parser.parse_args()
+
+rows = []
+with open(args.results) as f:
+    if args.results.endswith('.csv'):
+        rows = list(csv.DictReader(f))
+    else:
+        rows = [json.loads(line) for line in f if line.strip()]
+results = {(r['scheme'], int(r['params']), r['op']): float(r[args.stat]) for r in rows}
+
+# 数据: cdPRE 的密钥生成、加密和解密即 IND-CPA 方案
+ops = {
+    'KG': (('indcpa', 'keypair'), ('satopre', 'keypair')),
+    'Enc': (('indcpa', 'enc'), ('satopre', 'enc')),
+    'Dec': (('indcpa', 'dec'), ('satopre', 'dec')),
+    'RKG': (('cdpre', 'rkg'), ('satopre', 'rkg')),
+    'REnc': (('cdpre', 'renc'), ('satopre', 'renc')),
+}
+schemes = sorted({p for (_, p, _) in results})
+cdPRE = {param: [results[(c[0], p, c[1])] for p in schemes] for param, (c, _) in ops.items()}
+CPA_PRE = {param: [results[(s[0], p, s[1])] for p in schemes] for param, (_, s) in ops.items()}
+
+# 创建子图
+fig, axs = plt.subplots(3, 2, figsize=(5 + len(schemes), 8))
+
+# 定义颜色
+color_cdPRE = '#1f77b4'
+color_CPA_PRE = '#ff7f0e'
+ylabel = f'{args.cpu} Cycles ({args.stat})'.strip()
+x = np.arange(len(schemes))
+width = 0.35  # 柱状图的宽度
+
+
+def plot(ax, title, CPA_PRE_values, cdPRE_values):
+    ax.bar(x - width/2, CPA_PRE_values, width, label='CPA PRE', color=color_CPA_PRE)
+    ax.bar(x + width/2, cdPRE_values, width, label='cdPRE', color=color_cdPRE)
+
+    # 添加数值标签
+    for container in ax.containers:
+        ax.bar_label(container, fmt='%d', fontsize=8, rotation=0, padding=3)
+
+    ax.set_ylabel(ylabel)
+    ax.set_title(title)
+    ax.set_xticks(x, [f'Kyber{p}' for p in schemes])
+    ax.legend()
+
+    ax.set_ylim(0, max(max(cdPRE_values), max(CPA_PRE_values)) * 1.6)
+
+
+# 绘制每个参数的对比图
+for i, (param, cdPRE_values) in enumerate(cdPRE.items()):
+    plot(axs[i // 2, i % 2], f'{param} Comparison', CPA_PRE[param], cdPRE_values)
+
+# 绘制整体数据的对比图
+overall_cdPRE = [sum(values) for values in zip(*cdPRE.values())]
+overall_CPA_PRE = [sum(values) for values in zip(*CPA_PRE.values())]
+plot(axs[2, 1], 'Overall Comparison', overall_CPA_PRE, overall_cdPRE)
+
+# 调整子图间距
+plt.subplots_adjust(wspace=0.3, hspace=0.5)
+
+# 调整布局
+plt.tight_layout(rect=[0, 0.03, 1, 0.95])
+plt.show()
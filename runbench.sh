@@ -0,0 +1,19 @@
+#!/bin/sh -e
+# Runs the benchmark driver for all parameter sets and collects the results
+# in one file, e.g. FORMAT=csv OUT=skylake.csv ./runbench.sh
+FORMAT="${FORMAT:-json}"
+OUT="${OUT:-bench.$FORMAT}"
+NTESTS="${NTESTS:-1000}"
+NWARMUP="${NWARMUP:-100}"
+
+make -j$(nproc) -C avx2 test/bench512 test/bench768 test/bench1024
+
+: > "$OUT"
+HEADER="-H"
+for alg in 512 768 1024; do
+  ./avx2/test/bench$alg -f $FORMAT -n $NTESTS -w $NWARMUP $HEADER >> "$OUT"
+  HEADER=""
+done
+echo "results written to $OUT"
+
+exit 0